@@ -0,0 +1,127 @@
+#!/bin/sh
+# Generate a synthetic Cone program of a given shape and size, for compile benchmarks.
+# Usage: bench/compile/gen.sh SHAPE SIZE [DEPTH] > program.cone
+# Shapes (SIZE is the number of...):
+#   fns       functions, each calling the one before
+#   nest      functions, each with loops and ifs nested DEPTH (default 16) deep
+#   overload  structs, each with a method overloaded for every number type
+#   structs   fields in each of 8 structs, built and summed field by field
+#   idents    functions with DEPTH (default 200) character names and variables
+#   literals  elements in an array literal, plus as many big number literals
+# Every program is valid and reachable from main(), so all of it is generated.
+SHAPE=$1
+SIZE=${2:-1000}
+DEPTH=$3
+if [ -z "$SHAPE" ]; then
+    echo "Usage: $0 fns|nest|overload|structs|idents|literals SIZE [DEPTH]" >&2
+    exit 1
+fi
+
+case $SHAPE in
+fns)
+    awk -v n="$SIZE" 'BEGIN {
+        print "fn step0(a i32) i32\n    a\n"
+        for (i = 1; i < n; i++) {
+            printf "fn step%d(a i32) i32\n", i
+            printf "    imm b = a * %d\n", i % 7 + 1
+            printf "    if b > 1000\n        step%d(b - 1000) + 1\n", i - 1
+            printf "    else\n        step%d(b + %d)\n\n", i - 1, i % 5
+        }
+        printf "fn main() i32\n    step%d(3) %% 200\n", n - 1
+    }'
+    ;;
+nest)
+    awk -v n="$SIZE" -v d="${DEPTH:-16}" 'BEGIN {
+        for (i = 0; i < n; i++) {
+            printf "fn nest%d(a i32) i32\n    mut x = a\n", i
+            ind = "    "
+            for (j = 0; j < d; j++) {
+                if (j % 2 == 0)
+                    printf "%sif x %% %d != 0\n", ind, j + 2
+                else
+                    printf "%swhile x < %d\n", ind, j * 10 + i
+                ind = ind "    "
+                printf "%sx = x + %d\n", ind, j + 1
+            }
+            print "    x\n"
+        }
+        print "fn main() i32\n    mut s = 0"
+        for (i = 0; i < n; i++)
+            printf "    s = s + nest%d(%d)\n", i, i
+        print "    s % 200"
+    }'
+    ;;
+overload)
+    awk -v n="$SIZE" 'BEGIN {
+        split("i8 i16 i32 i64 u8 u16 u32 u64 f32 f64", types, " ")
+        for (i = 0; i < n; i++) {
+            printf "struct Ov%d\n    base i32\n\n", i
+            for (t = 1; t <= 10; t++)
+                printf "    fn add(self, x %s) i32\n        self.base + i32[x] + %d\n", types[t], t
+            print ""
+        }
+        print "fn main() i32\n    mut s = 0"
+        for (i = 0; i < n; i++) {
+            printf "    imm o%d = Ov%d[%d]\n", i, i, i % 10
+            for (t = 1; t <= 10; t++)
+                printf "    s = s + o%d.add(%d%s)\n", i, t, types[t] ~ /^f/ ? ".0" types[t] : types[t]
+        }
+        print "    s % 200"
+    }'
+    ;;
+structs)
+    awk -v n="$SIZE" 'BEGIN {
+        for (k = 0; k < 8; k++) {
+            printf "struct Big%d\n", k
+            for (i = 0; i < n; i++)
+                printf "    f%d i32\n", i
+            printf "\n    fn sum(self) i32\n        mut s = 0\n"
+            for (i = 0; i < n; i++)
+                printf "        s = s + self.f%d\n", i
+            print "        s\n"
+        }
+        print "fn main() i32\n    mut s = 0"
+        for (k = 0; k < 8; k++) {
+            printf "    imm b%d = Big%d[", k, k
+            for (i = 0; i < n; i++)
+                printf "%s%d", i ? ", " : "", (i + k) % 10
+            print "]"
+            printf "    s = s + b%d.sum()\n", k
+        }
+        print "    s % 200"
+    }'
+    ;;
+idents)
+    awk -v n="$SIZE" -v len="${DEPTH:-200}" 'BEGIN {
+        long = ""
+        while (length(long) < len)
+            long = long "identifier_"
+        long = substr(long, 1, len)
+        for (i = 0; i < n; i++) {
+            printf "fn %s%d(%s_a i32) i32\n", long, i, long
+            printf "    imm %s_b = %s_a + %d\n", long, long, i
+            printf "    %s_b * 2\n\n", long
+        }
+        print "fn main() i32\n    mut s = 0"
+        for (i = 0; i < n; i++)
+            printf "    s = s + %s%d(%d)\n", long, i, i
+        print "    s % 200"
+    }'
+    ;;
+literals)
+    awk -v n="$SIZE" 'BEGIN {
+        printf "fn main() i32\n    imm arr = ["
+        for (i = 0; i < n; i++)
+            printf "%s%d", i ? ", " : "", (i * 7919) % 100000
+        print "]"
+        print "    mut s = 0u64"
+        for (i = 0; i < n; i++)
+            printf "    s = s + %.0fu64 %% 1000u64\n", 9007199254740000 + i * 104729
+        print "    i32[s % 200u64] + arr[0u]"
+    }'
+    ;;
+*)
+    echo "Unknown shape: $SHAPE" >&2
+    exit 1
+    ;;
+esac
@@ -0,0 +1,104 @@
+#!/bin/sh
+# Measure compiler throughput on generated programs of each shape (see gen.sh).
+# Prints one JSON result per program: seconds per compile stage (the fastest of
+# REPEAT compiles), the compiler's memory use (memUsed) and its peak resident memory.
+# Given a baseline (an earlier run's output), also reports each program's change
+# and fails if any compile got more than THRESHOLD percent slower or bigger.
+# Usage: bench/compile/run.sh [path-to-conec] [baseline.json] > results.json
+# Environment: SCALE (multiplies every program's size, default 1),
+#   REPEAT (compiles per program, default 3), THRESHOLD (percent, default 10)
+CONEC=${1:-./conec}
+BASELINE=$2
+SCALE=${SCALE:-1}
+REPEAT=${REPEAT:-3}
+THRESHOLD=${THRESHOLD:-10}
+DIR=$(dirname "$0")
+OUT=${TMPDIR:-/tmp}/conebench-compile
+mkdir -p "$OUT"
+
+# Shape, size and (optional) depth of each program in the suite
+SUITE="fns 3000
+nest 200 16
+overload 100
+structs 300
+idents 1000 200
+literals 5000"
+
+RESULTS="$OUT/results.json"
+echo "[" > "$RESULTS"
+first=1
+echo "$SUITE" | while read -r shape size depth; do
+    size=$((size * SCALE))
+    src="$OUT/$shape.cone"
+    sh "$DIR/gen.sh" "$shape" "$size" $depth > "$src" || exit 1
+
+    # Keep the stage timings of the fastest compile
+    best=""
+    run=0
+    while [ $run -lt "$REPEAT" ]; do
+        "$CONEC" -V 1 -o "$OUT" "$src" > "$OUT/$shape.log" 2>&1 || { cat "$OUT/$shape.log" >&2; exit 1; }
+        result=$(awk -v shape="$shape" -v size="$size" '
+            /^  [A-Za-z ]+: / {
+                name = tolower($1); sub(/:$/, "", name)
+                if (name == "llvm") { name = "setup"; secs = $3 } else secs = $2
+                stages = stages sprintf("%s\"%s\":%s", stages == "" ? "" : ",", name, secs)
+                total += secs
+            }
+            /^Memory used:/ { mem = $3; rss = $5; sub(/\(/, "", rss) }
+            END {
+                printf "{\"program\":\"%s\",\"size\":%d,\"total\":%.6f,\"stages\":{%s},\"mem_kb\":%d,\"rss_kb\":%d}\n",
+                    shape, size, total, stages, mem, rss
+            }' "$OUT/$shape.log")
+        total=$(echo "$result" | sed 's/.*"total":\([0-9.]*\).*/\1/')
+        if [ -z "$best" ] || awk -v a="$total" -v b="$besttotal" 'BEGIN { exit !(a < b) }'; then
+            best=$result
+            besttotal=$total
+        fi
+        run=$((run + 1))
+    done
+    if [ $first -eq 0 ]; then
+        sed -i.bak '$ s/$/,/' "$RESULTS" && rm -f "$RESULTS.bak"
+    fi
+    echo "$best" >> "$RESULTS"
+    first=0
+done || exit 1
+echo "]" >> "$RESULTS"
+cat "$RESULTS"
+
+# Compare against the baseline: total time, each stage, memory and peak resident memory
+if [ -n "$BASELINE" ]; then
+    awk -v threshold="$THRESHOLD" '
+        function parse(line, vals,    n, i, kv, p) {
+            gsub(/[][{}"]/, "", line); sub(/stages:/, "", line)
+            n = split(line, kv, ",")
+            for (i = 1; i <= n; i++) {
+                split(kv[i], p, ":")
+                vals[p[1]] = p[2]
+            }
+            return vals["program"]
+        }
+        function change(base, now) { return base > 0 ? (now - base) * 100 / base : 0 }
+        FNR == 1 { file++ }
+        !/program/ { next }
+        file == 1 { prog = parse($0, v); for (k in v) base[prog, k] = v[k]; delete v; next }
+        {
+            prog = parse($0, v)
+            if (!((prog, "total") in base)) { printf "%-10s not in baseline\n", prog; next }
+            printf "%-10s total %8.4fs -> %8.4fs (%+6.1f%%)  memory %7dkb -> %7dkb (%+6.1f%%)  peak %7dkb -> %7dkb\n",
+                prog, base[prog, "total"], v["total"], change(base[prog, "total"], v["total"]),
+                base[prog, "mem_kb"], v["mem_kb"], change(base[prog, "mem_kb"], v["mem_kb"]),
+                base[prog, "rss_kb"], v["rss_kb"]
+            # Time must also grow by 10ms, so timer noise on tiny compiles is not a regression
+            if ((change(base[prog, "total"], v["total"]) > threshold && v["total"] - base[prog, "total"] > 0.01) ||
+                change(base[prog, "mem_kb"], v["mem_kb"]) > threshold) {
+                for (k in v)
+                    if (k != "program" && k != "size" && k != "total" && k != "mem_kb" && k != "rss_kb" \
+                        && base[prog, k] > 0.001 && change(base[prog, k], v[k]) > threshold)
+                        printf "%-10s   %s stage %.4fs -> %.4fs (%+.1f%%)\n", "", k, base[prog, k], v[k], change(base[prog, k], v[k])
+                printf "%-10s   SLOWER than baseline (threshold %d%%)\n", "", threshold
+                regressed = 1
+            }
+            delete v
+        }
+        END { exit regressed }' "$BASELINE" "$RESULTS" >&2
+fi
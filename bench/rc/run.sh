@@ -0,0 +1,15 @@
+#!/bin/sh
+# Compare thread-bound (non-atomic) vs. sendable (atomic) rc counter cost.
+# Usage: bench/rc/run.sh [path-to-conec]
+CONEC=${1:-./conec}
+DIR=$(dirname "$0")
+OUT=${TMPDIR:-/tmp}/conebench-rc
+mkdir -p "$OUT"
+for b in rcbound rcshared; do
+    "$CONEC" -o "$OUT" "$DIR/$b.cone" >/dev/null 2>&1 || exit 1
+    cc "$OUT/$b.o" -o "$OUT/$b" || exit 1
+    start=$(date +%s.%N)
+    "$OUT/$b"
+    end=$(date +%s.%N)
+    awk -v b="$b" -v s="$start" -v e="$end" 'BEGIN { printf "%s: %.3f sec\n", b, e - s }'
+done
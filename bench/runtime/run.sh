@@ -0,0 +1,104 @@
+#!/bin/sh
+# Measure how fast generated code runs: each kernel is built at each optimization level
+# and run REPEAT times. Every kernel prints a checksum of its work (in full), which must match
+# the expected one below (at every level), so a miscompile fails rather than looks fast.
+# Prints one JSON result per kernel and level: the fastest run's seconds and the executable's size.
+# Given a baseline (an earlier run's output), also reports each result's change
+# and fails if any kernel got more than THRESHOLD percent slower.
+# Usage: bench/runtime/run.sh [path-to-conec] [baseline.json] > results.json
+# Environment: LEVELS (default "debug release native"),
+#   REPEAT (runs per kernel, default 3), THRESHOLD (percent, default 10)
+CONEC=${1:-./conec}
+BASELINE=$2
+LEVELS=${LEVELS:-debug release native}
+REPEAT=${REPEAT:-3}
+THRESHOLD=${THRESHOLD:-10}
+DIR=$(dirname "$0")
+OUT=${TMPDIR:-/tmp}/conebench-runtime
+mkdir -p "$OUT"
+
+# Each kernel and its expected checksum
+SUITE="matmul -148
+nbody 166
+sort 73116360
+hash 77721037
+strscan 2244750459
+alloc 4236909632
+dispatch 1952175838"
+
+RESULTS="$OUT/results.json"
+echo "[" > "$RESULTS"
+first=1
+echo "$SUITE" | while read -r kernel expect; do
+    for level in $LEVELS; do
+        case $level in
+        debug) flags="-d" ;;
+        release) flags="" ;;
+        native) flags="--cpu=native" ;;
+        *) echo "Unknown level: $level" >&2; exit 1 ;;
+        esac
+        mkdir -p "$OUT/$level"
+        exe="$OUT/$level/$kernel"
+        "$CONEC" $flags --link -o "$OUT/$level" "$DIR/$kernel.cone" > "$exe.log" 2>&1 \
+            || { cat "$exe.log" >&2; exit 1; }
+
+        # Keep the fastest run
+        best=""
+        run=0
+        while [ $run -lt "$REPEAT" ]; do
+            start=$(date +%s.%N)
+            got=$("$exe")
+            status=$?
+            end=$(date +%s.%N)
+            if [ $status -ne 0 ] || [ "$got" != "$expect" ]; then
+                echo "$kernel ($level) printed checksum $got (exit $status), expected $expect" >&2
+                exit 1
+            fi
+            secs=$(awk -v s="$start" -v e="$end" 'BEGIN { printf "%.6f", e - s }')
+            if [ -z "$best" ] || awk -v a="$secs" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+                best=$secs
+            fi
+            run=$((run + 1))
+        done
+        if [ $first -eq 0 ]; then
+            sed -i.bak '$ s/$/,/' "$RESULTS" && rm -f "$RESULTS.bak"
+        fi
+        printf '{"kernel":"%s","level":"%s","secs":%s,"size":%d}\n' \
+            "$kernel" "$level" "$best" "$(wc -c < "$exe")" >> "$RESULTS"
+        first=0
+    done
+done || exit 1
+echo "]" >> "$RESULTS"
+cat "$RESULTS"
+
+# Compare against the baseline: run time and executable size of each kernel at each level
+if [ -n "$BASELINE" ]; then
+    awk -v threshold="$THRESHOLD" '
+        function parse(line, vals,    n, i, kv, p) {
+            gsub(/[][{}"]/, "", line)
+            n = split(line, kv, ",")
+            for (i = 1; i <= n; i++) {
+                split(kv[i], p, ":")
+                vals[p[1]] = p[2]
+            }
+            return vals["kernel"] "/" vals["level"]
+        }
+        function change(base, now) { return base > 0 ? (now - base) * 100 / base : 0 }
+        FNR == 1 { file++ }
+        !/kernel/ { next }
+        file == 1 { key = parse($0, v); base[key, "secs"] = v["secs"]; base[key, "size"] = v["size"]; delete v; next }
+        {
+            key = parse($0, v)
+            if (!((key, "secs") in base)) { printf "%-18s not in baseline\n", key; next }
+            printf "%-18s %8.4fs -> %8.4fs (%+6.1f%%)  size %8d -> %8d (%+6.1f%%)\n",
+                key, base[key, "secs"], v["secs"], change(base[key, "secs"], v["secs"]),
+                base[key, "size"], v["size"], change(base[key, "size"], v["size"])
+            # Time must also grow by 10ms, so timer noise on quick kernels is not a regression
+            if (change(base[key, "secs"], v["secs"]) > threshold && v["secs"] - base[key, "secs"] > 0.01) {
+                printf "%-18s   SLOWER than baseline (threshold %d%%)\n", "", threshold
+                regressed = 1
+            }
+            delete v
+        }
+        END { exit regressed }' "$BASELINE" "$RESULTS" >&2
+fi
@@ -15,8 +15,10 @@
 #include "parser/lexer.h"
 #include "parser/parser.h"
 #include "genllvm/genllvm.h"
+#include "shared/memory.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 // Run all semantic analysis passes against the AST/IR (after parse and before gen)
@@ -30,6 +32,8 @@ void doAnalysis(ModuleNode **mod) {
     nstate.scope = 0;
     nstate.flags = 0;
     inodeNameRes(&nstate, (INode**)mod);
+    if (gIncrActive)
+        incrNameRes(&nstate);
     if (errors)
         return;
 
@@ -48,48 +52,245 @@ void doAnalysis(ModuleNode **mod) {
     tstate.loopcnt = 0;
     tstate.loopstack = memAllocBlk(sizeof(LoopNode*) * TypeCheckLoopMax);
     inodeTypeCheck(&tstate, (INode**)mod);
+    if (gIncrActive && errors == 0)
+        incrTypeCheck(&tstate);
+
+    // Compute the values of global variables not initialized by a literal
+    if (errors == 0)
+        evalGlobals(*mod);
+}
+
+// Report the statistics of the program just compiled, if asked to
+void conecStats(ConeOptions *coneopt) {
+    if (coneopt->print_stats)
+        statsPrint(coneopt->srcname);
+    if (coneopt->stats_json) {
+        char *path = fileMakePath(coneopt->output, coneopt->srcname, "stats.json");
+        FILE *file = fopen(path, "w");
+        if (file == NULL) {
+            errorMsg(ErrorGenErr, "Could not write statistics file %s", path);
+            return;
+        }
+        statsPrintJson(file, coneopt->srcname);
+        fclose(file);
+    }
+}
+
+// Parse, analyze and generate one program. Front-end state is fresh for each program,
+// but all programs share the target machine and the standard library's names.
+// Return the number of errors found
+int compilePgm(ConeOptions *coneopt, GenState *gen, char *srcpath) {
+    ModuleNode *modnode;
+
+    errorReset();
+    statsReset();
+    memset(&gGenericStats, 0, sizeof(GenericStats));
+    coneopt->srcpath = srcpath;
+    coneopt->srcname = fileName(srcpath);
+
+    // Parse source file, do semantic analysis, and generate code
+    timerBegin(ParseTimer);
+    if (gIncrActive)
+        incrBegin();
+    modnode = parsePgm(coneopt);
+    if (errors == 0) {
+        timerBegin(SemTimer);
+        if (gIncrActive)
+            incrPrepare(modnode);
+        doAnalysis(&modnode);
+        if (gIncrActive)
+            incrCommit(errors == 0);
+        if (errors == 0) {
+            genericAddInsts(modnode);
+            foldModule(modnode);
+            ReachStats reach;
+            reachModule(modnode, &reach);
+            gStats.fns = reach.fns;
+            gStats.fnsreached = reach.fnsreached;
+            gStats.vars = reach.vars;
+            gStats.varsreached = reach.varsreached;
+        }
+        if (errors == 0) {
+            timerBegin(GenTimer);
+            if (coneopt->print_ir)
+                inodePrint(coneopt->output, coneopt->srcpath, (INode*)modnode);
+            if (gIncrActive)
+                incrResetGen(modnode);
+            genmod(gen, modnode);
+        }
+    }
+    timerBegin(TimerCount);
+    if (errors == 0)
+        conecStats(coneopt);
+    return errors;
+}
+
+// Run the watched program's latest compile, reporting a failing result
+void compileWatchRun(GenState *gen, char *srcpath) {
+    int result = genlJitRun(gen);
+    if (result != 0)
+        fprintf(stderr, "%s: main() returned %d\n", srcpath, result);
+}
+
+// Recompile the program whenever any of its source files change, until interrupted.
+// Only the declarations affected by an edit are re-analyzed.
+int compileWatch(ConeOptions *coneopt, GenState *gen) {
+    char *srcpath = coneopt->srcpath;
+    if (coneopt->run && errors == 0)
+        compileWatchRun(gen, srcpath);
+    fprintf(stderr, "Watching %s for changes...\n", srcpath);
+    while (1) {
+        timerSleep(250);
+        if (!incrSrcChanged())
+            continue;
+        double start = timerSummary();
+        if (compilePgm(coneopt, gen, srcpath) > 0)
+            fprintf(stderr, "%s: unsuccessful compile: %d errors, %d warnings\n", srcpath, errors, warnings);
+        else {
+            fprintf(stderr, "%s: recompiled in %.6g sec. %d warnings detected\n", srcpath, timerSummary() - start, warnings);
+            if (coneopt->run)
+                compileWatchRun(gen, srcpath);
+        }
+    }
+    return ExitSuccess;
+}
+
+// Source paths of all programs to compile
+char **gSrcPaths = NULL;
+uint32_t gSrcPathsUsed = 0;
+uint32_t gSrcPathsAvail = 0;
+uint32_t gBitcodePaths = 0;
+
+// Add a source path to the list of programs to compile.
+// Bitcode files (.bc) are not programs, but packages to optimize with them (--lto or --thinlto)
+void conecAddSrcPath(char *srcpath) {
+    if (genlLtoIsBitcode(srcpath)) {
+        genlLtoAddBitcode(srcpath);
+        ++gBitcodePaths;
+        return;
+    }
+    if (gSrcPathsUsed >= gSrcPathsAvail) {
+        char **oldpaths = gSrcPaths;
+        gSrcPathsAvail = gSrcPathsAvail == 0 ? 16 : gSrcPathsAvail << 1;
+        gSrcPaths = (char**)memAllocBlk(gSrcPathsAvail * sizeof(char*));
+        if (oldpaths)
+            memcpy(gSrcPaths, oldpaths, gSrcPathsUsed * sizeof(char*));
+    }
+    gSrcPaths[gSrcPathsUsed++] = srcpath;
+}
+
+// Gather the source paths of programs to compile from the command line arguments.
+// An argument of the form @file names a response file, listing source paths separated by whitespace.
+void conecSrcPaths(int argc, char **argv) {
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] != '@') {
+            conecAddSrcPath(argv[i]);
+            continue;
+        }
+        char *rsp = fileLoad(&argv[i][1]);
+        if (!rsp)
+            errorExit(ExitNF, "Cannot find or read response file %s", &argv[i][1]);
+        char *tokp = strtok(rsp, " \t\r\n");
+        while (tokp) {
+            conecAddSrcPath(tokp);
+            tokp = strtok(NULL, " \t\r\n");
+        }
+    }
+}
+
+// Print the time each compile stage took, and the memory the compile needed
+void conecPrintStages() {
+    timerPrint();
+    printf("Memory used: %lu kb (%lu kb peak resident)\n\n", memUsed() / 1024, memPeakRss());
 }
 
 int main(int argc, char **argv) {
     ConeOptions coneopt;
     GenState gen;
-    ModuleNode *modnode;
     int ok;
 
     // Get compiler's options from passed arguments
     ok = coneOptSet(&coneopt, &argc, argv);
     if (ok <= 0)
         exit(ok == 0 ? 0 : ExitOpts);
-    if (argc < 2)
+    conecSrcPaths(argc, argv);
+    if (gSrcPathsUsed < 1)
         errorExit(ExitOpts, "Specify a Cone program to compile.");
-    coneopt.srcpath = argv[1];
-    coneopt.srcname = fileName(coneopt.srcpath);
+    if (gBitcodePaths > 0 && !coneopt.lto)
+        errorExit(ExitOpts, "Bitcode (.bc) files may only be compiled with --lto or --thinlto.");
 
     // We set up generation early because we need target info, e.g.: pointer size
+    // The target machine and standard library are set up once, for all programs
     timerBegin(SetupTimer);
+    gIncrActive = coneopt.watch;
+    if (coneopt.watch && gSrcPathsUsed > 1)
+        errorExit(ExitOpts, "--watch supports only one program at a time.");
     genSetup(&gen, &coneopt);
+    nametblInit();
+    lexInit();
+    stdlibInit(coneopt.ptrsize);
 
-    // Parse source file, do semantic analysis, and generate code
-    timerBegin(ParseTimer);
-    modnode = parsePgm(&coneopt);
-    if (errors == 0) {
-        timerBegin(SemTimer);
-        doAnalysis(&modnode);
-        if (errors == 0) {
-            timerBegin(GenTimer);
-            if (coneopt.print_ir)
-                inodePrint(coneopt.output, coneopt.srcpath, (INode*)modnode);
-            genmod(&gen, modnode);
-            genClose(&gen);
+    // Single program: compile, summarize, and then run if requested
+    if (gSrcPathsUsed == 1) {
+        compilePgm(&coneopt, &gen, gSrcPaths[0]);
+
+        // With --watch, keep recompiling after edits (first compile's errors do not end it)
+        if (coneopt.watch) {
+            if (errors > 0)
+                fprintf(stderr, "%s: unsuccessful compile: %d errors, %d warnings\n", gSrcPaths[0], errors, warnings);
+            else
+                fprintf(stderr, "Compile finished in %.6g sec (%lu kb). %d warnings detected\n", timerSummary(), memUsed() / 1024, warnings);
+            return compileWatch(&coneopt, &gen);
         }
-    }
-    timerBegin(TimerCount);
+        if (coneopt.lto && errors == 0)
+            genlLtoFinish(&gen);
+        genClose(&gen);
 
-    // Close up everything necessary
-    if (coneopt.verbosity > 0)
-        timerPrint();
-    errorSummary();
+        // Close up everything necessary
+        if (coneopt.verbosity > 0)
+            conecPrintStages();
+        errorSummary();
+
+        // With --run, execute the JIT-compiled program and return its result
+        if (coneopt.run)
+            return genlJitRun(&gen);
 #ifdef _DEBUG
-    getchar();    // Hack for VS debugging
+        getchar();    // Hack for VS debugging
 #endif
+        return ExitSuccess;
+    }
+
+    // Batch of programs: compile (and run) each in turn, reporting only those that fail
+    uint32_t i;
+    int failed = 0;
+    for (i = 0; i < gSrcPathsUsed; i++) {
+        char *srcpath = gSrcPaths[i];
+        if (compilePgm(&coneopt, &gen, srcpath) > 0) {
+            fprintf(stderr, "%s: unsuccessful compile: %d errors, %d warnings\n", srcpath, errors, warnings);
+            ++failed;
+        }
+        else if (coneopt.run) {
+            int result = genlJitRun(&gen);
+            if (result != 0) {
+                fprintf(stderr, "%s: main() returned %d\n", srcpath, result);
+                ++failed;
+            }
+        }
+    }
+    if (coneopt.lto && failed == 0) {
+        errorReset();
+        genlLtoFinish(&gen);
+        if (errors > 0) {
+            fprintf(stderr, "Unsuccessful link-time optimization: %d errors\n", errors);
+            ++failed;
+        }
+    }
+    genClose(&gen);
+
+    if (coneopt.verbosity > 0)
+        conecPrintStages();
+    fprintf(stderr, "Batch finished in %.6g sec (%lu kb). %d of %d programs failed\n",
+        timerSummary(), memUsed() / 1024, failed, gSrcPathsUsed);
+    return failed ? ExitError : ExitSuccess;
 }
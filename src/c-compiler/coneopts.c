@@ -21,12 +21,22 @@ enum
     OPT_DEBUG,
     OPT_BUILDFLAG,
     OPT_STRIP,
+    OPT_DEBUG_LINES,
+    OPT_DEBUG_MAIN,
     OPT_PATHS,
     OPT_OUTPUT,
     OPT_LIBRARY,
+    OPT_LINK,
+    OPT_RUN,
+    OPT_WATCH,
     OPT_RUNTIMEBC,
     OPT_PIC,
     OPT_NOPIC,
+    OPT_PGO_GEN,
+    OPT_PGO_USE,
+    OPT_EMIT_BITCODE,
+    OPT_LTO,
+    OPT_THINLTO,
     OPT_DOCS,
     OPT_DOCS_PUBLIC,
 
@@ -36,6 +46,7 @@ enum
     OPT_WASM,
     OPT_TRIPLE,
     OPT_STATS,
+    OPT_STATS_JSON,
     OPT_LINK_ARCH,
     OPT_LINKER,
 
@@ -65,12 +76,22 @@ static opt_arg_t args[] =
     { "debug", 'd', OPT_ARG_NONE, OPT_DEBUG },
     { "define", 'D', OPT_ARG_REQUIRED, OPT_BUILDFLAG },
     { "strip", 's', OPT_ARG_NONE, OPT_STRIP },
+    { "debug-lines", '\0', OPT_ARG_NONE, OPT_DEBUG_LINES },
+    { "debug-main", '\0', OPT_ARG_NONE, OPT_DEBUG_MAIN },
     { "path", 'p', OPT_ARG_REQUIRED, OPT_PATHS },
     { "output", 'o', OPT_ARG_REQUIRED, OPT_OUTPUT },
     { "library", 'l', OPT_ARG_NONE, OPT_LIBRARY },
+    { "link", '\0', OPT_ARG_NONE, OPT_LINK },
+    { "run", 'r', OPT_ARG_NONE, OPT_RUN },
+    { "watch", '\0', OPT_ARG_NONE, OPT_WATCH },
     { "runtimebc", '\0', OPT_ARG_NONE, OPT_RUNTIMEBC },
     { "pic", '\0', OPT_ARG_NONE, OPT_PIC },
     { "nopic", '\0', OPT_ARG_NONE, OPT_NOPIC },
+    { "pgo-gen", '\0', OPT_ARG_NONE, OPT_PGO_GEN },
+    { "pgo-use", '\0', OPT_ARG_REQUIRED, OPT_PGO_USE },
+    { "emit-bitcode", '\0', OPT_ARG_NONE, OPT_EMIT_BITCODE },
+    { "lto", '\0', OPT_ARG_NONE, OPT_LTO },
+    { "thinlto", '\0', OPT_ARG_NONE, OPT_THINLTO },
     { "docs", 'g', OPT_ARG_NONE, OPT_DOCS },
     { "docs-public", '\0', OPT_ARG_NONE, OPT_DOCS_PUBLIC },
 
@@ -80,6 +101,7 @@ static opt_arg_t args[] =
     { "wasm", '\0', OPT_ARG_NONE, OPT_WASM },
     { "triple", '\0', OPT_ARG_REQUIRED, OPT_TRIPLE },
     { "stats", '\0', OPT_ARG_NONE, OPT_STATS },
+    { "stats-json", '\0', OPT_ARG_NONE, OPT_STATS_JSON },
     { "link-arch", '\0', OPT_ARG_REQUIRED, OPT_LINK_ARCH },
     { "linker", '\0', OPT_ARG_REQUIRED, OPT_LINKER },
 
@@ -103,9 +125,11 @@ static opt_arg_t args[] =
 static void usage()
 {
     printf("%s\n%s\n%s\n%s\n%s\n%s", // for complying with -Woverlength-strings
-        "cone [OPTIONS] <source_file>\n"
+        "cone [OPTIONS] <source_file>...\n"
         ,
         "The source directory defaults to the current directory.\n"
+        "Several independent programs may be compiled in one batch.\n"
+        "An argument of @file reads more source files from a response file.\n"
         ,
         "Options:\n"
         "  --version, -v   Print the version of the compiler and exit.\n"
@@ -114,15 +138,35 @@ static void usage()
         "  --define, -D    Define the specified build flag.\n"
         "    =name\n"
         "  --strip, -s     Strip debug info.\n"
+        "  --debug-lines   Debug info only maps code to source lines.\n"
+        "  --debug-main    Debug info only for the program's own source file,\n"
+        "                  not the files it includes.\n"
         "  --path, -p      Add an additional search path.\n"
         "    =path         Used to find packages and libraries.\n"
         "  --output, -o    Write output to this directory.\n"
         "    =path         Defaults to the current directory.\n"
         "  --library, -l   Generate a C-API compatible static library.\n"
+        "  --link          Link an executable (or with --library, a static library)\n"
+        "                  rather than stopping at an object file.\n"
+        "  --run, -r       JIT-compile and run the program's main() in-process.\n"
+        "                  Each function is compiled when first called.\n"
+        "                  Returns main()'s result as the exit code.\n"
+        "  --watch         Recompile whenever a source file changes.\n"
+        "                  Only declarations affected by an edit are re-analyzed.\n"
         "  --runtimebc     Compile with the LLVM bitcode file for the runtime.\n"
         "  --wasm          Compile for WebAssembly target.\n"
         "  --pic           Compile using position independent code.\n"
         "  --nopic         Don't compile using position independent code.\n"
+        "  --pgo-gen       Instrument the program to profile its runs.\n"
+        "                  Links with clang (the default --linker for it). Each run\n"
+        "                  writes default.profraw (or $LLVM_PROFILE_FILE).\n"
+        "  --pgo-use       Optimize using profiles of instrumented runs.\n"
+        "    =file         Raw profiles merged by llvm-profdata (.profdata).\n"
+        "  --emit-bitcode  Emit LLVM bitcode (.bc) rather than an object file.\n"
+        "  --lto           Optimize the programs and any .bc files named together,\n"
+        "                  as one whole program emitted as one object file.\n"
+        "  --thinlto       Inline functions from any .bc files named into each\n"
+        "                  program, but optimize and emit each separately.\n"
         "  --docs, -g      Generate code documentation.\n"
         "  --docs-public   Generate code documentation for public types only.\n"
         ,
@@ -130,17 +174,23 @@ static void usage()
         "  --safe          Allow only the listed packages to use C FFI.\n"
         "    =package      With no packages listed, only builtin is allowed.\n"
         "  --cpu           Set the target CPU.\n"
-        "    =name         Default is the host CPU.\n"
+        "    =name         Default is generic. native is the host CPU (and features).\n"
+        "                  Functions marked @multiversion get SSE4.2, AVX2 and AVX-512\n"
+        "                  versions too, picked for the CPU when the program loads.\n"
         "  --features      CPU features to enable or disable.\n"
         "    =+this,-that  Use + to enable, - to disable.\n"
-        "                  Defaults to detecting all CPU features from the host.\n"
+        "                  Defaults to the CPU's own features.\n"
         "  --triple        Set the target triple.\n"
         "    =name         Defaults to the host triple.\n"
-        "  --stats         Print some compiler stats.\n"
-        "  --link-arch     Set the linking architecture.\n"
-        "    =name         Default is the host architecture.\n"
-        "  --linker        Set the linker command to use.\n"
-        "    =name         Default is the compiler.\n"
+        "  --stats         Print compiler statistics for each program: tokens, names,\n"
+        "                  IR nodes by kind, memory, and LLVM code before and after\n"
+        "                  optimization.\n"
+        "  --stats-json    Write the same statistics to a .stats.json file.\n"
+        "  --link-arch     Set the linking architecture (with --link).\n"
+        "    =name         Default is the host architecture. Other than on\n"
+        "                  macOS and Windows, name a target triple and link with clang.\n"
+        "  --linker        Set the linker command to use (with --link).\n"
+        "    =name         Default is cc (link on Windows, clang with --pgo-gen).\n"
         ,
         "Debugging options:\n"
         "  --verbose, -V   Verbosity level.\n"
@@ -197,11 +247,21 @@ int coneOptSet(ConeOptions *opt, int *argc, char **argv) {
 
         case OPT_DEBUG: opt->release = 0; break;
         case OPT_STRIP: opt->strip_debug = 1; break;
+        case OPT_DEBUG_LINES: opt->debug_lines = 1; break;
+        case OPT_DEBUG_MAIN: opt->debug_main = 1; break;
         case OPT_OUTPUT: opt->output = s.arg_val; break;
         case OPT_LIBRARY: opt->library = 1; break;
+        case OPT_LINK: opt->link = 1; break;
+        case OPT_RUN: opt->run = 1; break;
+        case OPT_WATCH: opt->watch = 1; break;
         case OPT_RUNTIMEBC: opt->runtimebc = 1; break;
         case OPT_PIC: opt->pic = 1; break;
         case OPT_NOPIC: opt->pic = 0; break;
+        case OPT_PGO_GEN: opt->pgo_gen = 1; break;
+        case OPT_PGO_USE: opt->pgo_use = s.arg_val; break;
+        case OPT_EMIT_BITCODE: opt->emit_bitcode = 1; break;
+        case OPT_LTO: opt->lto = LtoFull; break;
+        case OPT_THINLTO: opt->lto = LtoThin; break;
         case OPT_DOCS:
         {
             opt->docs = 1;
@@ -230,6 +290,7 @@ int coneOptSet(ConeOptions *opt, int *argc, char **argv) {
         case OPT_FEATURES: opt->features = s.arg_val; break;
         case OPT_TRIPLE: opt->triple = s.arg_val; break;
         case OPT_STATS: opt->print_stats = 1; break;
+        case OPT_STATS_JSON: opt->stats_json = 1; break;
         case OPT_LINK_ARCH: opt->link_arch = s.arg_val; break;
         case OPT_LINKER: opt->linker = s.arg_val; break;
 
@@ -268,6 +329,27 @@ int coneOptSet(ConeOptions *opt, int *argc, char **argv) {
         }
     }
 
+    // Instrumented code needs the profile runtime, which is linked in (not JIT-resolved)
+    if (opt->pgo_gen && (opt->run || opt->pgo_use)) {
+        printf("--pgo-gen may not be used with --run or --pgo-use\n");
+        ok = 0;
+    }
+
+    // Link-time optimization works on files, not on code run in-process
+    if ((opt->emit_bitcode || opt->lto) && (opt->run || opt->watch)) {
+        printf("--emit-bitcode, --lto and --thinlto may not be used with --run or --watch\n");
+        ok = 0;
+    }
+    // Each program is linked on its own, without the objects of other units
+    if (opt->link && (opt->run || opt->emit_bitcode || opt->lto == LtoThin || opt->wasm)) {
+        printf("--link may not be used with --run, --emit-bitcode, --thinlto or --wasm\n");
+        ok = 0;
+    }
+    if (opt->emit_bitcode && opt->lto) {
+        printf("--emit-bitcode may not be used with --lto or --thinlto\n");
+        ok = 0;
+    }
+
     if (!ok) {
         // errors_print(opt.check.errors);
         if (print_usage)
@@ -11,6 +11,13 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Link-time optimization modes
+enum LtoMode {
+    LtoNone,
+    LtoFull,    // Link all modules into one, optimize and emit it whole
+    LtoThin     // Import other modules' functions for inlining, but optimize and emit each separately
+};
+
 // Compiler options
 typedef struct ConeOptions {
 
@@ -28,6 +35,7 @@ typedef struct ConeOptions {
     char* triple;
     char* cpu;
     char* features;
+    char* pgo_use;      // Profile data (.profdata) from instrumented runs, to guide optimization
 
     //typecheck_t check;
 
@@ -39,13 +47,22 @@ typedef struct ConeOptions {
     int wasm;        // 1=WebAssembly
     int release;    // 0=debug (no optimizations). 1=release (default)
     int library;    // 1=generate a C-API compatible static library
+    int link;       // 1=Link in-process into an executable (or static library), not an object file
+    int run;        // 1=JIT-compile and run the program in-process
+    int watch;        // 1=Recompile (incrementally) whenever a source file changes
     int runtimebc;    // Compile with the LLVM bitcode file for the runtime
     int pic;        // Compile using position independent code
-    int print_stats;    // Print some compiler statistics
+    int pgo_gen;    // 1=Instrument the code to write a profile of its runs
+    int emit_bitcode;    // 1=Emit LLVM bitcode (.bc) rather than an object, for link-time optimization
+    int lto;        // Link-time optimization mode (LtoMode)
+    int print_stats;    // Print compiler statistics
+    int stats_json;     // Write compiler statistics to a .stats.json file
     int verify;        // Verify LLVM IR
     int extfun;        // Set function default linkage to external
     int simple_builtin;    // Use a minimal builtin package
     int strip_debug;    // Strip debug info
+    int debug_lines;    // 1=Debug info is only line tables (no types or variables)
+    int debug_main;     // 1=Debug info only for the program's own source file, not included files
     int print_filenames;    // Print source file names as each is processed
     int print_ir;        // Print out IR
     int print_asm;        // Print out assembly file
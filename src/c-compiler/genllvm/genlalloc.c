@@ -23,10 +23,6 @@
 #include <string.h>
 #include <assert.h>
 
-// Function declarations for malloc() and free()
-LLVMValueRef genlmallocval = NULL;
-LLVMValueRef genlfreeval = NULL;
-
 // Insert the alloca before the allocaPoint instruction.
 LLVMValueRef genlAlloca(GenState *gen, LLVMTypeRef type, const char *name) {
 	LLVMBasicBlockRef current_block = LLVMGetInsertBlock(gen->builder);
@@ -38,7 +34,8 @@ LLVMValueRef genlAlloca(GenState *gen, LLVMTypeRef type, const char *name) {
 
 // Call malloc() (and generate declaration if needed)
 LLVMValueRef genlmalloc(GenState *gen, long long size) {
-    // Declare malloc() external function
+    // Declare malloc() external function, once per module
+    LLVMValueRef genlmallocval = LLVMGetNamedFunction(gen->module, "malloc");
     if (genlmallocval == NULL) {
         LLVMTypeRef parmtype = genlUsize(gen);
         LLVMTypeRef rettype = LLVMPointerType(LLVMInt8TypeInContext(gen->context), 0);
@@ -73,7 +70,8 @@ void genlDealiasFlds(GenState *gen, LLVMValueRef ref, RefNode *refnode) {
 // Call free() (and generate declaration if needed)
 LLVMValueRef genlFree(GenState *gen, LLVMValueRef ref) {
     LLVMTypeRef parmtype = LLVMPointerType(LLVMInt8TypeInContext(gen->context), 0);
-    // Declare free() external function
+    // Declare free() external function, once per module
+    LLVMValueRef genlfreeval = LLVMGetNamedFunction(gen->module, "free");
     if (genlfreeval == NULL) {
         LLVMTypeRef rettype = LLVMVoidTypeInContext(gen->context);
         LLVMTypeRef fnsig = LLVMFunctionType(rettype, &parmtype, 1, 0);
@@ -97,7 +95,7 @@ LLVMValueRef genlallocref(GenState *gen, AllocateNode *allocatenode) {
         LLVMTypeRef ptrusize = LLVMPointerType(genlType(gen, (INode*)usizeType), 0);
         LLVMValueRef counterptr = LLVMBuildBitCast(gen->builder, malloc, ptrusize, "");
         LLVMBuildStore(gen->builder, constone, counterptr); // Store 1 into refcounter
-        malloc = LLVMBuildGEP(gen->builder, malloc, &constone, 1, ""); // Point to value
+        malloc = LLVMBuildGEP(gen->builder, counterptr, &constone, 1, ""); // Point to value, past aligned counter
     }
     LLVMValueRef valcast = LLVMBuildBitCast(gen->builder, malloc, genlType(gen, allocatenode->vtype), "");
     LLVMBuildStore(gen->builder, genlExpr(gen, allocatenode->exp), valcast);
@@ -111,18 +109,31 @@ void genlDealiasOwn(GenState *gen, LLVMValueRef ref, RefNode *refnode) {
 }
 
 // Add to the counter of an rc allocated reference
+// Thread-bound references never leave their thread, so a plain load/add/store suffices.
+// Sendable references may be shared across threads, so they need an atomic read-modify-write.
 void genlRcCounter(GenState *gen, LLVMValueRef ref, long long amount, RefNode *refnode) {
     // Point backwards to ref counter
-    LLVMTypeRef ptrusize = LLVMPointerType(genlType(gen, (INode*)usizeType), 0);
+    LLVMTypeRef usize = genlType(gen, (INode*)usizeType);
+    LLVMTypeRef ptrusize = LLVMPointerType(usize, 0);
     LLVMValueRef refcast = LLVMBuildBitCast(gen->builder, ref, ptrusize, "");
-    LLVMValueRef minusone = LLVMConstInt(genlType(gen, (INode*)usizeType), -1, 1);
+    LLVMValueRef minusone = LLVMConstInt(usize, -1, 1);
     LLVMValueRef cntptr = LLVMBuildGEP(gen->builder, refcast, &minusone, 1, "");
+    LLVMValueRef amountval = LLVMConstInt(usize, amount, 1);
 
     // Increment ref counter
-    LLVMValueRef cnt = LLVMBuildLoad(gen->builder, cntptr, "");
-    LLVMTypeRef usize = genlType(gen, (INode*)usizeType);
-    LLVMValueRef newcnt = LLVMBuildAdd(gen->builder, cnt, LLVMConstInt(usize, amount, 0), "");
-    LLVMBuildStore(gen->builder, newcnt, cntptr);
+    LLVMValueRef newcnt;
+    if (refnode->flags & ThreadBound) {
+        LLVMValueRef cnt = LLVMBuildLoad(gen->builder, cntptr, "");
+        newcnt = LLVMBuildAdd(gen->builder, cnt, amountval, "");
+        LLVMBuildStore(gen->builder, newcnt, cntptr);
+    }
+    else {
+        // Increments need no ordering. Decrements release prior writes to the value,
+        // and the thread that frees it acquires them (see fence below).
+        LLVMAtomicOrdering order = amount < 0 ? LLVMAtomicOrderingRelease : LLVMAtomicOrderingMonotonic;
+        LLVMValueRef oldcnt = LLVMBuildAtomicRMW(gen->builder, LLVMAtomicRMWBinOpAdd, cntptr, amountval, order, 0);
+        newcnt = LLVMBuildAdd(gen->builder, oldcnt, amountval, "");
+    }
 
     // Free if zero. Otherwise, don't
     if (amount < 0) {
@@ -131,6 +142,8 @@ void genlRcCounter(GenState *gen, LLVMValueRef ref, long long amount, RefNode *r
         LLVMValueRef test = LLVMBuildICmp(gen->builder, LLVMIntEQ, newcnt, LLVMConstInt(usize, 0, 0), "iszero");
         LLVMBuildCondBr(gen->builder, test, dofree, nofree);
         LLVMPositionBuilderAtEnd(gen->builder, dofree);
+        if (!(refnode->flags & ThreadBound))
+            LLVMBuildFence(gen->builder, LLVMAtomicOrderingAcquire, 0, "");
         genlDealiasFlds(gen, ref, refnode);
         genlFree(gen, cntptr);
         LLVMBuildBr(gen->builder, nofree);
@@ -18,6 +18,7 @@
 #include <llvm-c/Analysis.h>
 #include <llvm-c/BitWriter.h>
 #include <llvm-c/Transforms/Scalar.h>
+#include <llvm/Config/llvm-config.h>
 
 #include <stdio.h>
 #include <string.h>
@@ -25,6 +26,21 @@
 
 LLVMValueRef genlAddr(GenState *gen, INode *lval);
 
+// Weight an if's conditional branch toward or away from its block (@likely or @unlikely)
+void genlBranchWeights(GenState *gen, LLVMValueRef condbr, BlockNode *blk) {
+    if (!(blk->flags & (FlagLikely | FlagUnlikely)))
+        return;
+    // The same weights that llvm.expect gives
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(gen->context);
+    unsigned likely = 2000, unlikely = 1;
+    LLVMMetadataRef weights[3];
+    weights[0] = LLVMMDStringInContext2(gen->context, "branch_weights", 14);
+    weights[1] = LLVMValueAsMetadata(LLVMConstInt(i32, blk->flags & FlagLikely ? likely : unlikely, 0));
+    weights[2] = LLVMValueAsMetadata(LLVMConstInt(i32, blk->flags & FlagLikely ? unlikely : likely, 0));
+    LLVMValueRef md = LLVMMetadataAsValue(gen->context, LLVMMDNodeInContext2(gen->context, weights, 3));
+    LLVMSetMetadata(condbr, LLVMGetMDKindIDInContext(gen->context, "prof", 4), md);
+}
+
 // Generate an if statement
 LLVMValueRef genlIf(GenState *gen, IfNode *ifnode) {
     LLVMBasicBlockRef endif;
@@ -59,7 +75,8 @@ LLVMValueRef genlIf(GenState *gen, IfNode *ifnode) {
         LLVMBasicBlockRef ablk;
         if (*nodesp != voidType) {
             ablk = LLVMInsertBasicBlockInContext(gen->context, nextif, "ifblk");
-            LLVMBuildCondBr(gen->builder, genlExpr(gen, *nodesp), ablk, nextif);
+            LLVMValueRef condbr = LLVMBuildCondBr(gen->builder, genlExpr(gen, *nodesp), ablk, nextif);
+            genlBranchWeights(gen, condbr, (BlockNode*)*(nodesp + 1));
             LLVMPositionBuilderAtEnd(gen->builder, ablk);
         }
         else
@@ -69,12 +86,13 @@ LLVMValueRef genlIf(GenState *gen, IfNode *ifnode) {
         LLVMValueRef blkval = genlBlock(gen, (BlockNode*)*(nodesp + 1));
         uint16_t lastStmttype = nodesLast(((BlockNode*)*(nodesp + 1))->stmts)->tag;
         if (lastStmttype != ReturnTag && lastStmttype != BreakTag && lastStmttype != ContinueTag) {
-            LLVMBuildBr(gen->builder, endif);
-            // Remember value and block if needed for phi merge
+            // Remember value and block if needed for phi merge.
+            // The block's code may have ended in a later block than it began (e.g., after a bounds check)
             if (vtype != voidType) {
                 blkvals[phicnt] = blkval;
-                blks[phicnt++] = ablk;
+                blks[phicnt++] = LLVMGetInsertBlock(gen->builder);
             }
+            LLVMBuildBr(gen->builder, endif);
         }
 
         LLVMPositionBuilderAtEnd(gen->builder, nextif);
@@ -99,6 +117,179 @@ LLVMValueRef genlGetIntrinsicFn(GenState *gen, char *fnname, NameUseNode *fnuse)
     return fn;
 }
 
+// Call an LLVM intrinsic that is overloaded on one type (e.g., llvm.ctpop on i32).
+// An intrinsic this LLVM does not have is an error (its value is undefined).
+LLVMValueRef genlCallIntrinsic(GenState *gen, char *fnname, LLVMTypeRef type, LLVMValueRef *args, unsigned nargs) {
+#if LLVM_VERSION_MAJOR >= 8
+    unsigned id = LLVMLookupIntrinsicID(fnname, strlen(fnname));
+    if (id != 0) {
+        LLVMValueRef fn = LLVMGetIntrinsicDeclaration(gen->module, id, &type, 1);
+        return LLVMBuildCall(gen->builder, fn, args, nargs, "");
+    }
+#endif
+    errorMsg(ErrorGenErr, "LLVM %d does not provide the %s intrinsic", LLVM_VERSION_MAJOR, fnname);
+    return LLVMGetUndef(type);
+}
+
+// The lesser (or greater) of two integers
+LLVMValueRef genlIntMinMax(GenState *gen, int16_t intrinsic, int issigned, LLVMValueRef *fnargs) {
+    LLVMValueRef lt = LLVMBuildICmp(gen->builder, issigned ? LLVMIntSLT : LLVMIntULT, fnargs[0], fnargs[1], "");
+    return intrinsic == MinIntrinsic ? LLVMBuildSelect(gen->builder, lt, fnargs[0], fnargs[1], "min")
+        : LLVMBuildSelect(gen->builder, lt, fnargs[1], fnargs[0], "max");
+}
+
+// Generate the bit manipulation, saturating and min/max integer intrinsics.
+// Return NULL for any other intrinsic.
+LLVMValueRef genlIntIntrinsic(GenState *gen, int16_t intrinsic, int issigned, LLVMValueRef *fnargs) {
+    LLVMTypeRef type = LLVMTypeOf(fnargs[0]);
+    switch (intrinsic) {
+    case PopcountIntrinsic: return genlCallIntrinsic(gen, "llvm.ctpop", type, fnargs, 1);
+    case BswapIntrinsic: return genlCallIntrinsic(gen, "llvm.bswap", type, fnargs, 1);
+    case ClzIntrinsic:
+    case CtzIntrinsic:
+    {
+        // A zero value counts all its bits (rather than being poison)
+        LLVMValueRef args[2] = { fnargs[0], LLVMConstInt(LLVMInt1TypeInContext(gen->context), 0, 0) };
+        return genlCallIntrinsic(gen, intrinsic == ClzIntrinsic ? "llvm.ctlz" : "llvm.cttz", type, args, 2);
+    }
+    case RotlIntrinsic:
+    case RotrIntrinsic:
+    {
+        // A funnel shift of a value with itself rotates it
+        LLVMValueRef args[3] = { fnargs[0], fnargs[0], fnargs[1] };
+        return genlCallIntrinsic(gen, intrinsic == RotlIntrinsic ? "llvm.fshl" : "llvm.fshr", type, args, 3);
+    }
+    case AddSatIntrinsic: return genlCallIntrinsic(gen, issigned ? "llvm.sadd.sat" : "llvm.uadd.sat", type, fnargs, 2);
+    case SubSatIntrinsic: return genlCallIntrinsic(gen, issigned ? "llvm.ssub.sat" : "llvm.usub.sat", type, fnargs, 2);
+    case MinIntrinsic:
+    case MaxIntrinsic:
+        return genlIntMinMax(gen, intrinsic, issigned, fnargs);
+    default:
+        return NULL;
+    }
+}
+
+// Copy a scalar value into every lane of a vector
+LLVMValueRef genlVecSplat(GenState *gen, LLVMValueRef scalar, LLVMTypeRef vectype) {
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(gen->context);
+    LLVMValueRef vec = LLVMBuildInsertElement(gen->builder, LLVMGetUndef(vectype), scalar, LLVMConstInt(i32, 0, 0), "");
+    LLVMValueRef zeros = LLVMConstNull(LLVMVectorType(i32, LLVMGetVectorSize(vectype)));
+    return LLVMBuildShuffleVector(gen->builder, vec, LLVMGetUndef(vectype), zeros, "splat");
+}
+
+// Combine two vectors lane by lane, as one step of a horizontal reduction
+LLVMValueRef genlVecReduceStep(GenState *gen, int16_t intrinsic, uint16_t typetag, LLVMValueRef a, LLVMValueRef b) {
+    LLVMValueRef cmp;
+    switch (intrinsic) {
+    case SumIntrinsic:
+        return typetag == FloatNbrTag ? LLVMBuildFAdd(gen->builder, a, b, "") : LLVMBuildAdd(gen->builder, a, b, "");
+    case AnyIntrinsic:
+        return LLVMBuildOr(gen->builder, a, b, "");
+    case AllIntrinsic:
+        return LLVMBuildAnd(gen->builder, a, b, "");
+    case MinIntrinsic:
+    case MaxIntrinsic:
+        if (typetag == FloatNbrTag)
+            cmp = LLVMBuildFCmp(gen->builder, LLVMRealOLT, a, b, "");
+        else
+            cmp = LLVMBuildICmp(gen->builder, typetag == IntNbrTag ? LLVMIntSLT : LLVMIntULT, a, b, "");
+        return intrinsic == MinIntrinsic ? LLVMBuildSelect(gen->builder, cmp, a, b, "") : LLVMBuildSelect(gen->builder, cmp, b, a, "");
+    default:
+        assert(0 && "Unknown vector reduction");
+        return a;
+    }
+}
+
+// Reduce all of a vector's lanes to a single value, by repeatedly combining
+// its upper half of lanes with its lower half. Backends match this shuffle pattern.
+LLVMValueRef genlVecReduce(GenState *gen, int16_t intrinsic, uint16_t typetag, LLVMValueRef vec) {
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(gen->context);
+    LLVMTypeRef vectype = LLVMTypeOf(vec);
+    unsigned lanes = LLVMGetVectorSize(vectype);
+    LLVMValueRef *mask = (LLVMValueRef *)memAllocBlk(lanes * sizeof(LLVMValueRef));
+    for (unsigned half = lanes / 2; half > 0; half /= 2) {
+        for (unsigned i = 0; i < lanes; ++i)
+            mask[i] = i < half ? LLVMConstInt(i32, i + half, 0) : LLVMGetUndef(i32);
+        LLVMValueRef upper = LLVMBuildShuffleVector(gen->builder, vec, LLVMGetUndef(vectype), LLVMConstVector(mask, lanes), "");
+        vec = genlVecReduceStep(gen, intrinsic, typetag, vec, upper);
+    }
+    return LLVMBuildExtractElement(gen->builder, vec, LLVMConstInt(i32, 0, 0), "");
+}
+
+// Obtain a pointer to a vector's worth of lanes in an array reference, after bounds checking
+LLVMValueRef genlVecArrayPtr(GenState *gen, LLVMValueRef arrref, LLVMValueRef index, VecNode *vectype) {
+    LLVMValueRef count = LLVMBuildExtractValue(gen->builder, arrref, 1, "count");
+    genlBoundsCheck(gen, index, count);
+    LLVMValueRef lastlane = LLVMConstInt(genlUsize(gen), vectype->lanes - 1, 0);
+    genlBoundsCheck(gen, LLVMBuildAdd(gen->builder, index, lastlane, ""), count);
+    LLVMValueRef sliceptr = LLVMBuildExtractValue(gen->builder, arrref, 0, "sliceptr");
+    LLVMValueRef lanep = LLVMBuildGEP(gen->builder, sliceptr, &index, 1, "");
+    return LLVMBuildBitCast(gen->builder, lanep, LLVMPointerType(genlType(gen, (INode*)vectype), 0), "");
+}
+
+// Generate the intrinsics only vectors have. Return NULL for the elementwise number
+// intrinsics, which LLVM applies to vectors exactly as it does to scalars.
+LLVMValueRef genlVecIntrinsic(GenState *gen, FnCallNode *fncall, LLVMValueRef *fnargs, VecNode *vectype, NameUseNode *fnuse) {
+    int16_t intrinsic = ((IntrinsicNode *)((FnDclNode *)fnuse->dclnode)->value)->intrinsicFn;
+    uint16_t typetag = vectype->elemtype->tag;
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(gen->context);
+    switch (intrinsic) {
+    case ShuffleIntrinsic:
+    {
+        // Lane indexes must be literals, as LLVM requires a constant shuffle mask
+        uint32_t nargs = fncall->args->used;
+        FnCallNode *lanelit = (FnCallNode *)nodesGet(fncall->args, nargs - 1);
+        uint32_t limit = vectype->lanes * (nargs - 1);
+        LLVMValueRef *mask = (LLVMValueRef *)memAllocBlk(vectype->lanes * sizeof(LLVMValueRef));
+        for (uint32_t i = 0; i < vectype->lanes; ++i) {
+            INode *lane = lanelit->tag == TypeLitTag ? nodesGet(lanelit->args, lanelit->args->used == 1 ? 0 : i) : NULL;
+            if (lane == NULL || lane->tag != ULitTag || ((ULitNode*)lane)->uintlit >= limit) {
+                errorMsgNode((INode*)lanelit, ErrorInvType, "Shuffle lanes must be literal lane numbers less than %d", (int)limit);
+                return LLVMGetUndef(genlType(gen, (INode*)vectype));
+            }
+            mask[i] = LLVMConstInt(i32, ((ULitNode*)lane)->uintlit, 0);
+        }
+        LLVMValueRef b = nargs > 2 ? fnargs[1] : LLVMGetUndef(LLVMTypeOf(fnargs[0]));
+        return LLVMBuildShuffleVector(gen->builder, fnargs[0], b, LLVMConstVector(mask, vectype->lanes), "shuffle");
+    }
+    case SelectIntrinsic:
+        return LLVMBuildSelect(gen->builder, fnargs[0], fnargs[1], fnargs[2], "select");
+    case SumIntrinsic:
+    case MinIntrinsic:
+    case MaxIntrinsic:
+    case AnyIntrinsic:
+    case AllIntrinsic:
+        return genlVecReduce(gen, intrinsic, typetag, fnargs[0]);
+    case LoadIntrinsic:
+    {
+        // Array lanes need only be aligned as their number type is
+        LLVMValueRef vecp = genlVecArrayPtr(gen, fnargs[1], fnargs[2], vectype);
+        LLVMValueRef vec = LLVMBuildLoad(gen->builder, vecp, "");
+        LLVMSetAlignment(vec, vectype->elemtype->bits / 8);
+        LLVMBuildStore(gen->builder, vec, fnargs[0]);
+        return vec;
+    }
+    case StoreIntrinsic:
+    {
+        LLVMValueRef vecp = genlVecArrayPtr(gen, fnargs[1], fnargs[2], vectype);
+        LLVMValueRef store = LLVMBuildStore(gen->builder, fnargs[0], vecp);
+        LLVMSetAlignment(store, vectype->elemtype->bits / 8);
+        return store;
+    }
+    case SqrtIntrinsic:
+    {
+        char fnname[32];
+        sprintf(fnname, "llvm.sqrt.v%df%d", (int)vectype->lanes, (int)vectype->elemtype->bits);
+        return LLVMBuildCall(gen->builder, genlGetIntrinsicFn(gen, fnname, fnuse), fnargs, 1, "");
+    }
+    default:
+        // A scalar second operand applies to every lane
+        if (fncall->args->used > 1 && LLVMGetTypeKind(LLVMTypeOf(fnargs[1])) != LLVMVectorTypeKind)
+            fnargs[1] = genlVecSplat(gen, fnargs[1], LLVMTypeOf(fnargs[0]));
+        return NULL;
+    }
+}
+
 // Generate a function call, including special intrinsics
 LLVMValueRef genlFnCall(GenState *gen, FnCallNode *fncall) {
 
@@ -156,6 +347,16 @@ LLVMValueRef genlFnCall(GenState *gen, FnCallNode *fncall) {
         NbrNode *nbrtype = (NbrNode *)iexpGetTypeDcl(*nodesNodes(fncall->args));
         uint16_t typetag = nbrtype->tag;
 
+        // Vector intrinsics (v.load's self is a reference to the vector).
+        // Otherwise, the number intrinsics below work on all lanes at once
+        VecNode *vectype = (VecNode *)(typetag == RefTag ? itypeGetTypeDcl(((RefNode*)nbrtype)->pvtype) : (INode*)nbrtype);
+        if (vectype->tag == VecTag) {
+            if ((fncallret = genlVecIntrinsic(gen, fncall, fnargs, vectype, fnuse)))
+                break;
+            nbrtype = vectype->elemtype;
+            typetag = nbrtype->tag;
+        }
+
         // Pointer intrinsics
         if (typetag == PtrTag || typetag == RefTag) {
             INode *pvtype = itypeGetTypeDcl(typetag == PtrTag ? ((PtrNode*)nbrtype)->pvtype : ((RefNode*)nbrtype)->pvtype);
@@ -259,6 +460,15 @@ LLVMValueRef genlFnCall(GenState *gen, FnCallNode *fncall) {
                 break;
 
             }
+            case PrefetchIntrinsic: {
+                // Read, with high temporal locality, from the data cache
+                LLVMTypeRef i32 = LLVMInt32TypeInContext(gen->context);
+                LLVMTypeRef i8ptr = LLVMPointerType(LLVMInt8TypeInContext(gen->context), 0);
+                LLVMValueRef args[4] = { LLVMBuildBitCast(gen->builder, fnargs[0], i8ptr, ""),
+                    LLVMConstInt(i32, 0, 0), LLVMConstInt(i32, 3, 0), LLVMConstInt(i32, 1, 0) };
+                fncallret = genlCallIntrinsic(gen, "llvm.prefetch", i8ptr, args, 4);
+                break;
+            }
             }
         }
 
@@ -308,6 +518,9 @@ LLVMValueRef genlFnCall(GenState *gen, FnCallNode *fncall) {
                 fncallret = LLVMBuildCall(gen->builder, genlGetIntrinsicFn(gen, fnname, fnuse), fnargs, fncall->args->used, "");
                 break;
             }
+            case FmaIntrinsic: fncallret = genlCallIntrinsic(gen, "llvm.fma", LLVMTypeOf(fnargs[0]), fnargs, 3); break;
+            case MinIntrinsic: fncallret = genlCallIntrinsic(gen, "llvm.minnum", LLVMTypeOf(fnargs[0]), fnargs, 2); break;
+            case MaxIntrinsic: fncallret = genlCallIntrinsic(gen, "llvm.maxnum", LLVMTypeOf(fnargs[0]), fnargs, 2); break;
             }
         }
         // Signed and Unsigned Integer intrinsics
@@ -379,6 +592,8 @@ LLVMValueRef genlFnCall(GenState *gen, FnCallNode *fncall) {
                 else {
                     fncallret = LLVMBuildLShr(gen->builder, fnargs[0], fnargs[1], ""); break;
                 }
+            default:
+                fncallret = genlIntIntrinsic(gen, ((IntrinsicNode *)fndcl->value)->intrinsicFn, typetag == IntNbrTag, fnargs);
             }
         }
         break;
@@ -535,20 +750,23 @@ LLVMValueRef genlLogic(GenState *gen, LogicNode* node) {
     LLVMValueRef logicvals[2];
 
     // Set up basic blocks
-    logicblks[0] = LLVMGetInsertBlock(gen->builder);
+    LLVMBasicBlockRef rhsblk;
     logicphi = genlInsertBlock(gen, node->tag==AndLogicTag? "andphi" : "orphi");
-    logicblks[1] = genlInsertBlock(gen, node->tag==AndLogicTag? "andrhs" : "orrhs");
+    rhsblk = genlInsertBlock(gen, node->tag==AndLogicTag? "andrhs" : "orrhs");
 
-    // Generate left-hand condition and conditional branch
+    // Generate left-hand condition and conditional branch.
+    // Each side's phi block is wherever its code ended (e.g., after a bounds check)
     logicvals[0] = genlExpr(gen, node->lexp);
+    logicblks[0] = LLVMGetInsertBlock(gen->builder);
     if (node->tag==OrLogicTag)
-        LLVMBuildCondBr(gen->builder, logicvals[0], logicphi, logicblks[1]);
+        LLVMBuildCondBr(gen->builder, logicvals[0], logicphi, rhsblk);
     else
-        LLVMBuildCondBr(gen->builder, logicvals[0], logicblks[1], logicphi);
+        LLVMBuildCondBr(gen->builder, logicvals[0], rhsblk, logicphi);
 
     // Generate right-hand condition and branch to phi
-    LLVMPositionBuilderAtEnd(gen->builder, logicblks[1]);
+    LLVMPositionBuilderAtEnd(gen->builder, rhsblk);
     logicvals[1] = genlExpr(gen, node->rexp);
+    logicblks[1] = LLVMGetInsertBlock(gen->builder);
     LLVMBuildBr(gen->builder, logicphi);
 
     // Generate phi
@@ -595,6 +813,52 @@ void genlBoundsCheck(GenState *gen, LLVMValueRef index, LLVMValueRef count) {
     LLVMPositionBuilderAtEnd(gen->builder, boundsblk);
 }
 
+// Is this node an element of an soa array (a[i])?
+int genlIsSoaIndex(INode *node) {
+    return node->tag == ArrIndexTag && arrayIsSoa(iexpGetTypeDcl(((FnCallNode *)node)->objfn));
+}
+
+// Generate the soa array's address and bounds-checked index for an soa element (a[i])
+LLVMValueRef genlSoaIndex(GenState *gen, FnCallNode *fncall, LLVMValueRef *arrptr) {
+    ArrayNode *arrtype = (ArrayNode *)iexpGetTypeDcl(fncall->objfn);
+    *arrptr = genlAddr(gen, fncall->objfn);
+    LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
+    if (!(fncall->flags & FlagInBounds))
+        genlBoundsCheck(gen, index, LLVMConstInt(genlUsize(gen), arrtype->size, 0));
+    return index;
+}
+
+// Generate a pointer to a field of an soa element (a[i].x), within that field's own array
+LLVMValueRef genlSoaFieldAddr(GenState *gen, LLVMValueRef arrptr, LLVMValueRef index, unsigned int fldindex) {
+    LLVMValueRef indexes[3];
+    indexes[0] = LLVMConstInt(LLVMInt32TypeInContext(gen->context), 0, 0);
+    indexes[1] = LLVMConstInt(LLVMInt32TypeInContext(gen->context), fldindex, 0);
+    indexes[2] = index;
+    return LLVMBuildInBoundsGEP(gen->builder, arrptr, indexes, 3, "soafield");
+}
+
+// Load a whole soa element (a[i]) by gathering its fields into a struct value
+LLVMValueRef genlSoaLoad(GenState *gen, FnCallNode *fncall) {
+    LLVMValueRef arrptr;
+    LLVMValueRef index = genlSoaIndex(gen, fncall, &arrptr);
+    StructNode *strnode = (StructNode *)iexpGetTypeDcl((INode*)fncall);
+    LLVMValueRef strval = LLVMGetUndef(genlType(gen, (INode*)strnode));
+    for (unsigned int fld = 0; fld < strnode->fields.used; ++fld)
+        strval = LLVMBuildInsertValue(gen->builder, strval,
+            LLVMBuildLoad(gen->builder, genlSoaFieldAddr(gen, arrptr, index, fld), ""), fld, "soaelem");
+    return strval;
+}
+
+// Store a whole soa element (a[i]) by scattering the struct value's fields
+void genlSoaStore(GenState *gen, FnCallNode *fncall, LLVMValueRef strval) {
+    LLVMValueRef arrptr;
+    LLVMValueRef index = genlSoaIndex(gen, fncall, &arrptr);
+    StructNode *strnode = (StructNode *)iexpGetTypeDcl((INode*)fncall);
+    for (unsigned int fld = 0; fld < strnode->fields.used; ++fld)
+        LLVMBuildStore(gen->builder, LLVMBuildExtractValue(gen->builder, strval, fld, ""),
+            genlSoaFieldAddr(gen, arrptr, index, fld));
+}
+
 // Generate an lval-ish pointer to the value (vs. load)
 LLVMValueRef genlAddr(GenState *gen, INode *lval) {
     switch (lval->tag) {
@@ -614,7 +878,8 @@ LLVMValueRef genlAddr(GenState *gen, INode *lval) {
         case ArrayTag: {
             LLVMValueRef count = LLVMConstInt(genlUsize(gen), ((ArrayNode*)objtype)->size, 0);
             LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
-            genlBoundsCheck(gen, index, count);
+            if (!(fncall->flags & FlagInBounds))
+                genlBoundsCheck(gen, index, count);
             LLVMValueRef indexes[2];
             indexes[0] = LLVMConstInt(genlUsize(gen), 0, 0);
             indexes[1] = index;
@@ -624,7 +889,8 @@ LLVMValueRef genlAddr(GenState *gen, INode *lval) {
             LLVMValueRef arrref = genlExpr(gen, fncall->objfn);
             LLVMValueRef count = LLVMBuildExtractValue(gen->builder, arrref, 1, "count");
             LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
-            genlBoundsCheck(gen, index, count);
+            if (!(fncall->flags & FlagInBounds))
+                genlBoundsCheck(gen, index, count);
             LLVMValueRef sliceptr = LLVMBuildExtractValue(gen->builder, arrref, 0, "sliceptr");
             return LLVMBuildGEP(gen->builder, sliceptr, &index, 1, "");
         }
@@ -650,6 +916,11 @@ LLVMValueRef genlAddr(GenState *gen, INode *lval) {
             LLVMValueRef fldpRef = LLVMBuildGEP(gen->builder, objpRef, &vtblfld, 1, "");
             return LLVMBuildBitCast(gen->builder, fldpRef, LLVMPointerType(genlType(gen, flddcl->vtype), 0), "");
         }
+        if (genlIsSoaIndex(fncall->objfn)) {
+            LLVMValueRef arrptr;
+            LLVMValueRef index = genlSoaIndex(gen, (FnCallNode *)fncall->objfn, &arrptr);
+            return genlSoaFieldAddr(gen, arrptr, index, flddcl->index);
+        }
         return LLVMBuildStructGEP(gen->builder, genlAddr(gen, fncall->objfn), flddcl->index, &flddcl->namesym->namestr);
     }
     case StrLitTag:
@@ -669,6 +940,10 @@ LLVMValueRef genlAddr(GenState *gen, INode *lval) {
 void genlStore(GenState *gen, INode *lval, LLVMValueRef rval) {
     if (lval->tag == VarNameUseTag && ((NameUseNode*)lval)->namesym == anonName)
         return;
+    if (genlIsSoaIndex(lval)) {
+        genlSoaStore(gen, (FnCallNode *)lval, rval);
+        return;
+    }
     LLVMValueRef lvalptr = genlAddr(gen, lval);
     RefNode *reftype = (RefNode *)((IExpNode*)lval)->vtype;
     if (reftype->tag == RefTag && reftype->alloc == (INode*)rcAlloc)
@@ -678,9 +953,10 @@ void genlStore(GenState *gen, INode *lval, LLVMValueRef rval) {
 
 // Generate a term
 LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
-    if (!gen->opt->release && gen->fn) {
+    LLVMMetadataRef fnscope;
+    if (gen->dibuilder && gen->fn && (fnscope = LLVMGetSubprogram(gen->fn))) {
         LLVMMetadataRef loc = LLVMDIBuilderCreateDebugLocation(gen->context, 
-            termnode->linenbr, termnode->srcp-termnode->linep, LLVMGetSubprogram(gen->fn), NULL);
+            termnode->linenbr, termnode->srcp-termnode->linep, fnscope, NULL);
         LLVMValueRef val = LLVMMetadataAsValue(gen->context, loc);
         LLVMSetCurrentDebugLocation(gen->builder, val);
     }
@@ -701,7 +977,25 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
         uint32_t size = lit->args->used;
         INode **nodesp;
         uint32_t cnt;
-        if (littype->tag == ArrayTag) {
+        if (arrayIsSoa(littype)) {
+            // Transpose the literal's structs into one array per field
+            StructNode *strnode = (StructNode *)itypeGetTypeDcl(((ArrayNode *)littype)->elemtype);
+            LLVMValueRef *values = (LLVMValueRef *)memAllocBlk(size * sizeof(LLVMValueRef *));
+            LLVMValueRef *valuep = values;
+            for (nodesFor(lit->args, cnt, nodesp))
+                *valuep++ = genlExpr(gen, *nodesp);
+            LLVMTypeRef soatype = genlType(gen, littype);
+            LLVMValueRef soaval = LLVMGetUndef(soatype);
+            for (unsigned int fld = 0; fld < strnode->fields.used; ++fld) {
+                LLVMValueRef fldarr = LLVMGetUndef(LLVMStructGetTypeAtIndex(soatype, fld));
+                for (unsigned int i = 0; i < size; ++i)
+                    fldarr = LLVMBuildInsertValue(gen->builder, fldarr,
+                        LLVMBuildExtractValue(gen->builder, values[i], fld, ""), i, "soalit");
+                soaval = LLVMBuildInsertValue(gen->builder, soaval, fldarr, fld, "soalit");
+            }
+            return soaval;
+        }
+        else if (littype->tag == ArrayTag) {
             LLVMValueRef *values = (LLVMValueRef *)memAllocBlk(size * sizeof(LLVMValueRef *));
             LLVMValueRef *valuep = values;
             for (nodesFor(lit->args, cnt, nodesp))
@@ -709,15 +1003,37 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
             return LLVMConstArray(genlType(gen, ((ArrayNode *)lit->vtype)->elemtype), values, size);
         }
         else if (littype->tag == StructTag) {
+            // Literal values are in declared field order, which may differ from the struct's layout
+            LLVMValueRef *values = (LLVMValueRef *)memAllocBlk(size * sizeof(LLVMValueRef *));
+            FieldDclNode **fieldp = (FieldDclNode **)((StructNode *)littype)->fields.nodes;
+            int isconst = 1;
+            for (nodesFor(lit->args, cnt, nodesp)) {
+                LLVMValueRef val = genlExpr(gen, *nodesp);
+                isconst = isconst && LLVMIsConstant(val);
+                values[(*fieldp++)->index] = val;
+            }
+            // A constant struct may also initialize a global variable
+            if (isconst)
+                return LLVMConstNamedStruct(genlType(gen, littype), values, size);
             LLVMValueRef strval = LLVMGetUndef(genlType(gen, littype));
-            unsigned int pos = 0;
-            for (nodesFor(lit->args, cnt, nodesp))
-                strval = LLVMBuildInsertValue(gen->builder, strval, genlExpr(gen, *nodesp), pos++, "literal");
+            for (uint32_t i = 0; i < size; ++i)
+                strval = LLVMBuildInsertValue(gen->builder, strval, values[i], i, "literal");
             return strval;
         }
         else if (littype->tag == IntNbrTag || littype->tag == UintNbrTag || littype->tag == FloatNbrTag) {
             return genlConvert(gen, nodesGet(lit->args, 0), lit->objfn);
         }
+        else if (littype->tag == VecTag) {
+            LLVMTypeRef vectype = genlType(gen, littype);
+            if (size == 1)
+                return genlVecSplat(gen, genlExpr(gen, nodesGet(lit->args, 0)), vectype);
+            LLVMValueRef vecval = LLVMGetUndef(vectype);
+            unsigned int pos = 0;
+            for (nodesFor(lit->args, cnt, nodesp))
+                vecval = LLVMBuildInsertElement(gen->builder, vecval, genlExpr(gen, *nodesp),
+                    LLVMConstInt(LLVMInt32TypeInContext(gen->context), pos++, 0), "literal");
+            return vecval;
+        }
         else {
             errorMsgNode((INode*)lit, ErrorBadTerm, "Unknown literal type to generate");
             return NULL;
@@ -775,7 +1091,8 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
             case ArrayTag: {
                 LLVMValueRef count = LLVMConstInt(genlUsize(gen), ((ArrayNode*)objtype)->size, 0);
                 LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
-                genlBoundsCheck(gen, index, count);
+                if (!(fncall->flags & FlagInBounds))
+                    genlBoundsCheck(gen, index, count);
                 LLVMValueRef indexes[2];
                 indexes[0] = LLVMConstInt(genlUsize(gen), 0, 0);
                 indexes[1] = index;
@@ -787,7 +1104,8 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
                 LLVMValueRef arrref = genlExpr(gen, deref->exp);
                 LLVMValueRef count = LLVMBuildExtractValue(gen->builder, arrref, 1, "count");
                 LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
-                genlBoundsCheck(gen, index, count);
+                if (!(fncall->flags & FlagInBounds))
+                    genlBoundsCheck(gen, index, count);
                 LLVMValueRef sliceptr = LLVMBuildExtractValue(gen->builder, arrref, 0, "sliceptr");
                 return LLVMBuildGEP(gen->builder, sliceptr, &index, 1, "");
             }
@@ -795,7 +1113,8 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
                 LLVMValueRef arrref = genlExpr(gen, fncall->objfn);
                 LLVMValueRef count = LLVMBuildExtractValue(gen->builder, arrref, 1, "count");
                 LLVMValueRef index = genlExpr(gen, nodesGet(fncall->args, 0));
-                genlBoundsCheck(gen, index, count);
+                if (!(fncall->flags & FlagInBounds))
+                    genlBoundsCheck(gen, index, count);
                 LLVMValueRef sliceptr = LLVMBuildExtractValue(gen->builder, arrref, 0, "sliceptr");
                 return LLVMBuildGEP(gen->builder, sliceptr, &index, 1, "");
             }
@@ -807,6 +1126,8 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
                 assert(0 && "Unknown type of arrindex element indexing node");
             }
         }
+        else if (genlIsSoaIndex(termnode))
+            return genlSoaLoad(gen, (FnCallNode *)termnode);
         else
             return LLVMBuildLoad(gen->builder, genlAddr(gen, termnode), "");
     case StrFieldTag:
@@ -814,7 +1135,7 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
         FnCallNode *fncall = (FnCallNode *)termnode;
         FieldDclNode *flddcl = (FieldDclNode*)((NameUseNode*)fncall->methfld)->dclnode;
         INode *objtyp = iexpGetTypeDcl(fncall->objfn);
-        if (objtyp->tag == VirtRefTag) {
+        if (objtyp->tag == VirtRefTag || genlIsSoaIndex(fncall->objfn)) {
             LLVMValueRef fldpRef = genlAddr(gen, termnode);
             return (termnode->flags & FlagBorrow)? fldpRef : LLVMBuildLoad(gen->builder, fldpRef, "");
         }
@@ -885,12 +1206,15 @@ LLVMValueRef genlExpr(GenState *gen, INode *termnode) {
         // To pattern match a virtual reference, compare vtable pointers
         if (exptype->tag == VirtRefTag) {
             LLVMValueRef vtablep = LLVMBuildExtractValue(gen->builder, val, 1, "");
-            Vtable *vtable = structGetBaseTrait(structtype)->vtable;
+            Vtable *vtable = ((StructNode*)itypeGetTypeDcl(((RefNode*)exptype)->pvtype))->vtable;
             INode **nodesp;
             uint32_t cnt;
             for (nodesFor(vtable->impl, cnt, nodesp)) {
                 VtableImpl *impl = (VtableImpl*)*nodesp;
                 if (impl->structdcl == (INode*)structtype) {
+                    // No virtual reference holds a vtable the program never coerces to
+                    if (!impl->reached)
+                        return LLVMConstInt(LLVMInt1TypeInContext(gen->context), 0, 0);
                     LLVMValueRef diff = LLVMBuildPtrDiff(gen->builder, vtablep, impl->llvmvtablep, "");
                     LLVMValueRef zero = LLVMConstInt(LLVMInt64TypeInContext(gen->context), 0, 0);
                     return LLVMBuildICmp(gen->builder, LLVMIntEQ, diff, zero, "isvtable");
@@ -0,0 +1,133 @@
+/** In-process JIT execution via LLVM ORC
+ * @file
+ *
+ * With --run, the generated module is handed to LLVM's ORC JIT rather than
+ * written out as an object file. The lazy JIT (LLLazyJIT, set up in genllazy.cpp) compiles
+ * each function only when it is first called, starting with main(), so code a run never
+ * reaches is never compiled. The module is built in the JIT's thread-safe context
+ * from the start (see genSetup), so it is handed over as is.
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "../ir/ir.h"
+#include "../shared/error.h"
+#include "../coneopts.h"
+#include "genllvm.h"
+
+#include <llvm-c/Target.h>
+#include <llvm-c/LLJIT.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Report a JIT error (and consume it)
+static void genlJitError(char *what, LLVMErrorRef err) {
+    char *msg = LLVMGetErrorMessage(err);
+    errorMsg(ErrorGenErr, "%s: %s", what, msg);
+    LLVMDisposeErrorMessage(msg);
+}
+
+// Resolve the program's unresolved symbols against the host process, all but
+// main() (as mangled in ctx), which must be the program's own, not the compiler's
+static int genlJitHostSymbol(void *ctx, LLVMOrcSymbolStringPoolEntryRef sym) {
+    return strcmp(LLVMOrcSymbolStringPoolEntryStr(sym), (char *)ctx) != 0;
+}
+
+// Hand the generated module over to the JIT
+void genlJitModule(GenState *gen) {
+    // The JIT takes ownership of its own target machine, which must be for the host.
+    // JIT-ed code and data may land anywhere in the address space, so use PIC.
+    char *hosttriple = LLVMGetDefaultTargetTriple();
+    int ishost = strcmp(gen->opt->triple, hosttriple) == 0;
+    LLVMDisposeMessage(hosttriple);
+    int svpic = gen->opt->pic;
+    gen->opt->pic = 1;
+    LLVMTargetMachineRef machine = ishost ? genlCreateMachine(gen->opt) : NULL;
+    gen->opt->pic = svpic;
+    if (!machine) {
+        if (!ishost)
+            errorMsg(ErrorGenErr, "--run only supports the host target, not %s", gen->opt->triple);
+        LLVMDisposeModule(gen->module);
+        gen->module = NULL;
+        return;
+    }
+    LLVMSetTarget(gen->module, gen->opt->triple);
+    LLVMTargetDataRef dataref = LLVMCreateTargetDataLayout(machine);
+    char *layout = LLVMCopyStringRepOfTargetData(dataref);
+    LLVMSetDataLayout(gen->module, layout);
+    LLVMDisposeMessage(layout);
+    LLVMDisposeTargetData(dataref);
+
+    // The module was built in the context the JIT shares (gen->tsctx)
+    LLVMOrcThreadSafeModuleRef tsmod = LLVMOrcCreateNewThreadSafeModule(gen->module, gen->tsctx);
+    gen->module = NULL;
+
+    LLVMErrorRef err = genlJitCreateLazy(&gen->jit,
+        LLVMOrcJITTargetMachineBuilderCreateFromTargetMachine(machine));
+    if (err) {
+        genlJitError("Could not create JIT", err);
+        gen->jit = NULL;
+        LLVMOrcDisposeThreadSafeModule(tsmod);
+        return;
+    }
+
+    // Make the host process's symbols (C library) visible to JIT-compiled code
+    static char mainsym[8];
+    char prefix = LLVMOrcLLJITGetGlobalPrefix(gen->jit);
+    snprintf(mainsym, sizeof(mainsym), prefix ? "%cmain" : "main", prefix);
+    LLVMOrcDefinitionGeneratorRef procsyms;
+    err = LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(&procsyms,
+        prefix, genlJitHostSymbol, mainsym);
+    if (err) {
+        genlJitError("Could not expose host process symbols to JIT", err);
+        LLVMOrcDisposeThreadSafeModule(tsmod);
+        genlJitDispose(gen);
+        return;
+    }
+    LLVMOrcJITDylibAddGenerator(LLVMOrcLLJITGetMainJITDylib(gen->jit), procsyms);
+
+    // The JIT takes the module, even if it cannot be added
+    err = genlJitAddLazyModule(gen->jit, LLVMOrcLLJITGetMainJITDylib(gen->jit), tsmod);
+    if (err) {
+        genlJitError("Could not JIT module", err);
+        genlJitDispose(gen);
+    }
+}
+
+// Dispose of the JIT, and the code it compiled
+void genlJitDispose(GenState *gen) {
+    if (gen->jit == NULL)
+        return;
+    genlJitDisposeLazy(gen->jit);
+    gen->jit = NULL;
+}
+
+// Run the JIT-compiled program's main(), returning its exit code
+int genlJitRun(GenState *gen) {
+    if (gen->jit == NULL)
+        return ExitError;
+
+    LLVMOrcExecutorAddress mainaddr = 0;
+    LLVMErrorRef err = LLVMOrcLLJITLookup(gen->jit, &mainaddr, "main");
+    if (err || mainaddr == 0) {
+        if (err)
+            LLVMConsumeError(err);
+        errorMsg(ErrorGenErr, "--run could not find a main() function to run");
+        genlJitDispose(gen);
+        return ExitError;
+    }
+
+    // Flush compiler output, so it does not interleave with the program's
+    fflush(stdout);
+    fflush(stderr);
+    int (*mainfn)() = (int (*)())(uintptr_t)mainaddr;
+    int result = mainfn();
+    fflush(stdout);
+
+    genlJitDispose(gen);
+    return result;
+}
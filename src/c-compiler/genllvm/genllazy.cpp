@@ -0,0 +1,66 @@
+/** Lazy JIT compilation
+ * @file
+ *
+ * LLVM's C API offers only the eager LLJIT, which compiles a whole module as soon as
+ * any of its symbols is looked up. The lazy one (LLLazyJIT), which compiles each function
+ * when it is first called, is only in LLVM's C++ API, so it is set up here.
+ * Everything else about the JIT is done through the C API (see genljit.c).
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+
+#include <llvm-c/Error.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+
+#include <cstdlib>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+// The C API's handles are these C++ objects
+static LLJIT *genlUnwrapJit(LLVMOrcLLJITRef jit) {
+    return reinterpret_cast<LLJIT *>(jit);
+}
+
+// Called in place of a function that could not be compiled (after LLVM has reported why)
+static void genlJitLazyFailed() {
+    exit(1);    // ExitError (error.h is C-only)
+}
+
+// Create a JIT that compiles each function of the modules added by genlJitAddLazyModule
+// when it is first called. It takes ownership of the target machine builder.
+// Its handle works with the C API's LLJIT functions, except that it must be disposed
+// by genlJitDisposeLazy.
+extern "C" LLVMErrorRef genlJitCreateLazy(LLVMOrcLLJITRef *jit, LLVMOrcJITTargetMachineBuilderRef jtmb) {
+    std::unique_ptr<JITTargetMachineBuilder> builder(reinterpret_cast<JITTargetMachineBuilder *>(jtmb));
+    Expected<std::unique_ptr<LLLazyJIT>> lazyjit = LLLazyJITBuilder()
+        .setJITTargetMachineBuilder(std::move(*builder))
+        .setLazyCompileFailureAddr(pointerToJITTargetAddress(&genlJitLazyFailed))
+        .create();
+    if (!lazyjit) {
+        *jit = nullptr;
+        return wrap(lazyjit.takeError());
+    }
+    *jit = reinterpret_cast<LLVMOrcLLJITRef>(static_cast<LLJIT *>(lazyjit->release()));
+    return LLVMErrorSuccess;
+}
+
+// Add a module to a lazy JIT, which takes ownership of it. Its functions are compiled when first called.
+extern "C" LLVMErrorRef genlJitAddLazyModule(LLVMOrcLLJITRef jit, LLVMOrcJITDylibRef jd, LLVMOrcThreadSafeModuleRef tsmod) {
+    std::unique_ptr<ThreadSafeModule> mod(reinterpret_cast<ThreadSafeModule *>(tsmod));
+    LLLazyJIT *lazyjit = static_cast<LLLazyJIT *>(genlUnwrapJit(jit));
+    return wrap(lazyjit->addLazyIRModule(*reinterpret_cast<JITDylib *>(jd), std::move(*mod)));
+}
+
+// Dispose of a lazy JIT, and the code it compiled
+// (LLJIT's destructor is not virtual, so LLVMOrcDisposeLLJIT cannot do this)
+extern "C" void genlJitDisposeLazy(LLVMOrcLLJITRef jit) {
+    delete static_cast<LLLazyJIT *>(genlUnwrapJit(jit));
+}
@@ -0,0 +1,268 @@
+/** Linking generated code into an executable or static library
+ * @file
+ *
+ * With --link, the generated object is emitted into memory rather than to an object file.
+ * - A --library is written straight out as a static library archive (.a or .lib),
+ *   with the symbol index linkers need, so no archiver is run.
+ * - A program is handed to the system linker (--linker, by default the C compiler driver)
+ *   to be linked with the C runtime into an executable. On Linux the linker reads the object
+ *   from an anonymous in-memory file. Elsewhere it is written to an object file that is
+ *   removed once linked.
+ *
+ * Executables are not linked in-process, as LLD is not embedded. LLD has no C API, and its
+ * libraries (liblld) ship apart from LLVM's own, so most LLVM installs conec builds against
+ * lack them. Even with them, a linker needs the C runtime's startup objects and library paths,
+ * which only the C compiler driver knows for each platform. So the linker is run as a command.
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // For memfd_create
+#endif
+
+#include "../ir/ir.h"
+#include "../shared/error.h"
+#include "../shared/fileio.h"
+#include "../coneopts.h"
+#include "genllvm.h"
+
+#include <llvm-c/TargetMachine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define linkasmext "asm"
+#define linkobjext "obj"
+#define linklibext "lib"
+#define linkdefault "link"
+#else
+#define linkasmext "s"
+#define linkobjext "o"
+#define linklibext "a"
+#define linkdefault "cc"
+#endif
+#define linkpgodefault "clang"
+
+// Is the target's object format Mach-O (Apple)?
+static int genlLinkIsApple(GenState *gen) {
+    return strstr(gen->opt->triple, "apple") || strstr(gen->opt->triple, "darwin");
+}
+
+// Is the target Windows (COFF objects, MSVC-style linker)?
+static int genlLinkIsWindows(GenState *gen) {
+    return strstr(gen->opt->triple, "windows") != NULL;
+}
+
+// Write an archive member's header
+static void genlLinkArHeader(FILE *file, char *name, size_t size) {
+    fprintf(file, "%-16s%-12s%-6s%-6s%-8s%-10lu`\n", name, "0", "0", "0", "644", (unsigned long)size);
+}
+
+// Write a 32-bit number, big-endian (as the archive symbol index has them)
+static void genlLinkArU32(FILE *file, uint32_t nbr) {
+    fputc((nbr >> 24) & 0xFF, file);
+    fputc((nbr >> 16) & 0xFF, file);
+    fputc((nbr >> 8) & 0xFF, file);
+    fputc(nbr & 0xFF, file);
+}
+
+// Is this global defined by the module and visible to other objects (so the index lists it)?
+static int genlLinkIsExported(LLVMValueRef glo) {
+    if (LLVMIsDeclaration(glo))
+        return 0;
+    LLVMLinkage linkage = LLVMGetLinkage(glo);
+    return linkage != LLVMInternalLinkage && linkage != LLVMPrivateLinkage
+        && linkage != LLVMAvailableExternallyLinkage;
+}
+
+// Add a symbol's name to the archive's symbol index (or, if names is NULL, just count it)
+static void genlLinkArSymbol(LLVMValueRef glo, char *names, size_t *namesize, uint32_t *nsyms) {
+    if (!genlLinkIsExported(glo))
+        return;
+    size_t len;
+    const char *name = LLVMGetValueName2(glo, &len);
+    if (len == 0 || strncmp(name, "llvm.", 5) == 0)
+        return;
+    if (names)
+        memcpy(names + *namesize, name, len + 1);
+    *namesize += len + 1;
+    ++*nsyms;
+}
+
+// Gather the names of every symbol the module's object defines for other objects.
+// Return the size of the names (each 0-terminated), written to names unless it is NULL
+static size_t genlLinkArSymbols(LLVMModuleRef mod, char *names, uint32_t *nsyms) {
+    size_t namesize = 0;
+    *nsyms = 0;
+    LLVMValueRef glo;
+    for (glo = LLVMGetFirstFunction(mod); glo; glo = LLVMGetNextFunction(glo))
+        genlLinkArSymbol(glo, names, &namesize, nsyms);
+    for (glo = LLVMGetFirstGlobal(mod); glo; glo = LLVMGetNextGlobal(glo))
+        genlLinkArSymbol(glo, names, &namesize, nsyms);
+    for (glo = LLVMGetFirstGlobalIFunc(mod); glo; glo = LLVMGetNextGlobalIFunc(glo))
+        genlLinkArSymbol(glo, names, &namesize, nsyms);
+    return namesize;
+}
+
+// Write a static library archive holding the object, in the common (GNU and COFF) format:
+// a symbol index member ("/") naming every exported symbol, then the object member
+static void genlLinkArchive(GenState *gen, LLVMModuleRef mod, char *libpath, char *fname,
+                            const char *obj, size_t objsize) {
+    uint32_t nsyms;
+    size_t namesize = genlLinkArSymbols(mod, NULL, &nsyms);
+    char *names = memAllocBlk(namesize + 1);
+    genlLinkArSymbols(mod, names, &nsyms);
+
+    FILE *file = fopen(libpath, "wb");
+    if (!file) {
+        errorMsg(ErrorGenErr, "Could not write static library %s", libpath);
+        return;
+    }
+    fputs("!<arch>\n", file);
+
+    // The symbol index: every symbol is in the one object member, which follows the index
+    size_t indexsize = 4 + 4 * nsyms + namesize;
+    size_t objoffset = 8 + 60 + indexsize + (indexsize & 1);
+    genlLinkArHeader(file, "/", indexsize);
+    genlLinkArU32(file, nsyms);
+    uint32_t i;
+    for (i = 0; i < nsyms; i++)
+        genlLinkArU32(file, (uint32_t)objoffset);
+    fwrite(names, 1, namesize, file);
+    if (indexsize & 1)
+        fputc('\n', file);
+
+    // The object member, named (if need be, shortened) after the source file
+    char membername[17];
+    snprintf(membername, sizeof(membername), "%.12s.%s/", fname, linkobjext);
+    genlLinkArHeader(file, membername, objsize);
+    fwrite(obj, 1, objsize, file);
+    if (objsize & 1)
+        fputc('\n', file);
+    if (fclose(file) != 0)
+        errorMsg(ErrorGenErr, "Could not write static library %s", libpath);
+}
+
+// Run the system linker on the object, to make an executable
+static void genlLinkExe(GenState *gen, char *exepath, char *fname, const char *obj, size_t objsize) {
+    ConeOptions *opt = gen->opt;
+    // clang's profile runtime (what -fprofile-instr-generate links) writes the .profraw
+    // files --pgo-use reads; gcc's -fprofile-generate writes .gcda files it cannot
+    int pgodriver = opt->pgo_gen && !genlLinkIsWindows(gen);
+    char *linker = opt->linker ? opt->linker : pgodriver ? linkpgodefault : linkdefault;
+    int isclang = strstr(linker, "clang") != NULL;
+    if (pgodriver && !isclang) {
+        errorMsg(ErrorGenErr, "--pgo-gen needs clang to link in its profile runtime, not %s", linker);
+        return;
+    }
+    char objpath[64];
+    char *tmppath = NULL;
+    int objfd = -1;
+
+    // Give the linker the object: in memory if we can, else in a file we remove afterwards
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    objfd = memfd_create(fname, 0);
+    if (objfd >= 0 && write(objfd, obj, objsize) == (ssize_t)objsize)
+        snprintf(objpath, sizeof(objpath), "/dev/fd/%d", objfd);
+    else if (objfd >= 0) {
+        close(objfd);
+        objfd = -1;
+    }
+#endif
+    if (objfd < 0) {
+        tmppath = fileMakePath(opt->output, fname, linkobjext);
+        FILE *file = fopen(tmppath, "wb");
+        if (!file || fwrite(obj, 1, objsize, file) != objsize) {
+            errorMsg(ErrorGenErr, "Could not write object file %s for the linker", tmppath);
+            if (file)
+                fclose(file);
+            return;
+        }
+        fclose(file);
+    }
+
+    // Build the linker's command line, for an MSVC-style linker or a C compiler driver
+    char cmd[4096];
+    char *objarg = tmppath ? tmppath : objpath;
+    if (genlLinkIsWindows(gen))
+        snprintf(cmd, sizeof(cmd), "%s /NOLOGO /OUT:\"%s\"%s%s \"%s\" libcmt.lib",
+            linker, exepath, opt->link_arch ? " /MACHINE:" : "", opt->link_arch ? opt->link_arch : "", objarg);
+    else {
+        // Only Apple's driver and clang can link for another architecture. (-march= picks
+        // a CPU to compile for, which means nothing when the driver is only linking.)
+        char archarg[128] = { '\0' };
+        if (opt->link_arch) {
+            if (genlLinkIsApple(gen))
+                snprintf(archarg, sizeof(archarg), " -arch %s", opt->link_arch);
+            else if (isclang)
+                snprintf(archarg, sizeof(archarg), " --target=%s", opt->link_arch);
+            else {
+                errorMsg(ErrorGenErr, "--link-arch needs clang (--linker=clang) to link for %s", opt->link_arch);
+                return;
+            }
+        }
+        snprintf(cmd, sizeof(cmd), "%s -o \"%s\"%s%s%s \"%s\"",
+            linker, exepath, archarg,
+            opt->pic || genlLinkIsApple(gen) ? "" : " -no-pie",
+            opt->pgo_gen ? " -fprofile-instr-generate" : "",
+            objarg);
+    }
+    if (opt->verbosity >= 3)
+        fprintf(stderr, "%s\n", cmd);
+    fflush(stdout);
+    if (system(cmd) != 0)
+        errorMsg(ErrorGenErr, "Could not link %s. The linker command was: %s", exepath, cmd);
+
+#if defined(__linux__)
+    if (objfd >= 0)
+        close(objfd);
+#endif
+    if (tmppath)
+        remove(tmppath);
+}
+
+// Emit the module's object into memory, then link it into an executable
+// (or, for --library, a static library) named after fname
+void genlLink(GenState *gen, LLVMModuleRef mod, char *fname) {
+    char *err;
+    if (gen->opt->print_asm
+        && LLVMTargetMachineEmitToFile(gen->machine, mod, fileMakePath(gen->opt->output, fname, linkasmext), LLVMAssemblyFile, &err) != 0) {
+        errorMsg(ErrorGenErr, "Could not emit asm file: %s", err);
+        LLVMDisposeMessage(err);
+    }
+
+    LLVMMemoryBufferRef objbuf;
+    if (LLVMTargetMachineEmitToMemoryBuffer(gen->machine, mod, LLVMObjectFile, &err, &objbuf) != 0) {
+        errorMsg(ErrorGenErr, "Could not emit object: %s", err);
+        LLVMDisposeMessage(err);
+        return;
+    }
+    const char *obj = LLVMGetBufferStart(objbuf);
+    size_t objsize = LLVMGetBufferSize(objbuf);
+
+    if (gen->opt->library) {
+        if (genlLinkIsApple(gen))
+            errorMsg(ErrorGenErr, "--link cannot write Mach-O static libraries. Archive the object with libtool instead.");
+        else
+            genlLinkArchive(gen, mod, fileMakePath(gen->opt->output, fname, linklibext), fname, obj, objsize);
+    }
+    else {
+#ifdef _WIN32
+        char *exepath = fileMakePath(gen->opt->output, fname, "exe");
+#else
+        char *exepath = fileMakePath(gen->opt->output, fname, "");
+        exepath[strlen(exepath) - 1] = '\0';    // No extension (nor its '.')
+#endif
+        genlLinkExe(gen, exepath, fname, obj, objsize);
+    }
+    LLVMDisposeMemoryBuffer(objbuf);
+}
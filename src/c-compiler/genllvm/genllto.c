@@ -0,0 +1,260 @@
+/** Link-time optimization across separately compiled packages
+ * @file
+ *
+ * A package compiled with --emit-bitcode is written out as LLVM bitcode (.bc) rather than
+ * an object. Bitcode files named on the command line are then optimized together
+ * with the programs being compiled, in one of two ways:
+ * - --lto links every program and bitcode module into one module, internalizes all
+ *   but its entry points, optimizes the whole program at once, and emits one object.
+ * - --thinlto keeps each module separate. Each program imports copies of the bitcode
+ *   modules' definitions as available_externally, so their functions can be inlined
+ *   but are never emitted twice. Each module is then optimized and emitted on its own
+ *   (so separate conec runs can build them in parallel), and each bitcode module is emitted
+ *   once as its own object.
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "../ir/ir.h"
+#include "../shared/error.h"
+#include "../shared/memory.h"
+#include "../shared/fileio.h"
+#include "../coneopts.h"
+#include "genllvm.h"
+
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Linker.h>
+#include <llvm-c/Transforms/IPO.h>
+#include <llvm-c/Transforms/Scalar.h>
+#include <llvm-c/Transforms/PassManagerBuilder.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define ltoobjext "obj"
+#else
+#define ltoobjext "o"
+#endif
+
+// Bitcode modules named on the command line, and the program modules linked so far (--lto)
+typedef struct {
+    char **paths;                  // Paths of bitcode files
+    LLVMModuleRef *mods;           // Each bitcode file's module, once loaded
+    uint32_t used;
+    uint32_t avail;
+    LLVMModuleRef linked;          // All program modules linked together (--lto)
+    char *linkedname;              // File name of the first program, which names the output
+} GenLto;
+
+GenLto gLto = { NULL, NULL, 0, 0, NULL, NULL };
+
+// Is this command line argument a bitcode file (rather than a program's source)?
+int genlLtoIsBitcode(char *path) {
+    size_t len = strlen(path);
+    return len > 3 && strcmp(&path[len - 3], ".bc") == 0;
+}
+
+// Add a bitcode file to be optimized with the programs (at link time)
+void genlLtoAddBitcode(char *path) {
+    if (gLto.used >= gLto.avail) {
+        char **oldpaths = gLto.paths;
+        gLto.avail = gLto.avail == 0 ? 8 : gLto.avail << 1;
+        gLto.paths = (char**)memAllocBlk(gLto.avail * sizeof(char*));
+        gLto.mods = (LLVMModuleRef*)memAllocBlk(gLto.avail * sizeof(LLVMModuleRef));
+        if (oldpaths)
+            memcpy(gLto.paths, oldpaths, gLto.used * sizeof(char*));
+    }
+    gLto.paths[gLto.used] = path;
+    gLto.mods[gLto.used++] = NULL;
+}
+
+// Load every bitcode file's module into the generator's context (once)
+static void genlLtoLoad(GenState *gen) {
+    uint32_t i;
+    for (i = 0; i < gLto.used; i++) {
+        if (gLto.mods[i])
+            continue;
+        LLVMMemoryBufferRef buf;
+        char *err = NULL;
+        if (LLVMCreateMemoryBufferWithContentsOfFile(gLto.paths[i], &buf, &err)) {
+            errorMsg(ErrorGenErr, "Cannot read bitcode file %s: %s", gLto.paths[i], err);
+            LLVMDisposeMessage(err);
+            continue;
+        }
+        if (LLVMParseBitcodeInContext2(gen->context, buf, &gLto.mods[i]))
+            errorMsg(ErrorGenErr, "%s is not a valid LLVM bitcode file", gLto.paths[i]);
+        LLVMDisposeMemoryBuffer(buf);
+    }
+}
+
+// Report the linker's complaints (e.g., a symbol defined twice) as our own errors,
+// rather than letting LLVM exit
+static void genlLtoDiagnostic(LLVMDiagnosticInfoRef info, void *ctx) {
+    char *msg = LLVMGetDiagInfoDescription(info);
+    if (LLVMGetDiagInfoSeverity(info) == LLVMDSError)
+        errorMsg(ErrorGenErr, "Linking %s: %s", (char *)ctx, msg);
+    LLVMDisposeMessage(msg);
+}
+
+// Link src into dest (src is consumed). Return 0 on failure
+static int genlLtoLink(LLVMModuleRef dest, LLVMModuleRef src, char *srcname) {
+    LLVMContextRef context = LLVMGetModuleContext(dest);
+    LLVMDiagnosticHandler oldhandler = LLVMContextGetDiagnosticHandler(context);
+    void *oldctx = LLVMContextGetDiagnosticContext(context);
+    LLVMContextSetDiagnosticHandler(context, genlLtoDiagnostic, srcname);
+    int failed = LLVMLinkModules2(dest, src);
+    LLVMContextSetDiagnosticHandler(context, oldhandler, oldctx);
+    return !failed;
+}
+
+// Write the optimized module out as bitcode (--emit-bitcode)
+void genlLtoEmitBitcode(GenState *gen, char *fname) {
+    char *path = fileMakePath(gen->opt->output, fname, "bc");
+    if (LLVMWriteBitcodeToFile(gen->module, path) != 0)
+        errorMsg(ErrorGenErr, "Could not emit bitcode file %s", path);
+}
+
+// Add the program's optimized module to the whole program being linked (--lto).
+// The module is consumed: nothing is emitted until genlLtoFinish
+void genlLtoAddProgram(GenState *gen, char *fname) {
+    if (gLto.linked == NULL) {
+        gLto.linked = gen->module;
+        gLto.linkedname = fname;
+        return;
+    }
+    genlLtoLink(gLto.linked, gen->module, fname);
+}
+
+// Import the bitcode modules' definitions into the program's module as available_externally
+// (--thinlto), then inline them where profitable. They are not emitted with the program.
+void genlLtoImport(GenState *gen) {
+    genlLtoLoad(gen);
+    uint32_t i;
+    for (i = 0; i < gLto.used; i++) {
+        if (gLto.mods[i] == NULL)
+            continue;
+        LLVMModuleRef import = LLVMCloneModule(gLto.mods[i]);
+
+        // Exported functions become available_externally copies of the package's definitions.
+        // Internal ones stay internal: they are only emitted if a copy is called and not inlined.
+        LLVMValueRef fn;
+        for (fn = LLVMGetFirstFunction(import); fn; fn = LLVMGetNextFunction(fn)) {
+            if (!LLVMIsDeclaration(fn) && LLVMGetLinkage(fn) == LLVMExternalLinkage)
+                LLVMSetLinkage(fn, LLVMAvailableExternallyLinkage);
+        }
+        // A @multiversion function's ifunc is defined by its own package, so calls go to a declaration
+        LLVMValueRef ifunc = LLVMGetFirstGlobalIFunc(import);
+        while (ifunc) {
+            LLVMValueRef next = LLVMGetNextGlobalIFunc(ifunc);
+            size_t len;
+            const char *name = LLVMGetValueName2(ifunc, &len);
+            LLVMValueRef decl = LLVMAddFunction(import, "", LLVMGetElementType(LLVMTypeOf(ifunc)));
+            LLVMReplaceAllUsesWith(ifunc, decl);
+            LLVMSetValueName2(decl, name, len);
+            LLVMEraseGlobalIFunc(ifunc);
+            ifunc = next;
+        }
+        // Exported constants may be folded; other exported variables must live in one place
+        LLVMValueRef var;
+        for (var = LLVMGetFirstGlobal(import); var; var = LLVMGetNextGlobal(var)) {
+            if (LLVMIsDeclaration(var) || LLVMGetLinkage(var) != LLVMExternalLinkage)
+                continue;
+            if (LLVMIsGlobalConstant(var))
+                LLVMSetLinkage(var, LLVMAvailableExternallyLinkage);
+            else
+                LLVMSetInitializer(var, NULL);
+        }
+        genlLtoLink(gen->module, import, gLto.paths[i]);
+    }
+
+    // Inline the imported functions, then discard whatever copies are left unused
+    LLVMPassManagerRef passmgr = LLVMCreatePassManager();
+    LLVMAddAnalysisPasses(gen->machine, passmgr);
+    LLVMAddFunctionInliningPass(passmgr);
+    LLVMAddGlobalDCEPass(passmgr);
+    LLVMAddInstructionCombiningPass(passmgr);
+    LLVMAddGVNPass(passmgr);
+    LLVMAddCFGSimplificationPass(passmgr);
+    LLVMRunPassManager(passmgr, gen->module);
+    LLVMDisposePassManager(passmgr);
+}
+
+// Give internal linkage to every definition not needed outside the whole program:
+// everything but main(), or (for a library) everything but its public (not hidden) names
+static void genlLtoInternalize(LLVMModuleRef mod, int library) {
+    LLVMValueRef fn;
+    for (fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        if (LLVMIsDeclaration(fn) || LLVMGetLinkage(fn) != LLVMExternalLinkage)
+            continue;
+        size_t len;
+        const char *name = LLVMGetValueName2(fn, &len);
+        if (strcmp(name, "main") != 0 && (!library || LLVMGetVisibility(fn) == LLVMHiddenVisibility))
+            LLVMSetLinkage(fn, LLVMInternalLinkage);
+    }
+    LLVMValueRef var;
+    for (var = LLVMGetFirstGlobal(mod); var; var = LLVMGetNextGlobal(var)) {
+        if (LLVMIsDeclaration(var) || LLVMGetLinkage(var) != LLVMExternalLinkage)
+            continue;
+        if (!library || LLVMGetVisibility(var) == LLVMHiddenVisibility)
+            LLVMSetLinkage(var, LLVMInternalLinkage);
+    }
+}
+
+// Emit one module as an object file named after fname (or link it, with --link)
+static void genlLtoOut(GenState *gen, LLVMModuleRef mod, char *fname) {
+    if (gen->opt->link) {
+        genlLink(gen, mod, fname);
+        return;
+    }
+    genlOut(fileMakePath(gen->opt->output, fname, gen->opt->wasm? "wasm" : ltoobjext), NULL,
+        mod, gen->opt->triple, gen->machine);
+}
+
+// Finish link-time optimization, once all programs are compiled:
+// - --lto: link in the bitcode modules, optimize the whole program, and emit it as one object
+// - --thinlto: emit each bitcode module as its own object
+void genlLtoFinish(GenState *gen) {
+    genlLtoLoad(gen);
+    uint32_t i;
+
+    if (gen->opt->lto == LtoThin) {
+        for (i = 0; i < gLto.used; i++) {
+            if (gLto.mods[i])
+                genlLtoOut(gen, gLto.mods[i], fileName(gLto.paths[i]));
+        }
+        return;
+    }
+
+    if (gLto.linked == NULL)
+        return;
+    for (i = 0; i < gLto.used; i++) {
+        if (gLto.mods[i])
+            genlLtoLink(gLto.linked, gLto.mods[i], gLto.paths[i]);
+        gLto.mods[i] = NULL;
+    }
+    if (errors)
+        return;
+
+    // Whole-program optimization, now that every caller and callee is visible
+    genlLtoInternalize(gLto.linked, gen->opt->library);
+    LLVMPassManagerBuilderRef pmb = LLVMPassManagerBuilderCreate();
+    LLVMPassManagerBuilderSetOptLevel(pmb, gen->opt->release ? 3 : 0);
+    LLVMPassManagerRef passmgr = LLVMCreatePassManager();
+    LLVMAddAnalysisPasses(gen->machine, passmgr);
+    LLVMPassManagerBuilderPopulateLTOPassManager(pmb, passmgr, 0, gen->opt->release);
+    LLVMRunPassManager(passmgr, gLto.linked);
+    LLVMDisposePassManager(passmgr);
+    LLVMPassManagerBuilderDispose(pmb);
+
+    char *err;
+    if (gen->opt->print_llvmir && LLVMPrintModuleToFile(gLto.linked, fileMakePath(gen->opt->output, gLto.linkedname, "lto.ir"), &err) != 0) {
+        errorMsg(ErrorGenErr, "Could not emit ir file: %s", err);
+        LLVMDisposeMessage(err);
+    }
+    genlLtoOut(gen, gLto.linked, gLto.linkedname);
+    LLVMDisposeModule(gLto.linked);
+    gLto.linked = NULL;
+}
@@ -20,9 +20,10 @@
 #include <llvm-c/BitWriter.h>
 #include <llvm-c/Transforms/Scalar.h>
 #include <llvm-c/Transforms/IPO.h>
-#if LLVM_VERSION_MAJOR >= 7
-#include "llvm-c/Transforms/Utils.h"
-#endif
+#include <llvm-c/Transforms/Vectorize.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+#include <llvm-c/Support.h>
+#include <llvm-c/Transforms/Utils.h>
 
 #include <stdio.h>
 #include <assert.h>
@@ -44,22 +45,19 @@ void genlParmVar(GenState *gen, VarDclNode *var) {
     LLVMBuildStore(gen->builder, LLVMGetParam(gen->fn, var->index), var->llvmvar);
 }
 
-// Generate a function
-void genlFn(GenState *gen, FnDclNode *fnnode) {
-    if (fnnode->value->tag == IntrinsicTag)
-        return;
-
+// Generate a function's body into fn
+void genlFnBody(GenState *gen, FnDclNode *fnnode, LLVMValueRef fn) {
     LLVMValueRef svfn = gen->fn;
     LLVMBuilderRef svbuilder = gen->builder;
 	LLVMValueRef svallocaPoint = gen->allocaPoint;
 
 	FnSigNode *fnsig = (FnSigNode*)fnnode->vtype;
     assert(fnnode->value->tag == BlockTag);
-    gen->fn = fnnode->llvmvar;
+    gen->fn = fn;
 
     // Attach block and builder to function
     LLVMBasicBlockRef entry = LLVMAppendBasicBlockInContext(gen->context, gen->fn, "entry");
-    gen->builder = LLVMCreateBuilder();
+    gen->builder = LLVMCreateBuilderInContext(gen->context);
     LLVMPositionBuilderAtEnd(gen->builder, entry);
 
 	// Create our alloca insert point by generating a dummy instruction.
@@ -130,6 +128,196 @@ char *genlMangleMethName(char *workbuf, FnDclNode *node) {
     return workbuf;
 }
 
+// Add an attribute (e.g., "noinline") to a function
+void genlFnAttr(GenState *gen, LLVMValueRef fn, char *attrname) {
+    unsigned kind = LLVMGetEnumAttributeKindForName(attrname, strlen(attrname));
+    LLVMAddAttributeAtIndex(fn, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(gen->context, kind, 0));
+}
+
+// Add the LLVM attributes that implement a function's attributes (e.g., @inline)
+void genlFnAttrs(GenState *gen, FnDclNode *glofn, LLVMValueRef fn) {
+    uint16_t attrs = glofn->attrs;
+    if (attrs & FnAttrInline)
+        genlFnAttr(gen, fn, "alwaysinline");
+    if (attrs & FnAttrNoInline)
+        genlFnAttr(gen, fn, "noinline");
+    if (attrs & FnAttrHot)
+        genlFnAttr(gen, fn, "hot");
+    if (attrs & FnAttrCold) {
+        // Cold code is also made small, and calls to it mark their paths as unlikely
+        genlFnAttr(gen, fn, "cold");
+        genlFnAttr(gen, fn, "minsize");
+        genlFnAttr(gen, fn, "optsize");
+    }
+    if (attrs & FnAttrPure)
+        genlFnAttr(gen, fn, "readnone");
+    else if (attrs & FnAttrReadOnly)
+        genlFnAttr(gen, fn, "readonly");
+    if (attrs & FnAttrNoReturn)
+        genlFnAttr(gen, fn, "noreturn");
+    if (attrs & (FnAttrPure | FnAttrReadOnly))
+        genlFnAttr(gen, fn, "nounwind");
+}
+
+// Get the debug info for a source file, making it on first use
+LLVMMetadataRef genlDiFile(GenState *gen, char *url) {
+    uint32_t i;
+    for (i = 0; i < gen->difilecnt; i++) {
+        if (gen->difiles[i].url == url || strcmp(gen->difiles[i].url, url) == 0)
+            return gen->difiles[i].file;
+    }
+    if (gen->difilecnt >= gen->difileavail) {
+        GenDiFile *olddifiles = gen->difiles;
+        gen->difileavail = gen->difileavail == 0 ? 16 : gen->difileavail << 1;
+        gen->difiles = (GenDiFile*)memAllocBlk(gen->difileavail * sizeof(GenDiFile));
+        if (olddifiles)
+            memcpy(gen->difiles, olddifiles, gen->difilecnt * sizeof(GenDiFile));
+    }
+
+    // Split the url into its folder (without the trailing slash) and file name
+    size_t namepos = fileFolder(url);
+    char *name = url + namepos;
+    char *dir = namepos > 0 ? url : ".";
+    size_t dirlen = namepos > 1 ? namepos - 1 : 1;
+    LLVMMetadataRef file = LLVMDIBuilderCreateFile(gen->dibuilder, name, strlen(name), dir, dirlen);
+    gen->difiles[gen->difilecnt].url = url;
+    gen->difiles[gen->difilecnt++].file = file;
+    return file;
+}
+
+// Attach debug info to an implemented function, locating it in its own source file.
+// Functions from included files get none if only the program's own file is wanted.
+void genlFnDebugInfo(GenState *gen, FnDclNode *glofn, LLVMValueRef fn, char *fnname, char *manglednm) {
+    if (gen->dibuilder == NULL || glofn->lexer == NULL)
+        return;
+    char *url = glofn->lexer->url;
+    if (gen->opt->debug_main && strcmp(url, gen->diurl) != 0)
+        return;
+    LLVMMetadataRef file = genlDiFile(gen, url);
+    LLVMMetadataRef fntype = LLVMDIBuilderCreateSubroutineType(gen->dibuilder,
+        file, NULL, 0, 0);
+    LLVMMetadataRef sp = LLVMDIBuilderCreateFunction(gen->dibuilder, file,
+        fnname, strlen(fnname), manglednm, strlen(manglednm),
+        file, glofn->linenbr, fntype, 0, 1, glofn->linenbr, LLVMDIFlagPublic, 0);
+    LLVMSetSubprogram(fn, sp);
+}
+
+// The feature levels a @multiversion function is compiled for (x86), from least to most capable.
+// A version is chosen at load time when the CPU has all its feature bits
+// (from the __cpu_model that libgcc and compiler-rt fill in for __builtin_cpu_supports)
+typedef struct {
+    char *suffix;           // Appended to the function's name
+    char *features;         // LLVM target features the version is compiled with
+    uint32_t cpubits;       // Feature bits it needs in __cpu_model.__cpu_features[0]
+} GenlFnVersion;
+
+#define CpuPopcnt (1u << 2)
+#define CpuSse42 (1u << 8)
+#define CpuAvx2 (1u << 10)
+#define CpuFma (1u << 14)
+#define CpuAvx512f (1u << 15)
+#define CpuBmi (1u << 16)
+#define CpuBmi2 (1u << 17)
+#define CpuAvx512vl (1u << 20)
+#define CpuAvx512bw (1u << 21)
+#define CpuAvx512dq (1u << 22)
+
+GenlFnVersion genlFnVersions[] = {
+    { "sse4.2", "+sse4.2,+popcnt", CpuSse42 | CpuPopcnt },
+    { "avx2", "+avx2,+fma,+bmi,+bmi2,+sse4.2,+popcnt", CpuAvx2 | CpuFma | CpuBmi | CpuBmi2 | CpuSse42 | CpuPopcnt },
+    { "avx512", "+avx512f,+avx512vl,+avx512bw,+avx512dq,+avx2,+fma,+bmi,+bmi2,+sse4.2,+popcnt",
+        CpuAvx512f | CpuAvx512vl | CpuAvx512bw | CpuAvx512dq | CpuAvx2 | CpuFma | CpuBmi | CpuBmi2 | CpuSse42 | CpuPopcnt },
+};
+#define GenlFnVersionCnt (sizeof(genlFnVersions) / sizeof(GenlFnVersion))
+
+// Can @multiversion functions be dispatched by ifunc for this target?
+// That needs an x86 ELF target, and an object file (the JIT already targets the host CPU).
+int genlMultiversionOk(GenState *gen) {
+    char *triple = gen->opt->triple;
+    return !gen->opt->run && !gen->opt->wasm
+        && (strncmp(triple, "x86_64", 6) == 0 || (triple[0] == 'i' && strncmp(triple + 2, "86", 2) == 0))
+        && !strstr(triple, "windows") && !strstr(triple, "apple") && !strstr(triple, "darwin");
+}
+
+// Build the ifunc resolver that picks the best version of a @multiversion function
+// for the running CPU. It runs when the program is loaded (before constructors).
+LLVMValueRef genlMultiversionResolver(GenState *gen, char *manglednm, LLVMTypeRef fntype, LLVMValueRef *versions) {
+    LLVMTypeRef i32type = LLVMInt32TypeInContext(gen->context);
+    LLVMTypeRef fnptrtype = LLVMPointerType(fntype, 0);
+
+    // libgcc/compiler-rt's CPU model, and the function that fills it in
+    LLVMValueRef cpumodel = LLVMGetNamedGlobal(gen->module, "__cpu_model");
+    if (!cpumodel) {
+        LLVMTypeRef fields[4] = { i32type, i32type, i32type, LLVMArrayType(i32type, 1) };
+        cpumodel = LLVMAddGlobal(gen->module, LLVMStructTypeInContext(gen->context, fields, 4, 0), "__cpu_model");
+    }
+    LLVMValueRef cpuinit = LLVMGetNamedFunction(gen->module, "__cpu_indicator_init");
+    if (!cpuinit)
+        cpuinit = LLVMAddFunction(gen->module, "__cpu_indicator_init", LLVMFunctionType(LLVMVoidTypeInContext(gen->context), NULL, 0, 0));
+
+    char resolvernm[2048];
+    snprintf(resolvernm, sizeof(resolvernm), "%s.resolver", manglednm);
+    LLVMValueRef resolver = LLVMAddFunction(gen->module, resolvernm, LLVMFunctionType(fnptrtype, NULL, 0, 0));
+    LLVMSetLinkage(resolver, LLVMInternalLinkage);
+    LLVMBuilderRef builder = LLVMCreateBuilderInContext(gen->context);
+    LLVMPositionBuilderAtEnd(builder, LLVMAppendBasicBlockInContext(gen->context, resolver, "entry"));
+    LLVMBuildCall(builder, cpuinit, NULL, 0, "");
+    LLVMValueRef idx[3] = { LLVMConstInt(i32type, 0, 0), LLVMConstInt(i32type, 3, 0), LLVMConstInt(i32type, 0, 0) };
+    LLVMValueRef cpubits = LLVMBuildLoad(builder, LLVMBuildInBoundsGEP(builder, cpumodel, idx, 3, ""), "cpufeatures");
+
+    // Later (more capable) versions win over earlier ones when the CPU supports them
+    LLVMValueRef chosen = versions[0];
+    uint32_t i;
+    for (i = 0; i < GenlFnVersionCnt; i++) {
+        LLVMValueRef need = LLVMConstInt(i32type, genlFnVersions[i].cpubits, 0);
+        LLVMValueRef has = LLVMBuildICmp(builder, LLVMIntEQ, LLVMBuildAnd(builder, cpubits, need, ""), need, "");
+        chosen = LLVMBuildSelect(builder, has, versions[i + 1], chosen, "");
+    }
+    LLVMBuildRet(builder, chosen);
+    LLVMDisposeBuilder(builder);
+    return resolver;
+}
+
+// Turn a @multiversion function into a version for each feature level, plus the default.
+// Its name becomes an ifunc that resolves (at load time) to the best version for the CPU,
+// so callers (and pointers to it) reach that version without further dispatch.
+void genlMultiversion(GenState *gen, FnDclNode *glofn, char *fnname, char *manglednm) {
+    LLVMValueRef versions[GenlFnVersionCnt + 1];
+    LLVMTypeRef fntype = genlType(gen, glofn->vtype);
+    char versionnm[2048];
+
+    // The function as already declared becomes the default version
+    versions[0] = glofn->llvmvar;
+    snprintf(versionnm, sizeof(versionnm), "%s.default", manglednm);
+    LLVMSetValueName2(versions[0], versionnm, strlen(versionnm));
+    LLVMSetLinkage(versions[0], LLVMInternalLinkage);
+
+    uint32_t i;
+    for (i = 0; i < GenlFnVersionCnt; i++) {
+        snprintf(versionnm, sizeof(versionnm), "%s.%s", manglednm, genlFnVersions[i].suffix);
+        LLVMValueRef version = LLVMAddFunction(gen->module, versionnm, fntype);
+        LLVMSetLinkage(version, LLVMInternalLinkage);
+        genlFnAttrs(gen, glofn, version);
+
+        // Add the level's features to any the whole program is compiled with
+        size_t featlen = strlen(gen->opt->features) + strlen(genlFnVersions[i].features) + 2;
+        char *features = memAllocBlk(featlen);
+        if (*gen->opt->features)
+            snprintf(features, featlen, "%s,%s", gen->opt->features, genlFnVersions[i].features);
+        else
+            snprintf(features, featlen, "%s", genlFnVersions[i].features);
+        LLVMAddAttributeAtIndex(version, LLVMAttributeFunctionIndex,
+            LLVMCreateStringAttribute(gen->context, "target-features", 15, features, strlen(features)));
+        genlFnDebugInfo(gen, glofn, version, fnname, versionnm);
+        versions[i + 1] = version;
+    }
+
+    LLVMValueRef resolver = genlMultiversionResolver(gen, manglednm, fntype, versions);
+    glofn->llvmvar = LLVMAddGlobalIFunc(gen->module, manglednm, strlen(manglednm), fntype, 0, resolver);
+    if (fnname[0] == '_')
+        LLVMSetVisibility(glofn->llvmvar, LLVMHiddenVisibility);
+}
+
 // Generate LLVMValueRef for a global function
 void genlGloFnName(GenState *gen, FnDclNode *glofn) {
     // Add function to the module
@@ -151,28 +339,55 @@ void genlGloFnName(GenState *gen, FnDclNode *glofn) {
             // Private globals should be hidden. (public globals have DefaultVisibility)            
             LLVMSetVisibility(glofn->llvmvar, LLVMHiddenVisibility);
         }
+        genlFnAttrs(gen, glofn, glofn->llvmvar);
 
         // Add metadata on implemented functions (debug mode only)
-        if (!gen->opt->release && glofn->value) {
-            LLVMMetadataRef fntype = LLVMDIBuilderCreateSubroutineType(gen->dibuilder,
-                gen->difile, NULL, 0, 0);
-            LLVMMetadataRef sp = LLVMDIBuilderCreateFunction(gen->dibuilder, gen->difile,
-                fnname, strlen(fnname), manglednm, strlen(manglednm),
-                gen->difile, glofn->linenbr, fntype, 0, 1, glofn->linenbr, LLVMDIFlagPublic, 0);
-            LLVMSetSubprogram(glofn->llvmvar, sp);
+        if (glofn->value)
+            genlFnDebugInfo(gen, glofn, glofn->llvmvar, fnname, manglednm);
+
+        // Compile a version per CPU feature level, chosen at load time
+        if ((glofn->attrs & FnAttrMultiversion) && glofn->value) {
+            if (genlMultiversionOk(gen))
+                genlMultiversion(gen, glofn, fnname, manglednm);
+            else if (!gen->opt->run)
+                errorMsgNode((INode*)glofn, WarnMultiversion, "@multiversion needs an x86 ELF target. Compiling one version.");
         }
     }
 }
 
+// Generate a function. A @multiversion function has its body generated
+// once for each of its versions, each compiled for its own CPU features.
+void genlFn(GenState *gen, FnDclNode *fnnode) {
+    if (fnnode->value->tag == IntrinsicTag)
+        return;
+    if (!LLVMIsAGlobalIFunc(fnnode->llvmvar)) {
+        genlFnBody(gen, fnnode, fnnode->llvmvar);
+        return;
+    }
+    size_t len;
+    const char *manglednm = LLVMGetValueName2(fnnode->llvmvar, &len);
+    char versionnm[2048];
+    snprintf(versionnm, sizeof(versionnm), "%s.default", manglednm);
+    genlFnBody(gen, fnnode, LLVMGetNamedFunction(gen->module, versionnm));
+    uint32_t i;
+    for (i = 0; i < GenlFnVersionCnt; i++) {
+        snprintf(versionnm, sizeof(versionnm), "%s.%s", manglednm, genlFnVersions[i].suffix);
+        genlFnBody(gen, fnnode, LLVMGetNamedFunction(gen->module, versionnm));
+    }
+}
+
 // Generate module's nodes
 void genlModule(GenState *gen, ModuleNode *mod) {
     uint32_t cnt;
     INode **nodesp;
 
     // First generate the global variable LLVMValueRef for every global variable
-    // This way forward references to global variables will work correctly
+    // This way forward references to global variables will work correctly.
+    // Functions and variables the program cannot reach are not generated.
     for (nodesFor(mod->nodes, cnt, nodesp)) {
         INode *nodep = *nodesp;
+        if ((nodep->tag == VarDclTag || nodep->tag == FnDclTag) && !(nodep->flags & FlagReached))
+            continue;
         if (nodep->tag == VarDclTag)
             genlGloVarName(gen, (VarDclNode *)nodep);
         else if (nodep->tag == FnDclTag)
@@ -182,6 +397,8 @@ void genlModule(GenState *gen, ModuleNode *mod) {
     // Generate the function's block or the variable's initialization value
     for (nodesFor(mod->nodes, cnt, nodesp)) {
         INode *nodep = *nodesp;
+        if ((nodep->tag == VarDclTag || nodep->tag == FnDclTag) && !(nodep->flags & FlagReached))
+            continue;
         switch (nodep->tag) {
         case VarDclTag:
             if (((VarDclNode*)nodep)->value) {
@@ -204,6 +421,10 @@ void genlModule(GenState *gen, ModuleNode *mod) {
             genlModule(gen, (ModuleNode*)nodep);
             break;
 
+        // Only a generic's instances (also module nodes) are generated
+        case GenericTag:
+            break;
+
         default:
             // No need to generate type declarations: type uses will do so
             if (isTypeNode(nodep))
@@ -217,15 +438,27 @@ void genlPackage(GenState *gen, ModuleNode *mod) {
 
     assert(mod->tag == ModuleTag);
     gen->module = LLVMModuleCreateWithNameInContext(gen->opt->srcname, gen->context);
-    if (!gen->opt->release) {
+
+    // Debug builds describe functions (in their source files) and the lines of their code.
+    // Line tables only (--debug-lines) leave out the rest (e.g., types and variables).
+    gen->dibuilder = NULL;
+    gen->difilecnt = 0;
+    if (!gen->opt->release && !gen->opt->strip_debug) {
         gen->dibuilder = LLVMCreateDIBuilder(gen->module);
-        gen->difile = LLVMDIBuilderCreateFile(gen->dibuilder, "main.cone", 9, ".", 1);
+        gen->diurl = mod->lexer->url;
+        gen->difile = genlDiFile(gen, gen->diurl);
         gen->compileUnit = LLVMDIBuilderCreateCompileUnit(gen->dibuilder, LLVMDWARFSourceLanguageC,
-            gen->difile, "Cone compiler", 13, 0, "", 0, 0, "", 0, LLVMDWARFEmissionFull, 0, 0, 0);
+            gen->difile, "Cone compiler", 13, 0, "", 0, 0, "", 0,
+            gen->opt->debug_lines? LLVMDWARFEmissionLineTablesOnly : LLVMDWARFEmissionFull, 0, 0, 0, "", 0, "", 0);
+        LLVMAddModuleFlag(gen->module, LLVMModuleFlagBehaviorWarning, "Debug Info Version", 18,
+            LLVMValueAsMetadata(LLVMConstInt(LLVMInt32TypeInContext(gen->context), LLVMDebugMetadataVersion(), 0)));
     }
     genlModule(gen, mod);
-    if (!gen->opt->release)
+    if (gen->dibuilder) {
         LLVMDIBuilderFinalize(gen->dibuilder);
+        LLVMDisposeDIBuilder(gen->dibuilder);
+        gen->dibuilder = NULL;
+    }
 }
 
 // Use provided options (triple, etc.) to creation a machine
@@ -254,6 +487,12 @@ LLVMTargetMachineRef genlCreateMachine(ConeOptions *opt) {
     // Create a specific target machine
     opt_level = opt->release? LLVMCodeGenLevelAggressive : LLVMCodeGenLevelNone;
     reloc = (opt->pic || opt->library)? LLVMRelocPIC : LLVMRelocDefault;
+    // --cpu=native targets the host's CPU, with all the features it has
+    if (opt->cpu && strcmp(opt->cpu, "native") == 0) {
+        opt->cpu = LLVMGetHostCPUName();
+        if (!opt->features)
+            opt->features = LLVMGetHostCPUFeatures();
+    }
     if (!opt->cpu)
         opt->cpu = "generic";
     if (!opt->features)
@@ -291,6 +530,73 @@ void genlOut(char *objpath, char *asmpath, LLVMModuleRef mod, char *triple, LLVM
     }
 }
 
+// Report LLVM's complaints about profile data as our own errors and warnings,
+// rather than letting LLVM exit
+void genlPgoDiagnostic(LLVMDiagnosticInfoRef info, void *ctx) {
+    char *msg = LLVMGetDiagInfoDescription(info);
+    LLVMDiagnosticSeverity severity = LLVMGetDiagInfoSeverity(info);
+    if (severity == LLVMDSError)
+        errorMsg(ErrorGenErr, "Profile data: %s", msg);
+    else if (severity == LLVMDSWarning)
+        errorMsg(WarnProfile, "Profile data: %s", msg);
+    LLVMDisposeMessage(msg);
+}
+
+// Instrument the module to count how often each block runs (--pgo-gen),
+// or weight its branches and functions by the counts from instrumented runs (--pgo-use).
+// Both work on the module as generated (before optimization), so counts match its blocks.
+void genlPgo(GenState *gen) {
+    if (!gen->opt->pgo_gen && !gen->opt->pgo_use)
+        return;
+    if (gen->opt->pgo_use) {
+        FILE *profile = fopen(gen->opt->pgo_use, "rb");
+        if (profile == NULL) {
+            errorMsg(ErrorGenErr, "Could not read profile data file %s", gen->opt->pgo_use);
+            return;
+        }
+        fclose(profile);
+    }
+
+    LLVMDiagnosticHandler oldhandler = LLVMContextGetDiagnosticHandler(gen->context);
+    void *oldctx = LLVMContextGetDiagnosticContext(gen->context);
+    LLVMContextSetDiagnosticHandler(gen->context, genlPgoDiagnostic, NULL);
+    if (gen->opt->pgo_use)
+        genlPgoUseProfile(gen->module, gen->machine, gen->opt->pgo_use);
+    else {
+        LLVMPassBuilderOptionsRef pbopts = LLVMCreatePassBuilderOptions();
+        LLVMErrorRef err = LLVMRunPasses(gen->module, "pgo-instr-gen,instrprof", gen->machine, pbopts);
+        if (err) {
+            char *msg = LLVMGetErrorMessage(err);
+            errorMsg(ErrorGenErr, "Could not instrument the program for profiling: %s", msg);
+            LLVMDisposeErrorMessage(msg);
+        }
+        LLVMDisposePassBuilderOptions(pbopts);
+    }
+    LLVMContextSetDiagnosticHandler(gen->context, oldhandler, oldctx);
+}
+
+// Count the module's defined functions and their basic blocks (into fns and blocks, unless NULL),
+// and return the number of their instructions
+uint64_t genlCountCode(LLVMModuleRef mod, uint32_t *fns, uint32_t *blocks) {
+    uint64_t insts = 0;
+    LLVMValueRef fn;
+    for (fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        if (LLVMIsDeclaration(fn))
+            continue;
+        if (fns)
+            ++*fns;
+        LLVMBasicBlockRef blk;
+        for (blk = LLVMGetFirstBasicBlock(fn); blk; blk = LLVMGetNextBasicBlock(blk)) {
+            if (blocks)
+                ++*blocks;
+            LLVMValueRef inst;
+            for (inst = LLVMGetFirstInstruction(blk); inst; inst = LLVMGetNextInstruction(inst))
+                ++insts;
+        }
+    }
+    return insts;
+}
+
 // Generate IR nodes into LLVM IR using LLVM
 void genmod(GenState *gen, ModuleNode *mod) {
     char *err;
@@ -316,18 +622,41 @@ void genmod(GenState *gen, ModuleNode *mod) {
         LLVMDisposeMessage(err);
     }
 
-    // Optimize the generated LLVM IR
+    int stats = gen->opt->print_stats || gen->opt->stats_json;
+    if (stats)
+        gStats.llvminsts = genlCountCode(gen->module, &gStats.llvmfns, &gStats.llvmblocks);
+
+    // Optimize the generated LLVM IR, for the target's data layout
     timerBegin(OptTimer);
+    LLVMSetTarget(gen->module, gen->opt->triple);
+    LLVMSetModuleDataLayout(gen->module, gen->datalayout);
+    genlPgo(gen);
     LLVMPassManagerRef passmgr = LLVMCreatePassManager();
+    LLVMAddAnalysisPasses(gen->machine, passmgr);
     LLVMAddDemoteMemoryToRegisterPass(passmgr);        // Demote allocas to registers.
     LLVMAddInstructionCombiningPass(passmgr);        // Do simple "peephole" and bit-twiddling optimizations
     LLVMAddReassociatePass(passmgr);                // Reassociate expressions.
     LLVMAddGVNPass(passmgr);                        // Eliminate common subexpressions.
     LLVMAddCFGSimplificationPass(passmgr);            // Simplify the control flow graph
-    if (gen->opt->release)
+    if (gen->opt->release) {
         LLVMAddFunctionInliningPass(passmgr);        // Function inlining
+        // Vectorize counted loops (e.g., 'each' over arrays), using the target's cost model
+        LLVMAddPromoteMemoryToRegisterPass(passmgr);
+        LLVMAddLoopRotatePass(passmgr);
+        LLVMAddIndVarSimplifyPass(passmgr);
+        LLVMAddLoopVectorizePass(passmgr);
+        LLVMAddInstructionCombiningPass(passmgr);
+        LLVMAddCFGSimplificationPass(passmgr);
+    }
+    // Generic instances often compile to identical code (e.g., for references to different types)
+    if (gGenericStats.insts > 0)
+        LLVMAddMergeFunctionsPass(passmgr);
     LLVMRunPassManager(passmgr, gen->module);
     LLVMDisposePassManager(passmgr);
+    if (stats)
+        gStats.llvmoptinsts = genlCountCode(gen->module, NULL, NULL);
+    if (gen->opt->lto == LtoThin)
+        genlLtoImport(gen);
 
     // Serialize the LLVM IR, if requested
     if (gen->opt->print_llvmir && LLVMPrintModuleToFile(gen->module, fileMakePath(gen->opt->output, mod->lexer->fname, "ir"), &err) != 0) {
@@ -336,8 +665,25 @@ void genmod(GenState *gen, ModuleNode *mod) {
     }
 
     // Transform IR to target's ASM and OBJ
+    // or hand it to the JIT to run in-process
+    // or keep it as bitcode for link-time optimization
     timerBegin(CodeGenTimer);
-    if (gen->machine)
+    if (gen->opt->run) {
+        genlJitModule(gen);
+        return;
+    }
+    if (gen->opt->emit_bitcode) {
+        genlLtoEmitBitcode(gen, mod->lexer->fname);
+        LLVMDisposeModule(gen->module);
+        return;
+    }
+    if (gen->opt->lto == LtoFull) {
+        genlLtoAddProgram(gen, mod->lexer->fname);
+        return;
+    }
+    if (gen->machine && gen->opt->link)
+        genlLink(gen, gen->module, mod->lexer->fname);
+    else if (gen->machine)
         genlOut(fileMakePath(gen->opt->output, mod->lexer->fname, gen->opt->wasm? "wasm" : objext),
             gen->opt->print_asm? fileMakePath(gen->opt->output, mod->lexer->fname, gen->opt->wasm? "wat" : asmext) : NULL,
             gen->module, gen->opt->triple, gen->machine);
@@ -359,14 +705,29 @@ void genSetup(GenState *gen, ConeOptions *opt) {
     gen->datalayout = LLVMCreateTargetDataLayout(machine);
     opt->ptrsize = LLVMPointerSize(gen->datalayout) << 3;
 
-    gen->context = LLVMGetGlobalContext(); // LLVM inlining bugs prevent use of LLVMContextCreate();
+    // With --run, modules are built in a context the JIT can take them in (a thread-safe one).
+    // It is shared by all programs, as the global context is, as types are kept across programs.
+    gen->tsctx = NULL;
+    if (opt->run) {
+        gen->tsctx = LLVMOrcCreateNewThreadSafeContext();
+        gen->context = LLVMOrcThreadSafeContextGetContext(gen->tsctx);
+    }
+    else
+        gen->context = LLVMGetGlobalContext(); // LLVM inlining bugs prevent use of LLVMContextCreate();
     gen->fn = NULL;
     gen->allocaPoint = NULL;
     gen->block = NULL;
     gen->loopstack = memAllocBlk(sizeof(GenLoopState)*GenLoopMax);
     gen->loopstackcnt = 0;
+    gen->jit = NULL;
+    gen->dibuilder = NULL;
+    gen->difiles = NULL;
+    gen->difilecnt = 0;
+    gen->difileavail = 0;
 }
 
 void genClose(GenState *gen) {
     LLVMDisposeTargetMachine(gen->machine);
+    if (gen->tsctx)
+        LLVMOrcDisposeThreadSafeContext(gen->tsctx);    // The JIT's modules keep it alive
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include <llvm-c/Core.h>
 #include <llvm-c/DebugInfo.h>
 #include <llvm-c/ExecutionEngine.h>
+#include <llvm-c/LLJIT.h>
 
 // An entry for each active loop block in current control flow stack
 #define GenLoopMax 256
@@ -26,6 +27,12 @@ typedef struct {
     uint32_t loopPhiCnt;
 } GenLoopState;
 
+// A source file's debug info, made the first time one of its functions needs it
+typedef struct {
+    char *url;
+    LLVMMetadataRef file;
+} GenDiFile;
+
 typedef struct GenState {
     LLVMTargetMachineRef machine;
     LLVMTargetDataRef datalayout;
@@ -36,9 +43,16 @@ typedef struct GenState {
     LLVMBuilderRef builder;
     LLVMBasicBlockRef block;
 
-    LLVMDIBuilderRef dibuilder;
+    LLVMDIBuilderRef dibuilder;    // Builds debug info (NULL when there is none)
     LLVMMetadataRef compileUnit;
-    LLVMMetadataRef difile;
+    LLVMMetadataRef difile;        // The program's source file
+    char *diurl;                   // The program's source url
+    GenDiFile *difiles;            // Source files that debug info refers to, made as needed
+    uint32_t difilecnt;
+    uint32_t difileavail;
+
+    LLVMOrcLLJITRef jit;    // JIT instance, when running in-process (--run)
+    LLVMOrcThreadSafeContextRef tsctx;    // With --run, the JIT-shareable context that context is
 
     ConeOptions *opt;
     GenLoopState *loopstack;
@@ -52,6 +66,49 @@ void genmod(GenState *gen, ModuleNode *mod);
 void genlFn(GenState *gen, FnDclNode *fnnode);
 void genlGloVarName(GenState *gen, VarDclNode *glovar);
 void genlGloFnName(GenState *gen, FnDclNode *glofn);
+// Create a target machine for the specified target options
+LLVMTargetMachineRef genlCreateMachine(ConeOptions *opt);
+// Generate requested object file
+void genlOut(char *objpath, char *asmpath, LLVMModuleRef mod, char *triple, LLVMTargetMachineRef machine);
+
+// genljit.c
+// Hand the generated module over to the JIT (which takes ownership of it)
+void genlJitModule(GenState *gen);
+// Dispose of the JIT, and the code it compiled
+void genlJitDispose(GenState *gen);
+// Run the JIT-compiled program's main(), returning its exit code
+int genlJitRun(GenState *gen);
+
+// genllazy.cpp
+// Create a JIT that compiles each function when it is first called (it takes ownership of jtmb)
+LLVMErrorRef genlJitCreateLazy(LLVMOrcLLJITRef *jit, LLVMOrcJITTargetMachineBuilderRef jtmb);
+// Add a module to a lazy JIT, which takes ownership of it
+LLVMErrorRef genlJitAddLazyModule(LLVMOrcLLJITRef jit, LLVMOrcJITDylibRef jd, LLVMOrcThreadSafeModuleRef tsmod);
+// Dispose of a lazy JIT, and the code it compiled
+void genlJitDisposeLazy(LLVMOrcLLJITRef jit);
+
+// genlpgo.cpp
+// Weight the module's branches and functions by the counts in a profile data file
+void genlPgoUseProfile(LLVMModuleRef mod, LLVMTargetMachineRef machine, const char *profile);
+
+// genllink.c
+// Emit the module's object into memory, then link it into an executable
+// (or, for --library, a static library) named after fname
+void genlLink(GenState *gen, LLVMModuleRef mod, char *fname);
+
+// genllto.c
+// Is this command line argument a bitcode file (rather than a program's source)?
+int genlLtoIsBitcode(char *path);
+// Add a bitcode file to be optimized with the programs (at link time)
+void genlLtoAddBitcode(char *path);
+// Write the optimized module out as bitcode (--emit-bitcode)
+void genlLtoEmitBitcode(GenState *gen, char *fname);
+// Add the program's optimized module to the whole program being linked (--lto)
+void genlLtoAddProgram(GenState *gen, char *fname);
+// Import the bitcode modules' definitions for inlining into the program's module (--thinlto)
+void genlLtoImport(GenState *gen);
+// Finish link-time optimization, once all programs are compiled
+void genlLtoFinish(GenState *gen);
 
 // genlstmt.c
 LLVMBasicBlockRef genlInsertBlock(GenState *gen, char *name);
@@ -60,6 +117,8 @@ LLVMValueRef genlLoop(GenState *gen, LoopNode *wnode);
 
 // genlexpr.c
 LLVMValueRef genlExpr(GenState *gen, INode *termnode);
+// Do runtime bounds check (index < count) and panic if it fails
+void genlBoundsCheck(GenState *gen, LLVMValueRef index, LLVMValueRef count);
 
 // genlalloc.c
 // Generate code that creates an allocated ref by allocating and initializing
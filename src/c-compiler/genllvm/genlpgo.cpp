@@ -0,0 +1,40 @@
+/** Profile-guided optimization using profile data
+ * @file
+ *
+ * LLVM's C API cannot give the profile use pass its profile data file, other than
+ * through LLVM's command line options, which are parsed only once per process
+ * (so a batch of programs could not each use their own profile).
+ * This one pass is therefore set up through LLVM's C++ API.
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Transforms/Instrumentation/PGOInstrumentation.h>
+
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+
+using namespace llvm;
+
+// Weight the module's branches and functions by the counts in a profile data file
+extern "C" void genlPgoUseProfile(LLVMModuleRef mod, LLVMTargetMachineRef machine, const char *profile) {
+    PassBuilder builder(reinterpret_cast<TargetMachine *>(machine));
+    LoopAnalysisManager loopam;
+    FunctionAnalysisManager fnam;
+    CGSCCAnalysisManager cgsccam;
+    ModuleAnalysisManager modam;
+    builder.registerModuleAnalyses(modam);
+    builder.registerCGSCCAnalyses(cgsccam);
+    builder.registerFunctionAnalyses(fnam);
+    builder.registerLoopAnalyses(loopam);
+    builder.crossRegisterProxies(loopam, fnam, cgsccam, modam);
+
+    ModulePassManager passes;
+    passes.addPass(PGOInstrumentationUse(profile));
+    passes.run(*unwrap(mod), modam);
+}
@@ -28,8 +28,8 @@ void genlVtableImpl(GenState *gen, VtableImpl *impl, LLVMTypeRef vtableRef) {
     // Ensure the struct has been "built", as we need to point to its fields and methods
     LLVMTypeRef structRef = genlType(gen, impl->structdcl);
 
-    // Build structure containing vtable info
-    LLVMValueRef implRef = LLVMGetUndef(vtableRef);
+    // Build constant structure containing vtable info
+    LLVMValueRef *vals = (LLVMValueRef *)memAllocBlk(impl->methfld->used * sizeof(LLVMValueRef));
     INode **nodesp;
     uint32_t cnt;
     unsigned int pos = 0;
@@ -44,10 +44,11 @@ void genlVtableImpl(GenState *gen, VtableImpl *impl, LLVMTypeRef vtableRef) {
         else {
             // Pointer to method. Recast so parameter types match later on
             LLVMTypeRef newfntyp = LLVMStructGetTypeAtIndex(vtableRef, pos);
-            val = LLVMBuildBitCast(gen->builder, ((FnDclNode *)*nodesp)->llvmvar, newfntyp, "");
+            val = LLVMConstBitCast(((FnDclNode *)*nodesp)->llvmvar, newfntyp);
         }
-        implRef = LLVMBuildInsertValue(gen->builder, implRef, val, pos++, "vtable entry");
+        vals[pos++] = val;
     }
+    LLVMValueRef implRef = LLVMConstNamedStruct(vtableRef, vals, pos);
 
     // Create and initialize global variable to hold vtable info
     impl->llvmvtablep = LLVMAddGlobal(gen->module, vtableRef, impl->name);
@@ -95,9 +96,11 @@ void genlVtable(GenState *gen, Vtable *vtable) {
     if (fieldcnt > 0)
         LLVMStructSetBody(vtableRef, field_types, fieldcnt, 0);
 
-    // Build all the vtable globals that implement the vtable
+    // Build the vtable globals that implement the vtable, for structs the program
+    // coerces to a virtual reference (see reach.h)
     for (nodesFor(vtable->impl, cnt, nodesp)) {
-        genlVtableImpl(gen, (VtableImpl*)*nodesp, vtableRef);
+        if (((VtableImpl*)*nodesp)->reached)
+            genlVtableImpl(gen, (VtableImpl*)*nodesp, vtableRef);
     }
 
     // Build the virtual reference type for this vtable. It is a fat pointer:
@@ -112,6 +115,41 @@ void genlVtable(GenState *gen, Vtable *vtable) {
     vtable->llvmreftype = virtref;
 }
 
+// Reorder a struct's fields by decreasing alignment, to minimize padding.
+// Each field's index is renumbered to its new position, and field_types is rearranged to match.
+void genlStructReorder(GenState *gen, StructNode *strnode, LLVMTypeRef *field_types) {
+    uint32_t fieldcnt = strnode->fields.used;
+    FieldDclNode **fields = (FieldDclNode **)strnode->fields.nodes;
+    unsigned long long declsize = LLVMABISizeOfType(gen->datalayout,
+        LLVMStructTypeInContext(gen->context, field_types, fieldcnt, 0));
+
+    // Stable insertion sort of field positions, so equally aligned fields keep declared order
+    uint32_t *order = (uint32_t *)memAllocBlk(fieldcnt * sizeof(uint32_t));
+    for (uint32_t i = 0; i < fieldcnt; ++i) {
+        unsigned align = LLVMABIAlignmentOfType(gen->datalayout, field_types[i]);
+        uint32_t j = i;
+        while (j > 0 && LLVMABIAlignmentOfType(gen->datalayout, field_types[order[j - 1]]) < align) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    LLVMTypeRef *declared_types = (LLVMTypeRef *)memAllocBlk(fieldcnt * sizeof(LLVMTypeRef));
+    memcpy(declared_types, field_types, fieldcnt * sizeof(LLVMTypeRef));
+    for (uint32_t pos = 0; pos < fieldcnt; ++pos) {
+        fields[order[pos]]->index = pos;
+        field_types[pos] = declared_types[order[pos]];
+    }
+
+    if (gen->opt->print_stats || gen->opt->stats_json) {
+        unsigned long long size = LLVMABISizeOfType(gen->datalayout,
+            LLVMStructTypeInContext(gen->context, field_types, fieldcnt, 0));
+        if (size < declsize)
+            statsAddReorder(&strnode->namesym->namestr, declsize, size);
+    }
+}
+
 // Generate a LLVMTypeRef for a struct, based on its fields and alignment
 LLVMTypeRef genlStructType(GenState *gen, char *name, StructNode *strnode) {
     // Build typeref from struct
@@ -123,6 +161,9 @@ LLVMTypeRef genlStructType(GenState *gen, char *name, StructNode *strnode) {
     for (nodelistFor(&strnode->fields, cnt, nodesp)) {
         *field_type_ptr++ = genlType(gen, ((FieldDclNode *)*nodesp)->vtype);
     }
+    // Fields shared with a trait must keep their positions, as must an extern struct's (C layout)
+    if (fieldcnt > 1 && strnode->basetrait == NULL && !(strnode->flags & (TraitType | CLayout)))
+        genlStructReorder(gen, strnode, field_types);
     LLVMTypeRef structype = LLVMStructCreateNamed(gen->context, name);
     if (fieldcnt > 0)
         LLVMStructSetBody(structype, field_types, fieldcnt, 0);
@@ -189,6 +230,9 @@ LLVMTypeRef _genlType(GenState *gen, char *name, INode *typ) {
         }
     }
 
+    case VecTag:
+        return LLVMVectorType(genlType(gen, (INode*)((VecNode*)typ)->elemtype), ((VecNode*)typ)->lanes);
+
     case VoidTag:
         return LLVMVoidTypeInContext(gen->context);
 
@@ -309,6 +353,21 @@ LLVMTypeRef _genlType(GenState *gen, char *name, INode *typ) {
     case ArrayTag:
     {
         ArrayNode *anode = (ArrayNode*)typ;
+        // An soa array is a struct holding an array for each of the element struct's fields
+        if (anode->flags & SoaLayout) {
+            // (in the struct's field order, so its fields' indexes apply to both)
+            StructNode *strnode = (StructNode*)itypeGetTypeDcl(anode->elemtype);
+            genlType(gen, (INode*)strnode);
+            INode **nodesp;
+            uint32_t cnt;
+            uint32_t fieldcnt = strnode->fields.used;
+            LLVMTypeRef *field_types = (LLVMTypeRef *)memAllocBlk(fieldcnt * sizeof(LLVMTypeRef));
+            for (nodelistFor(&strnode->fields, cnt, nodesp)) {
+                FieldDclNode *field = (FieldDclNode *)*nodesp;
+                field_types[field->index] = LLVMArrayType(genlType(gen, field->vtype), anode->size);
+            }
+            return LLVMStructTypeInContext(gen->context, field_types, fieldcnt, 0);
+        }
         return LLVMArrayType(genlType(gen, anode->elemtype), anode->size);
     }
 
@@ -334,14 +393,15 @@ LLVMTypeRef genlType(GenState *gen, INode *typ) {
             INsTypeNode *tnode = (INsTypeNode*)dclnode;
             INode **nodesp;
             uint32_t cnt;
-            // Declare just method names first, enabling forward references
+            // Declare just method names first, enabling forward references.
+            // Methods the program cannot reach are not generated.
             for (nodelistFor(&tnode->nodelist, cnt, nodesp)) {
-                if ((*nodesp)->tag == FnDclTag)
+                if ((*nodesp)->tag == FnDclTag && ((*nodesp)->flags & FlagReached))
                     genlGloFnName(gen, (FnDclNode*)*nodesp);
             }
             // Now generate the code for each method
             for (nodelistFor(&tnode->nodelist, cnt, nodesp)) {
-                if ((*nodesp)->tag == FnDclTag)
+                if ((*nodesp)->tag == FnDclTag && ((*nodesp)->flags & FlagReached))
                     genlFn(gen, (FnDclNode*)*nodesp);
             }
         }
@@ -0,0 +1,850 @@
+/** Compile-time evaluation of constant expressions
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "ir.h"
+
+#include <string.h>
+#include <math.h>
+
+// Limits that stop a runaway evaluation (e.g., an endless loop or recursion)
+#define EvalStepMax  10000000
+#define EvalDepthMax 256
+
+// A local variable (or parameter) bound to its current value
+typedef struct EvalVar {
+    VarDclNode *dcl;
+    INode *val;
+} EvalVar;
+
+// How evaluation of a statement ended
+enum EvalCtl {
+    EvalNext,       // Go on to the next statement
+    EvalBreak,      // Break out of a loop, with ctlval as its value
+    EvalContinue,   // Start the next iteration of a loop
+    EvalReturn      // Return ctlval from the function
+};
+
+// Context used across the evaluation of an expression
+typedef struct EvalState {
+    EvalVar *vars;          // Stack of bound variables
+    uint32_t varcnt;
+    uint32_t varmax;
+    uint32_t framebase;     // First variable bound by the current function call
+    uint32_t depth;         // Depth of nested function calls
+    uint32_t steps;         // Loop iterations and calls performed so far
+    int ctl;                // How the last statement ended (EvalCtl)
+    INode *ctllife;         // Lifetime of the loop a break/continue targets (NULL for innermost)
+    INode *ctlval;          // Value of break or return
+    char *whynot;           // Why the expression cannot be evaluated
+    TypeCheckState *pstate; // nullable. Type check state, to check called functions on demand
+} EvalState;
+
+INode *evalExp(EvalState *ev, INode *node);
+INode **evalLval(EvalState *ev, INode *lval);
+
+// Note why evaluation failed, returning NULL
+INode *evalFail(EvalState *ev, char *whynot) {
+    if (ev->whynot == NULL)
+        ev->whynot = whynot;
+    return NULL;
+}
+
+// Return the number type, or NULL if not a number
+NbrNode *evalNbrType(INode *type) {
+    INode *typedcl = itypeGetTypeDcl(type);
+    if (typedcl->tag == IntNbrTag || typedcl->tag == UintNbrTag || typedcl->tag == FloatNbrTag)
+        return (NbrNode *)typedcl;
+    return NULL;
+}
+
+// Create an integer literal, wrapping the value to its type's size (and sign-extending a signed value)
+INode *evalUint(uint64_t val, INode *type) {
+    NbrNode *nbrtype = (NbrNode *)itypeGetTypeDcl(type);
+    if (nbrtype->bits < 64) {
+        uint64_t mask = ((uint64_t)1 << nbrtype->bits) - 1;
+        val &= mask;
+        if (nbrtype->tag == IntNbrTag && (val >> (nbrtype->bits - 1)) & 1)
+            val |= ~mask;
+    }
+    return (INode *)newULitNode(val, (INode *)nbrtype);
+}
+
+// Create a float literal, rounding the value to its type's precision
+INode *evalFloat(double val, INode *type) {
+    NbrNode *nbrtype = (NbrNode *)itypeGetTypeDcl(type);
+    if (nbrtype->bits == 32)
+        val = (double)(float)val;
+    return (INode *)newFLitNode(val, (INode *)nbrtype);
+}
+
+// Get a number literal's value as an integer or a float
+uint64_t evalGetUint(INode *lit) {
+    return lit->tag == FLitTag ? (uint64_t)((FLitNode *)lit)->floatlit : ((ULitNode *)lit)->uintlit;
+}
+double evalGetFloat(INode *lit) {
+    return lit->tag == FLitTag ? ((FLitNode *)lit)->floatlit : (double)((ULitNode *)lit)->uintlit;
+}
+
+// Create an empty struct or array value, to add element values to
+FnCallNode *evalNewLit(INode *type, uint32_t nvalues) {
+    FnCallNode *lit = newFnCallNode(type, nvalues);
+    lit->tag = TypeLitTag;
+    lit->vtype = type;
+    return lit;
+}
+
+// Copy a struct or array value, so that changing the copy does not change the original
+INode *evalCopy(INode *val) {
+    if (val->tag != TypeLitTag)
+        return val;
+    FnCallNode *lit = (FnCallNode *)val;
+    FnCallNode *copy = evalNewLit(lit->vtype, lit->args->used);
+    copyNodeLex(copy, lit);
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(lit->args, cnt, nodesp))
+        nodesAdd(&copy->args, evalCopy(*nodesp));
+    return (INode *)copy;
+}
+
+// Create the zero value of a type, for a variable declared without one
+INode *evalZero(EvalState *ev, INode *type) {
+    INode *typedcl = itypeGetTypeDcl(type);
+    switch (typedcl->tag) {
+    case IntNbrTag: case UintNbrTag:
+        return (INode *)newULitNode(0, typedcl);
+    case FloatNbrTag:
+        return (INode *)newFLitNode(0.0, typedcl);
+    case ArrayTag:
+    {
+        ArrayNode *arrtype = (ArrayNode *)typedcl;
+        FnCallNode *lit = evalNewLit(typedcl, arrtype->size);
+        for (uint32_t i = 0; i < arrtype->size; ++i) {
+            INode *elem = evalZero(ev, arrtype->elemtype);
+            if (elem == NULL)
+                return NULL;
+            nodesAdd(&lit->args, elem);
+        }
+        return (INode *)lit;
+    }
+    case StructTag:
+    {
+        StructNode *strnode = (StructNode *)typedcl;
+        if (strnode->flags & TraitType)
+            break;
+        FnCallNode *lit = evalNewLit(typedcl, strnode->fields.used);
+        INode **nodesp;
+        uint32_t cnt;
+        for (nodelistFor(&strnode->fields, cnt, nodesp)) {
+            INode *fld = evalZero(ev, ((FieldDclNode *)*nodesp)->vtype);
+            if (fld == NULL)
+                return NULL;
+            nodesAdd(&lit->args, fld);
+        }
+        return (INode *)lit;
+    }
+    }
+    return evalFail(ev, "it declares a variable whose type only has values at run time");
+}
+
+// Find a bound variable in the current function call
+EvalVar *evalFindVar(EvalState *ev, VarDclNode *dcl) {
+    for (uint32_t i = ev->varcnt; i > ev->framebase; --i) {
+        if (ev->vars[i - 1].dcl == dcl)
+            return &ev->vars[i - 1];
+    }
+    return NULL;
+}
+
+// Bind a variable to a value (rebinding it if already bound, e.g., on a loop's next iteration)
+void evalBindVar(EvalState *ev, VarDclNode *dcl, INode *val) {
+    EvalVar *var = evalFindVar(ev, dcl);
+    if (var == NULL) {
+        if (ev->varcnt == ev->varmax) {
+            EvalVar *vars = (EvalVar *)memAllocBlk(2 * ev->varmax * sizeof(EvalVar));
+            memcpy(vars, ev->vars, ev->varcnt * sizeof(EvalVar));
+            ev->vars = vars;
+            ev->varmax *= 2;
+        }
+        var = &ev->vars[ev->varcnt++];
+        var->dcl = dcl;
+    }
+    var->val = val;
+}
+
+// Get a variable's value. An immutable global's value is evaluated (once) as needed.
+INode *evalVarValue(EvalState *ev, VarDclNode *dcl) {
+    EvalVar *var = evalFindVar(ev, dcl);
+    if (var)
+        return var->val;
+    if (dcl->scope != 0 || dcl->value == NULL)
+        return evalFail(ev, "it uses a variable only known at run time");
+    if (!permIsSame(dcl->perm, (INode *)immPerm))
+        return evalFail(ev, "it uses a mutable global variable");
+    if (!litIsLiteral(dcl->value)) {
+        if (!(dcl->flags & FlagChecked))
+            return evalFail(ev, "it uses a global variable whose value is not yet known");
+        INode *val = evalExp(ev, dcl->value);
+        if (val == NULL)
+            return NULL;
+        dcl->value = evalCopy(val);
+    }
+    return dcl->value;
+}
+
+// Find the position of a field in its struct's declared field order (as used by type literals)
+uint32_t evalFieldPos(StructNode *strnode, INode *flddcl) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodelistFor(&strnode->fields, cnt, nodesp)) {
+        if (*nodesp == flddcl)
+            break;
+    }
+    return strnode->fields.used - cnt;
+}
+
+// Evaluate the index of an array element, ensuring it is within the array value
+int evalIndex(EvalState *ev, FnCallNode *arrval, INode *indexexp, uint32_t *index) {
+    INode *idx = evalExp(ev, indexexp);
+    if (idx == NULL)
+        return 0;
+    if (arrval->tag != TypeLitTag || itypeGetTypeDcl(arrval->vtype)->tag != ArrayTag) {
+        evalFail(ev, "it indexes an array only known at run time");
+        return 0;
+    }
+    if (evalGetUint(idx) >= arrval->args->used) {
+        evalFail(ev, "it indexes past the end of an array");
+        return 0;
+    }
+    *index = (uint32_t)evalGetUint(idx);
+    return 1;
+}
+
+// Convert a float to an integer type, saturating as llvm.fptosi.sat and fptoui.sat do:
+// NaN becomes 0, and a value out of the type's range becomes its nearest bound.
+// (A C cast of such a value would be undefined.)
+uint64_t evalFloatToInt(double fval, NbrNode *totype) {
+    if (isnan(fval))
+        return 0;
+    if (totype->tag == IntNbrTag) {
+        uint64_t min = (uint64_t)0 - ((uint64_t)1 << (totype->bits - 1));
+        if (fval >= ldexp(1.0, totype->bits - 1))
+            return ~min;
+        if (fval < -ldexp(1.0, totype->bits - 1))
+            return min;
+        return (uint64_t)(int64_t)fval;
+    }
+    if (fval >= ldexp(1.0, totype->bits))
+        return totype->bits == 64 ? UINT64_MAX : ((uint64_t)1 << totype->bits) - 1;
+    if (fval <= -1.0)
+        return 0;
+    return (uint64_t)fval;
+}
+
+// Convert a number value to another number type
+INode *evalConvert(EvalState *ev, INode *val, INode *to) {
+    NbrNode *totype = evalNbrType(to);
+    NbrNode *fromtype = evalNbrType(((IExpNode *)val)->vtype);
+    if (totype == NULL || fromtype == NULL)
+        return evalFail(ev, "it converts a value only known at run time");
+
+    // Converting a number to Bool means false if zero and true otherwise
+    if (totype == boolType)
+        return (INode *)newULitNode(fromtype->tag == FloatNbrTag ? evalGetFloat(val) != 0.0 : evalGetUint(val) != 0, (INode *)boolType);
+
+    if (totype->tag == FloatNbrTag) {
+        double fval;
+        if (fromtype->tag == FloatNbrTag)
+            fval = evalGetFloat(val);
+        else if (fromtype->tag == IntNbrTag)
+            fval = (double)(int64_t)evalGetUint(val);
+        else
+            fval = (double)evalGetUint(val);
+        return evalFloat(fval, (INode *)totype);
+    }
+    if (fromtype->tag == FloatNbrTag) {
+        double fval = evalGetFloat(val);
+        return evalUint(evalFloatToInt(fval, totype), (INode *)totype);
+    }
+    // A signed value is held sign-extended and an unsigned value zero-extended,
+    // so integer conversion only needs to wrap to the new type
+    return evalUint(evalGetUint(val), (INode *)totype);
+}
+
+// Reinterpret a number's bits as another number type of the same size
+INode *evalReinterpret(EvalState *ev, INode *val, INode *to) {
+    NbrNode *totype = evalNbrType(to);
+    NbrNode *fromtype = evalNbrType(((IExpNode *)val)->vtype);
+    if (totype == NULL || fromtype == NULL || totype->bits != fromtype->bits)
+        return evalFail(ev, "it reinterprets a value only known at run time");
+    if ((totype->tag == FloatNbrTag) == (fromtype->tag == FloatNbrTag))
+        return totype->tag == FloatNbrTag ? evalFloat(evalGetFloat(val), (INode *)totype) : evalUint(evalGetUint(val), (INode *)totype);
+    if (totype->bits == 32) {
+        float f;
+        uint32_t u;
+        if (totype->tag == FloatNbrTag) {
+            u = (uint32_t)evalGetUint(val);
+            memcpy(&f, &u, sizeof(f));
+            return evalFloat(f, (INode *)totype);
+        }
+        f = (float)evalGetFloat(val);
+        memcpy(&u, &f, sizeof(u));
+        return evalUint(u, (INode *)totype);
+    }
+    double d;
+    uint64_t u;
+    if (totype->tag == FloatNbrTag) {
+        u = evalGetUint(val);
+        memcpy(&d, &u, sizeof(d));
+        return evalFloat(d, (INode *)totype);
+    }
+    d = evalGetFloat(val);
+    memcpy(&u, &d, sizeof(u));
+    return evalUint(u, (INode *)totype);
+}
+
+// Add or subtract two integers, clamping the result to the number type's range
+uint64_t evalSaturate(int16_t intrinsic, NbrNode *nbrtype, uint64_t a, uint64_t b) {
+    unsigned bits = nbrtype->bits;
+    if (nbrtype->tag == IntNbrTag) {
+        // Sign-extended values of fewer than 64 bits cannot overflow an int64_t
+        int64_t max = bits >= 64 ? INT64_MAX : ((int64_t)1 << (bits - 1)) - 1;
+        int64_t min = -max - 1;
+        int64_t sa = (int64_t)a, sb = (int64_t)b;
+        if (intrinsic == AddSatIntrinsic) {
+            if (sb > 0 && sa > max - sb) return (uint64_t)max;
+            if (sb < 0 && sa < min - sb) return (uint64_t)min;
+            return (uint64_t)(sa + sb);
+        }
+        if (sb < 0 && sa > max + sb) return (uint64_t)max;
+        if (sb > 0 && sa < min + sb) return (uint64_t)min;
+        return (uint64_t)(sa - sb);
+    }
+    uint64_t max = bits >= 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    if (intrinsic == AddSatIntrinsic)
+        return a > max - b ? max : a + b;
+    return a < b ? 0 : a - b;
+}
+
+// Perform a bit manipulation intrinsic (e.g., popcount) on an integer's bits
+INode *evalBitIntrinsic(EvalState *ev, int16_t intrinsic, NbrNode *nbrtype, INode *restype, uint64_t a, uint64_t b) {
+    unsigned bits = nbrtype->bits;
+    uint64_t mask = bits >= 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    a &= mask;
+    uint64_t result = 0;
+    unsigned i;
+    switch (intrinsic) {
+    case PopcountIntrinsic:
+        for (; a; a &= a - 1)
+            ++result;
+        break;
+    case ClzIntrinsic:
+        for (i = bits; i > 0 && !(a & ((uint64_t)1 << (i - 1))); --i)
+            ++result;
+        break;
+    case CtzIntrinsic:
+        for (i = 0; i < bits && !(a & ((uint64_t)1 << i)); ++i)
+            ++result;
+        break;
+    case BswapIntrinsic:
+        for (i = 0; i < bits; i += 8)
+            result = (result << 8) | ((a >> i) & 0xff);
+        break;
+    case RotlIntrinsic:
+    case RotrIntrinsic:
+    {
+        unsigned shift = (unsigned)(b % bits);
+        if (intrinsic == RotrIntrinsic && shift)
+            shift = bits - shift;
+        result = shift ? ((a << shift) | (a >> (bits - shift))) & mask : a;
+        break;
+    }
+    default:
+        return evalFail(ev, "it uses a number operation not supported at compile time");
+    }
+    return evalUint(result, restype);
+}
+
+// Perform a number intrinsic (e.g., add) on one or two number values
+INode *evalNbrIntrinsic(EvalState *ev, int16_t intrinsic, NbrNode *nbrtype, INode *restype, INode *lval, INode *rval) {
+    if (nbrtype->tag == FloatNbrTag) {
+        double a = evalGetFloat(lval);
+        double b = rval ? evalGetFloat(rval) : 0.0;
+        switch (intrinsic) {
+        case NegIntrinsic: return evalFloat(-a, restype);
+        case AddIntrinsic: return evalFloat(a + b, restype);
+        case SubIntrinsic: return evalFloat(a - b, restype);
+        case MulIntrinsic: return evalFloat(a * b, restype);
+        case DivIntrinsic: return evalFloat(a / b, restype);
+        case RemIntrinsic: return evalFloat(fmod(a, b), restype);
+        case EqIntrinsic: return evalUint(a == b, restype);
+        case NeIntrinsic: return evalUint(a != b, restype);
+        case LtIntrinsic: return evalUint(a < b, restype);
+        case LeIntrinsic: return evalUint(a <= b, restype);
+        case GtIntrinsic: return evalUint(a > b, restype);
+        case GeIntrinsic: return evalUint(a >= b, restype);
+        case SqrtIntrinsic: return evalFloat(sqrt(a), restype);
+        case SinIntrinsic: return evalFloat(sin(a), restype);
+        case CosIntrinsic: return evalFloat(cos(a), restype);
+        case MinIntrinsic: return evalFloat(fmin(a, b), restype);
+        case MaxIntrinsic: return evalFloat(fmax(a, b), restype);
+        }
+        return evalFail(ev, "it uses a number operation not supported at compile time");
+    }
+
+    int issigned = nbrtype->tag == IntNbrTag;
+    uint64_t a = evalGetUint(lval);
+    uint64_t b = rval ? evalGetUint(rval) : 0;
+    switch (intrinsic) {
+    case NegIntrinsic: return evalUint(0 - a, restype);
+    case AddIntrinsic: return evalUint(a + b, restype);
+    case SubIntrinsic: return evalUint(a - b, restype);
+    case MulIntrinsic: return evalUint(a * b, restype);
+    case DivIntrinsic:
+    case RemIntrinsic:
+        if (b == 0)
+            return evalFail(ev, "it divides by zero");
+        if (issigned) {
+            if ((int64_t)b == -1)  // Avoid overflow (of the most negative number)
+                return evalUint(intrinsic == DivIntrinsic ? 0 - a : 0, restype);
+            return evalUint(intrinsic == DivIntrinsic ? (uint64_t)((int64_t)a / (int64_t)b) : (uint64_t)((int64_t)a % (int64_t)b), restype);
+        }
+        return evalUint(intrinsic == DivIntrinsic ? a / b : a % b, restype);
+    case EqIntrinsic: return evalUint(a == b, restype);
+    case NeIntrinsic: return evalUint(a != b, restype);
+    case LtIntrinsic: return evalUint(issigned ? (int64_t)a < (int64_t)b : a < b, restype);
+    case LeIntrinsic: return evalUint(issigned ? (int64_t)a <= (int64_t)b : a <= b, restype);
+    case GtIntrinsic: return evalUint(issigned ? (int64_t)a > (int64_t)b : a > b, restype);
+    case GeIntrinsic: return evalUint(issigned ? (int64_t)a >= (int64_t)b : a >= b, restype);
+    case NotIntrinsic: return evalUint(~a, restype);
+    case AndIntrinsic: return evalUint(a & b, restype);
+    case OrIntrinsic: return evalUint(a | b, restype);
+    case XorIntrinsic: return evalUint(a ^ b, restype);
+    case ShlIntrinsic:
+    case ShrIntrinsic:
+        if (b >= nbrtype->bits)
+            return evalFail(ev, "it shifts by at least the number's size");
+        if (intrinsic == ShlIntrinsic)
+            return evalUint(a << b, restype);
+        return evalUint(issigned ? (uint64_t)((int64_t)a >> b) : a >> b, restype);
+    case MinIntrinsic: return evalUint((issigned ? (int64_t)a < (int64_t)b : a < b) ? a : b, restype);
+    case MaxIntrinsic: return evalUint((issigned ? (int64_t)a > (int64_t)b : a > b) ? a : b, restype);
+    case AddSatIntrinsic:
+    case SubSatIntrinsic:
+        return evalUint(evalSaturate(intrinsic, nbrtype, a, b), restype);
+    }
+    return evalBitIntrinsic(ev, intrinsic, nbrtype, restype, a, b);
+}
+
+// Evaluate a call to an intrinsic function (e.g., +) on numbers
+INode *evalIntrinsic(EvalState *ev, FnCallNode *fncall, int16_t intrinsic) {
+    INode *selfnode = nodesGet(fncall->args, 0);
+    INode *selftype = iexpGetTypeDcl(selfnode);
+
+    // ++ and -- change a number through a borrowed reference to it
+    if (selftype->tag == RefTag) {
+        NbrNode *nbrtype = evalNbrType(((RefNode *)selftype)->pvtype);
+        if (selfnode->tag != BorrowTag || nbrtype == NULL)
+            return evalFail(ev, "it uses a reference");
+        INode **slot = evalLval(ev, ((BorrowNode *)selfnode)->exp);
+        if (slot == NULL)
+            return NULL;
+        INode *oldval = *slot;
+        int delta = (intrinsic == IncrIntrinsic || intrinsic == IncrPostIntrinsic) ? 1 : -1;
+        if (intrinsic != IncrIntrinsic && intrinsic != IncrPostIntrinsic && intrinsic != DecrIntrinsic && intrinsic != DecrPostIntrinsic)
+            return evalFail(ev, "it uses a reference");
+        INode *newval = nbrtype->tag == FloatNbrTag ?
+            evalFloat(evalGetFloat(oldval) + delta, (INode *)nbrtype) : evalUint(evalGetUint(oldval) + delta, (INode *)nbrtype);
+        *slot = newval;
+        return (intrinsic == IncrIntrinsic || intrinsic == DecrIntrinsic) ? newval : oldval;
+    }
+
+    NbrNode *nbrtype = evalNbrType(selftype);
+    if (nbrtype == NULL)
+        return evalFail(ev, "it operates on a value only known at run time");
+
+    // For operator assignment (e.g., +=), self is the lval to update
+    INode **slot = NULL;
+    INode *lval;
+    if (fncall->flags & FlagLvalOp) {
+        if ((slot = evalLval(ev, selfnode)) == NULL)
+            return NULL;
+        lval = *slot;
+    }
+    else if ((lval = evalExp(ev, selfnode)) == NULL)
+        return NULL;
+    INode *rval = NULL;
+    if (fncall->args->used > 1 && (rval = evalExp(ev, nodesGet(fncall->args, 1))) == NULL)
+        return NULL;
+
+    INode *result = evalNbrIntrinsic(ev, intrinsic, nbrtype, fncall->vtype, lval, rval);
+    if (slot && result)
+        *slot = result;
+    return result;
+}
+
+// Evaluate a function call
+INode *evalFnCall(EvalState *ev, FnCallNode *fncall) {
+    if (fncall->objfn->tag == DerefTag || (fncall->flags & FlagVDisp))
+        return evalFail(ev, "it calls a function through a reference");
+    FnDclNode *fndcl = (FnDclNode *)((NameUseNode *)fncall->objfn)->dclnode;
+    if (fndcl->tag != FnDclTag || fndcl->value == NULL)
+        return evalFail(ev, "it calls an extern function");
+    if (fndcl->value->tag == IntrinsicTag)
+        return evalIntrinsic(ev, fncall, ((IntrinsicNode *)fndcl->value)->intrinsicFn);
+    if (!(fndcl->flags & FlagChecked)) {
+        // A function called by a type's size (e.g.) may not be checked yet, so check it now
+        if (ev->pstate && !(fndcl->flags & (FlagChecking | FlagMethFld))) {
+            fnDclTypeCheck(ev->pstate, fndcl);
+            if (errors)
+                return evalFail(ev, "it calls a function with errors");
+        }
+        if (!(fndcl->flags & FlagChecked))
+            return evalFail(ev, "it calls a function whose body is not yet type checked");
+    }
+    if (ev->depth >= EvalDepthMax)
+        return evalFail(ev, "it nests function calls too deeply");
+    if (++ev->steps > EvalStepMax)
+        return evalFail(ev, "it takes too long to compute");
+
+    // Evaluate arguments in the caller, then bind them to the parameters in a new frame
+    INode **args = (INode **)memAllocBlk(fncall->args->used * sizeof(INode *));
+    INode **nodesp;
+    uint32_t cnt;
+    uint32_t argi = 0;
+    for (nodesFor(fncall->args, cnt, nodesp)) {
+        if ((args[argi++] = evalExp(ev, *nodesp)) == NULL)
+            return NULL;
+    }
+    uint32_t svframebase = ev->framebase;
+    uint32_t svvarcnt = ev->varcnt;
+    ev->framebase = ev->varcnt;
+    argi = 0;
+    for (nodesFor(((FnSigNode *)fndcl->vtype)->parms, cnt, nodesp))
+        evalBindVar(ev, (VarDclNode *)*nodesp, evalCopy(args[argi++]));
+
+    ++ev->depth;
+    INode *val = evalExp(ev, fndcl->value);
+    --ev->depth;
+    ev->framebase = svframebase;
+    ev->varcnt = svvarcnt;
+    if (val && ev->ctl == EvalReturn) {
+        ev->ctl = EvalNext;
+        val = ev->ctlval;
+    }
+    return val;
+}
+
+// Evaluate a struct, array or number type literal
+INode *evalTypeLit(EvalState *ev, FnCallNode *lit) {
+    INode *littype = itypeGetTypeDcl(lit->vtype);
+    if (evalNbrType(littype)) {
+        INode *val = evalExp(ev, nodesGet(lit->args, 0));
+        return val ? evalConvert(ev, val, littype) : NULL;
+    }
+    if (littype->tag != StructTag && littype->tag != ArrayTag)
+        return evalFail(ev, "it creates a value not supported at compile time");
+
+    FnCallNode *val = evalNewLit(littype, lit->args->used);
+    copyNodeLex(val, lit);
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(lit->args, cnt, nodesp)) {
+        INode *elem = evalExp(ev, *nodesp);
+        if (elem == NULL)
+            return NULL;
+        nodesAdd(&val->args, elem);
+    }
+    return (INode *)val;
+}
+
+// Evaluate the location of an lval, so its value may be changed in place
+INode **evalLval(EvalState *ev, INode *lval) {
+    switch (lval->tag) {
+    case VarNameUseTag:
+    {
+        EvalVar *var = evalFindVar(ev, (VarDclNode *)((NameUseNode *)lval)->dclnode);
+        if (var == NULL) {
+            evalFail(ev, "it changes a global variable");
+            return NULL;
+        }
+        return &var->val;
+    }
+    case ArrIndexTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)lval;
+        INode **arrp = evalLval(ev, fncall->objfn);
+        uint32_t index;
+        if (arrp == NULL || !evalIndex(ev, (FnCallNode *)*arrp, nodesGet(fncall->args, 0), &index))
+            return NULL;
+        return &nodesGet(((FnCallNode *)*arrp)->args, index);
+    }
+    case StrFieldTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)lval;
+        INode **strp = evalLval(ev, fncall->objfn);
+        if (strp == NULL)
+            return NULL;
+        if ((*strp)->tag != TypeLitTag) {
+            evalFail(ev, "it changes a field through a reference");
+            return NULL;
+        }
+        StructNode *strnode = (StructNode *)iexpGetTypeDcl(fncall->objfn);
+        return &nodesGet(((FnCallNode *)*strp)->args, evalFieldPos(strnode, ((NameUseNode *)fncall->methfld)->dclnode));
+    }
+    default:
+        evalFail(ev, "it changes a value through a reference");
+        return NULL;
+    }
+}
+
+// Evaluate an assignment
+INode *evalAssign(EvalState *ev, AssignNode *node) {
+    if (node->lval->tag == VTupleTag || node->rval->tag == VTupleTag)
+        return evalFail(ev, "it uses parallel assignment");
+    INode *val = evalExp(ev, node->rval);
+    if (val == NULL)
+        return NULL;
+    if (node->lval->tag == VarNameUseTag && ((NameUseNode *)node->lval)->namesym == anonName)
+        return val;
+    INode **slot = evalLval(ev, node->lval);
+    if (slot == NULL)
+        return NULL;
+    *slot = evalCopy(val);
+    return val;
+}
+
+// Evaluate a block's statements, returning the value of the last
+INode *evalBlock(EvalState *ev, BlockNode *blk) {
+    INode *val = voidType;
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(blk->stmts, cnt, nodesp)) {
+        switch ((*nodesp)->tag) {
+        case BreakTag:
+        case ContinueTag:
+        {
+            BreakNode *brk = (BreakNode *)*nodesp;
+            ev->ctlval = NULL;
+            if ((*nodesp)->tag == BreakTag && brk->exp && (ev->ctlval = evalExp(ev, brk->exp)) == NULL)
+                return NULL;
+            ev->ctl = (*nodesp)->tag == BreakTag ? EvalBreak : EvalContinue;
+            ev->ctllife = brk->life ? ((NameUseNode *)brk->life)->dclnode : NULL;
+            return voidType;
+        }
+        case ReturnTag:
+        {
+            ReturnNode *ret = (ReturnNode *)*nodesp;
+            ev->ctlval = voidType;
+            if (ret->exp != voidType && (ev->ctlval = evalExp(ev, ret->exp)) == NULL)
+                return NULL;
+            ev->ctl = EvalReturn;
+            return voidType;
+        }
+        case BlockRetTag:
+        {
+            ReturnNode *ret = (ReturnNode *)*nodesp;
+            if (ret->exp != voidType)
+                val = evalExp(ev, ret->exp);
+            break;
+        }
+        default:
+            val = evalExp(ev, *nodesp);
+        }
+        if (val == NULL)
+            return NULL;
+        if (ev->ctl != EvalNext)
+            return voidType;
+    }
+    return val;
+}
+
+// Evaluate an if, running the block of the first true condition
+INode *evalIf(EvalState *ev, IfNode *ifnode) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(ifnode->condblk, cnt, nodesp)) {
+        // An 'else' has no condition
+        if (*nodesp != voidType) {
+            INode *cond = evalExp(ev, *nodesp);
+            if (cond == NULL)
+                return NULL;
+            if (evalGetUint(cond) == 0) {
+                cnt--; nodesp++;
+                continue;
+            }
+        }
+        return evalBlock(ev, (BlockNode *)*(nodesp + 1));
+    }
+    return voidType;
+}
+
+// Evaluate a loop, until a break (or return) ends it
+INode *evalLoop(EvalState *ev, LoopNode *loop) {
+    while (1) {
+        if (++ev->steps > EvalStepMax)
+            return evalFail(ev, "it takes too long to compute");
+        if (evalBlock(ev, (BlockNode *)loop->blk) == NULL)
+            return NULL;
+        if (ev->ctl == EvalBreak || ev->ctl == EvalContinue) {
+            // A break/continue to an outer loop also ends this one
+            if (ev->ctllife && ev->ctllife != (INode *)loop->life)
+                return voidType;
+            int isbreak = ev->ctl == EvalBreak;
+            ev->ctl = EvalNext;
+            if (isbreak)
+                return ev->ctlval ? ev->ctlval : voidType;
+        }
+        else if (ev->ctl == EvalReturn)
+            return voidType;
+    }
+}
+
+// Evaluate an expression node, returning its value (voidType if none), or NULL if it cannot be evaluated
+INode *evalExp(EvalState *ev, INode *node) {
+    switch (node->tag) {
+    case ULitTag:
+    case FLitTag:
+    case StrLitTag:
+        return node;
+    case NamedValTag:
+        return evalExp(ev, ((NamedValNode *)node)->val);
+    case AliasTag:
+        return evalExp(ev, ((AliasNode *)node)->exp);
+    case TypeLitTag:
+        return evalTypeLit(ev, (FnCallNode *)node);
+    case VarNameUseTag:
+        return evalVarValue(ev, (VarDclNode *)((NameUseNode *)node)->dclnode);
+    case VarDclTag:
+    {
+        VarDclNode *var = (VarDclNode *)node;
+        INode *val = var->value ? evalExp(ev, var->value) : evalZero(ev, var->vtype);
+        if (val == NULL)
+            return NULL;
+        evalBindVar(ev, var, evalCopy(val));
+        return val;
+    }
+    case AssignTag:
+        return evalAssign(ev, (AssignNode *)node);
+    case FnCallTag:
+        return evalFnCall(ev, (FnCallNode *)node);
+    case ArrIndexTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)node;
+        if (node->flags & FlagBorrow)
+            return evalFail(ev, "it borrows a reference");
+        INode *arr = evalExp(ev, fncall->objfn);
+        uint32_t index;
+        if (arr == NULL || !evalIndex(ev, (FnCallNode *)arr, nodesGet(fncall->args, 0), &index))
+            return NULL;
+        return nodesGet(((FnCallNode *)arr)->args, index);
+    }
+    case StrFieldTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)node;
+        INode *objtype = iexpGetTypeDcl(fncall->objfn);
+        if ((node->flags & FlagBorrow) || objtype->tag != StructTag)
+            return evalFail(ev, "it accesses a field through a reference");
+        INode *str = evalExp(ev, fncall->objfn);
+        if (str == NULL)
+            return NULL;
+        return nodesGet(((FnCallNode *)str)->args, evalFieldPos((StructNode *)objtype, ((NameUseNode *)fncall->methfld)->dclnode));
+    }
+    case CastTag:
+    {
+        CastNode *cast = (CastNode *)node;
+        INode *val = evalExp(ev, cast->exp);
+        if (val == NULL)
+            return NULL;
+        return (node->flags & FlagAsIf) ? evalReinterpret(ev, val, cast->vtype) : evalConvert(ev, val, cast->vtype);
+    }
+    case NotLogicTag:
+    {
+        INode *val = evalExp(ev, ((LogicNode *)node)->lexp);
+        return val ? (INode *)newULitNode(evalGetUint(val) == 0, (INode *)boolType) : NULL;
+    }
+    case AndLogicTag:
+    case OrLogicTag:
+    {
+        // Only evaluate the right side if the left side does not decide the result
+        LogicNode *logic = (LogicNode *)node;
+        INode *val = evalExp(ev, logic->lexp);
+        if (val == NULL)
+            return NULL;
+        if ((evalGetUint(val) != 0) == (node->tag == OrLogicTag))
+            return val;
+        return evalExp(ev, logic->rexp);
+    }
+    case BlockTag:
+        return evalBlock(ev, (BlockNode *)node);
+    case IfTag:
+        return evalIf(ev, (IfNode *)node);
+    case LoopTag:
+        return evalLoop(ev, (LoopNode *)node);
+    default:
+        return evalFail(ev, "it uses an operation that is only possible at run time");
+    }
+}
+
+// Evaluate a type-checked expression at compile time, returning its value as literal nodes.
+// If it cannot be evaluated, return NULL and set *whynot to why not
+INode *evalConst(TypeCheckState *pstate, INode *exp, char **whynot) {
+    EvalState ev;
+    ev.pstate = pstate;
+    ev.varmax = 16;
+    ev.vars = (EvalVar *)memAllocBlk(ev.varmax * sizeof(EvalVar));
+    ev.varcnt = ev.framebase = 0;
+    ev.depth = ev.steps = 0;
+    ev.ctl = EvalNext;
+    ev.ctllife = ev.ctlval = NULL;
+    ev.whynot = NULL;
+
+    INode *val = evalExp(&ev, exp);
+    if (val == voidType)
+        val = evalFail(&ev, "it has no value");
+    *whynot = ev.whynot;
+    return val ? evalCopy(val) : NULL;
+}
+
+// Is the value a literal that can be generated as a constant as it is? A number type literal
+// (e.g., i32[3.5]) converts its value, so must be evaluated first, even inside another literal.
+int evalIsLit(INode *node) {
+    if (node->tag == NamedValTag)
+        node = ((NamedValNode *)node)->val;
+    if (node->tag != TypeLitTag)
+        return litIsLiteral(node);
+    if (evalNbrType(((IExpNode *)node)->vtype))
+        return 0;
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(((FnCallNode *)node)->args, cnt, nodesp)) {
+        if (!evalIsLit(*nodesp))
+            return 0;
+    }
+    return 1;
+}
+
+// Replace the non-literal initial value of every global variable with its compile-time value
+void evalGlobals(ModuleNode *mod) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(mod->nodes, cnt, nodesp)) {
+        if ((*nodesp)->tag == ModuleTag)
+            evalGlobals((ModuleNode *)*nodesp);
+        else if ((*nodesp)->tag == VarDclTag) {
+            VarDclNode *var = (VarDclNode *)*nodesp;
+            if (var->value == NULL || evalIsLit(var->value))
+                continue;
+            char *whynot;
+            INode *val = evalConst(NULL, var->value, &whynot);
+            if (val)
+                var->value = val;
+            else
+                errorMsgNode(var->value, ErrorNotLit, "Global variable's value must be computable at compile time, but %s", whynot);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+/** Compile-time evaluation of constant expressions
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef eval_h
+#define eval_h
+
+// Compile-time evaluation interprets type-checked IR, producing a value made only of
+// literal nodes: number literals, or type literals (of literals) for structs and arrays.
+//
+// It covers number arithmetic, comparisons and conversions, logic operators,
+// blocks, if, loops (with break and continue), local variables and assignment
+// (including to fields and array elements), struct and array literals,
+// field access, array indexing, immutable globals, and calls to functions
+// whose bodies use only these. So any such function can be used, like a 'const fn',
+// to compute a table. Anything else (references, pointers, allocation, extern functions,
+// mutable globals) only has a value at run time.
+
+// Evaluate a type-checked expression at compile time, returning its value as literal nodes.
+// If it cannot be evaluated, return NULL and set *whynot to why not (e.g., "it calls an extern function").
+// When evaluated during type check (pstate not NULL), called functions not yet checked are checked first.
+INode *evalConst(TypeCheckState *pstate, INode *exp, char **whynot);
+
+// Replace the non-literal initial value of every global variable with its compile-time value
+void evalGlobals(ModuleNode *mod);
+
+#endif
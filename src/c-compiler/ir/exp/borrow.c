@@ -128,6 +128,14 @@ void borrowTypeCheck(TypeCheckState *pstate, BorrowNode **nodep) {
     }
     INode *lvaltype = ((IExpNode*)lval)->vtype;
 
+    // An soa array stores each field apart, so neither it nor its elements are contiguous in memory
+    if (arrayIsSoa(itypeGetTypeDcl(lvaltype))
+        || (lval->tag == ArrIndexTag && arrayIsSoa(iexpGetTypeDcl(((FnCallNode*)lval)->objfn)))) {
+        errorMsgNode((INode *)node, ErrorNotLval, "Cannot borrow a reference into an soa array");
+        reftype->pvtype = (INode*)voidType;
+        return;
+    }
+
     // The reference's value type is currently unknown (NULL).
     // Let's infer this value type from the lval we are borrowing from
     INode *refvtype;
@@ -67,8 +67,14 @@ void fnCallNameRes(NameResState *pstate, FnCallNode **nodep) {
 
     // TBD: objfn is a macro
 
+    // Indexing a generic type given its arguments (e.g., Pair[i32][1, 2]) is a type literal.
+    // A generic type given its arguments (e.g., Pair[i32]) is instantiated during type check.
+    if (genericIsTypeUse(node->objfn) && (node->flags & FlagIndex)) {
+        node->tag = TypeLitTag;
+        node->vtype = node->objfn;
+    }
     // If objfn is a type, handle it as a type literal
-    if (isTypeNode(node->objfn)) {
+    else if (isTypeNode(node->objfn) && !genericIsName(node->objfn)) {
         if (!node->flags & FlagIndex) {
             errorMsgNode(node->objfn, ErrorBadTerm, "May not do a function call on a type");
             return;
@@ -156,6 +162,8 @@ void fnCallLowerMethod(FnCallNode *callnode) {
         && !(obj->tag==VarNameUseTag && ((VarDclNode*)((NameUseNode*)obj)->dclnode)->namesym == selfName)) {
         errorMsgNode((INode*)callnode, ErrorNotPublic, "May not access the private method/field `%s`.", &methsym->namestr);
     }
+    if (gIncrActive)
+        incrTypeUse(methtype);
     IExpNode *foundnode = (IExpNode*)iNsTypeFindFnField((INsTypeNode*)methtype, methsym);
     if (callnode->flags & FlagLvalOp) {
         if (foundnode)
@@ -341,7 +349,19 @@ void fnCallTypeCheck(TypeCheckState *pstate, FnCallNode **nodep) {
         for (nodesFor(node->args, cnt, argsp))
             inodeTypeCheck(pstate, argsp);
     }
-    inodeTypeCheck(pstate, &node->objfn);
+
+    // A generic is instantiated for its type arguments (e.g., max[i32] or Pair[i32]),
+    // or for those inferred from the call's arguments (e.g., max(a, b))
+    if (genericIsName(node->objfn)) {
+        if (node->flags & FlagIndex) {
+            genericTypeCheckUse(pstate, nodep);
+            return;
+        }
+        if (!genericInferCall(node))
+            return;
+    }
+    else
+        inodeTypeCheck(pstate, &node->objfn);
 
     // If objfn is a method/field, rewrite it as self.method
     if (node->objfn->tag == VarNameUseTag
@@ -104,12 +104,18 @@ void nameUseNameRes(NameResState *pstate, NameUseNode **namep) {
                 errorMsgNode((INode*)name, ErrorUnkName, "Module %s does not exist", &(*--namep)->namestr);
                 return;
             }
+            // The declaration depends on the whole outermost module it names
+            if (gIncrActive && cnt == name->qualNames->used - 1)
+                incrNameUse((INode*)mod);
         }
         name->dclnode = namespaceFind(&mod->namespace, name->namesym);
     }
-    else
+    else {
         // For non-qualified names (current module), should already be hooked in global name table
         name->dclnode = name->namesym->node;
+        if (gIncrActive && name->dclnode)
+            incrNameUse(name->dclnode);
+    }
 
     if (!name->dclnode) {
         errorMsgNode((INode*)name, ErrorUnkName, "The name %s does not refer to a declared name", &name->namesym->namestr);
@@ -129,8 +135,15 @@ void nameUseNameRes(NameResState *pstate, NameUseNode **namep) {
         return;
     }
 
+    // A generic's type parameter may stand for an unnamed type (e.g., &i32), which replaces the name
+    if (isTypeNode(name->dclnode) && !isNamedNode(name->dclnode)) {
+        *((INode**)namep) = name->dclnode;
+        return;
+    }
+
     // Distinguish whether a name is for a variable/function name vs. type
-    if (name->dclnode->tag == VarDclTag || name->dclnode->tag == FnDclTag)
+    if (name->dclnode->tag == VarDclTag || name->dclnode->tag == FnDclTag
+        || (name->dclnode->tag == GenericTag && ((GenericNode*)name->dclnode)->dcl->tag == FnDclTag))
         name->tag = VarNameUseTag;
     else
         name->tag = TypeNameUseTag;
@@ -139,6 +152,16 @@ void nameUseNameRes(NameResState *pstate, NameUseNode **namep) {
 // Handle type check for variable/function name use references
 void nameUseTypeCheck(TypeCheckState *pstate, NameUseNode **namep) {
     NameUseNode *name = *namep;
+    // A global variable used before its declaration is checked is checked now,
+    // so its type (and compile-time value) is known
+    VarDclNode *vardcl = (VarDclNode *)name->dclnode;
+    if (vardcl->tag == VarDclTag && vardcl->scope == 0 && !(vardcl->flags & FlagChecked))
+        inodeTypeCheck(pstate, &name->dclnode);
+    else if (vardcl->tag == GenericTag) {
+        errorMsgNode((INode*)name, ErrorNoType, "A generic function needs type arguments, e.g., %s[i32]", &name->namesym->namestr);
+        name->vtype = voidType;
+        return;
+    }
     name->vtype = ((IExpNode*)name->dclnode)->vtype;
 }
 
@@ -148,6 +171,11 @@ void nameUseTypeCheckType(TypeCheckState *pstate, NameUseNode **namep) {
     // to ensure it is correct and knows about its infectious constraints
     // Guards are in place to ensure this only will be done once, as early as possible.
     INode **dclnode = &(*namep)->dclnode;
+    if ((*dclnode)->tag == GenericTag) {
+        errorMsgNode((INode*)*namep, ErrorNoType, "A generic type needs type arguments, e.g., %s[i32]", &(*namep)->namesym->namestr);
+        *dclnode = voidType;
+        return;
+    }
     if (((*dclnode)->flags & TypeChecking) && !((*dclnode)->flags & TypeChecked)) {
         errorMsgNode((INode*)*namep, ErrorRecurse, "Recursive types are not supported for now.");
         return;
@@ -62,6 +62,25 @@ void typeLitNbrCheck(TypeCheckState *pstate, FnCallNode *nbrlit, INode *type) {
         errorMsgNode((INode*)first, ErrorBadArray, "May only create number literal from another number");
 }
 
+// Type check a vector literal: one value for every lane, or one value copied to all lanes
+void typeLitVecCheck(TypeCheckState *pstate, FnCallNode *veclit, VecNode *vectype) {
+    if (veclit->args->used != 1 && veclit->args->used != vectype->lanes) {
+        errorMsgNode((INode*)veclit, ErrorBadArray, "Vector literal requires one value or a value for all %d lanes", (int)vectype->lanes);
+        return;
+    }
+
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(veclit->args, cnt, nodesp)) {
+        INode *elemtype = (INode*)vectype->elemtype;
+        // A float literal takes on the lane's float type
+        if ((*nodesp)->tag == FLitTag && elemtype->tag == FloatNbrTag)
+            ((FLitNode*)*nodesp)->vtype = elemtype;
+        if (!iexpBiTypeInfer(&elemtype, nodesp))
+            errorMsgNode(*nodesp, ErrorBadArray, "Vector literal value's type does not match the lane type");
+    }
+}
+
 // Type check an array literal
 void typeLitArrayCheck(TypeCheckState *pstate, FnCallNode *arrlit) {
 
@@ -178,6 +197,9 @@ void typeLitStructCheck(TypeCheckState *pstate, FnCallNode *arrlit, StructNode *
 void typeLitTypeCheck(TypeCheckState *pstate, FnCallNode *arrlit) {
     INode **nodesp;
     uint32_t cnt;
+    // A generic type given its arguments (e.g., Pair[i32]) becomes its instance
+    if (genericIsTypeUse(arrlit->vtype))
+        inodeTypeCheck(pstate, &arrlit->vtype);
     for (nodesFor(arrlit->args, cnt, nodesp))
         inodeTypeCheck(pstate, nodesp);
 
@@ -190,6 +212,8 @@ void typeLitTypeCheck(TypeCheckState *pstate, FnCallNode *arrlit) {
         typeLitStructCheck(pstate, arrlit, (StructNode*)littype);
     else if (littype->tag == IntNbrTag || littype->tag == UintNbrTag || littype->tag == FloatNbrTag)
         typeLitNbrCheck(pstate, arrlit, littype);
+    else if (littype->tag == VecTag)
+        typeLitVecCheck(pstate, arrlit, (VecNode*)littype);
     else
         errorMsgNode((INode*)arrlit, ErrorBadArray, "Unknown type literal type for type checking");
 }
@@ -0,0 +1,322 @@
+/** Constant folding of a type-checked program
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "ir.h"
+
+void foldExp(INode **nodep);
+void foldBlock(BlockNode *blk);
+
+// Is node a number literal?
+int foldIsLit(INode *node) {
+    return node->tag == ULitTag || node->tag == FLitTag;
+}
+
+// Are all the nodes number literals?
+int foldAreLits(Nodes *nodes) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(nodes, cnt, nodesp)) {
+        if (!foldIsLit(*nodesp))
+            return 0;
+    }
+    return 1;
+}
+
+// Is this a call to an intrinsic function (e.g., + on numbers)?
+int foldIsIntrinsicCall(FnCallNode *fncall) {
+    if (fncall->objfn->tag != VarNameUseTag || (fncall->flags & (FlagLvalOp | FlagVDisp)))
+        return 0;
+    FnDclNode *fndcl = (FnDclNode *)((NameUseNode *)fncall->objfn)->dclnode;
+    return fndcl->tag == FnDclTag && fndcl->value && fndcl->value->tag == IntrinsicTag;
+}
+
+// Replace an expression with its value computed now, if it can be (e.g., not dividing by zero)
+// The literal is a new node, as the computed value may be shared (e.g., a global's own value).
+void foldToLit(INode **nodep) {
+    char *whynot;
+    INode *val = evalConst(NULL, *nodep, &whynot);
+    if (val == NULL || !foldIsLit(val))
+        return;
+    INode *lit;
+    if (val->tag == ULitTag)
+        lit = (INode *)newULitNode(((ULitNode *)val)->uintlit, ((ULitNode *)val)->vtype);
+    else
+        lit = (INode *)newFLitNode(((FLitNode *)val)->floatlit, ((FLitNode *)val)->vtype);
+    copyNodeLex(lit, *nodep);
+    *nodep = lit;
+}
+
+// Does a block end with a statement that leaves it (return, break or continue)?
+int foldBlockLeaves(BlockNode *blk) {
+    if (blk->stmts->used == 0)
+        return 0;
+    uint16_t tag = nodesLast(blk->stmts)->tag;
+    return tag == ReturnTag || tag == BreakTag || tag == ContinueTag;
+}
+
+// Prune branches of an if whose conditions are literals.
+// Return the (pruned) if, the block that replaces it, or NULL if no branch is ever taken.
+// An if used for its value is only replaced by a block that yields a value.
+INode *foldIf(IfNode *ifnode, int isstmt) {
+    Nodes *condblk = newNodes(ifnode->condblk->used);
+    uint32_t i;
+    for (i = 0; i < ifnode->condblk->used; i += 2) {
+        INode **condp = &nodesGet(ifnode->condblk, i);
+        BlockNode *blk = (BlockNode *)nodesGet(ifnode->condblk, i + 1);
+        foldBlock(blk);
+        if (*condp != voidType) {
+            foldExp(condp);
+            if ((*condp)->tag == ULitTag) {
+                // A false branch is never taken
+                if (((ULitNode *)*condp)->uintlit == 0)
+                    continue;
+                // A true branch is always taken (when reached), so it acts as the 'else'
+                nodesAdd(&condblk, voidType);
+                nodesAdd(&condblk, (INode *)blk);
+                break;
+            }
+        }
+        nodesAdd(&condblk, *condp);
+        nodesAdd(&condblk, (INode *)blk);
+        if (*condp == voidType)
+            break;
+    }
+    // Fold any branches after an always-taken branch, though they are dropped
+    for (i += 2; i < ifnode->condblk->used; i += 2)
+        foldBlock((BlockNode *)nodesGet(ifnode->condblk, i + 1));
+
+    if (condblk->used == 0)
+        return isstmt ? NULL : (INode *)ifnode;
+    if (nodesGet(condblk, 0) == voidType) {
+        BlockNode *blk = (BlockNode *)nodesGet(condblk, 1);
+        return isstmt || !foldBlockLeaves(blk) ? (INode *)blk : (INode *)ifnode;
+    }
+    ifnode->condblk = condblk;
+    if (nodesGet(condblk, condblk->used - 2) == voidType)
+        ifnode->flags |= IfHasElse;
+    return (INode *)ifnode;
+}
+
+// Fold a logic operator whose left side (or only operand) is a literal
+void foldLogic(INode **nodep) {
+    LogicNode *logic = (LogicNode *)*nodep;
+    foldExp(&logic->lexp);
+    if ((*nodep)->tag == NotLogicTag) {
+        if (logic->lexp->tag == ULitTag)
+            foldToLit(nodep);
+        return;
+    }
+    foldExp(&logic->rexp);
+    if (logic->lexp->tag != ULitTag)
+        return;
+    // 'true or x' and 'false and x' are decided by the left side alone
+    if ((((ULitNode *)logic->lexp)->uintlit != 0) == ((*nodep)->tag == OrLogicTag))
+        *nodep = logic->lexp;
+    else
+        *nodep = logic->rexp;
+}
+
+// Fold the operands of an lval (e.g., an index), but not the place it names,
+// which must stay a place even when it holds a constant (e.g., &Level)
+void foldLval(INode **nodep) {
+    INode **nodesp;
+    uint32_t cnt;
+    switch ((*nodep)->tag) {
+    case VarNameUseTag:
+        break;
+    case ArrIndexTag:
+    case StrFieldTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)*nodep;
+        foldLval(&fncall->objfn);
+        if (fncall->args) {
+            for (nodesFor(fncall->args, cnt, nodesp))
+                foldExp(nodesp);
+        }
+        break;
+    }
+    default:
+        foldExp(nodep);
+        break;
+    }
+}
+
+// Fold an expression's operands, then the expression itself if its operands are now literals
+void foldExp(INode **nodep) {
+    INode **nodesp;
+    uint32_t cnt;
+    switch ((*nodep)->tag) {
+    case VarNameUseTag:
+    {
+        // An immutable global number (e.g., a configuration constant) is its literal value
+        VarDclNode *vardcl = (VarDclNode *)((NameUseNode *)*nodep)->dclnode;
+        if (vardcl->tag == VarDclTag && vardcl->scope == 0 && vardcl->value && foldIsLit(vardcl->value)
+            && permIsSame(vardcl->perm, (INode *)immPerm))
+            foldToLit(nodep);
+        break;
+    }
+    case FnCallTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)*nodep;
+        if (fncall->objfn->tag == DerefTag)
+            foldExp(&fncall->objfn);
+        // An operator assignment (e.g., +=) changes its first argument in place
+        for (nodesFor(fncall->args, cnt, nodesp)) {
+            if (nodesp == &nodesGet(fncall->args, 0) && (fncall->flags & FlagLvalOp))
+                foldLval(nodesp);
+            else
+                foldExp(nodesp);
+        }
+        if (foldIsIntrinsicCall(fncall) && foldAreLits(fncall->args))
+            foldToLit(nodep);
+        break;
+    }
+    case ArrIndexTag:
+    case StrFieldTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)*nodep;
+        foldExp(&fncall->objfn);
+        if (fncall->args) {
+            for (nodesFor(fncall->args, cnt, nodesp))
+                foldExp(nodesp);
+        }
+        break;
+    }
+    case TypeLitTag:
+    {
+        FnCallNode *lit = (FnCallNode *)*nodep;
+        for (nodesFor(lit->args, cnt, nodesp))
+            foldExp(nodesp);
+        uint16_t typetag = itypeGetTypeDcl(lit->vtype)->tag;
+        if ((typetag == IntNbrTag || typetag == UintNbrTag || typetag == FloatNbrTag) && foldAreLits(lit->args))
+            foldToLit(nodep);
+        break;
+    }
+    case VTupleTag:
+        for (nodesFor(((VTupleNode *)*nodep)->values, cnt, nodesp))
+            foldExp(nodesp);
+        break;
+    case AssignTag:
+        foldLval(&((AssignNode *)*nodep)->lval);
+        foldExp(&((AssignNode *)*nodep)->rval);
+        break;
+    case VarDclTag:
+        if (((VarDclNode *)*nodep)->value)
+            foldExp(&((VarDclNode *)*nodep)->value);
+        break;
+    case CastTag:
+        foldExp(&((CastNode *)*nodep)->exp);
+        if (foldIsLit(((CastNode *)*nodep)->exp))
+            foldToLit(nodep);
+        break;
+    case IsTag:
+        foldExp(&((CastNode *)*nodep)->exp);
+        break;
+    case BorrowTag:
+        foldLval(&((BorrowNode *)*nodep)->exp);
+        break;
+    case AllocateTag:
+        foldExp(&((AllocateNode *)*nodep)->exp);
+        break;
+    case DerefTag:
+        foldExp(&((DerefNode *)*nodep)->exp);
+        break;
+    case AliasTag:
+        foldExp(&((AliasNode *)*nodep)->exp);
+        break;
+    case NamedValTag:
+        foldExp(&((NamedValNode *)*nodep)->val);
+        break;
+    case NotLogicTag:
+    case AndLogicTag:
+    case OrLogicTag:
+        foldLogic(nodep);
+        break;
+    case BlockTag:
+        foldBlock((BlockNode *)*nodep);
+        break;
+    case LoopTag:
+        foldBlock((BlockNode *)((LoopNode *)*nodep)->blk);
+        break;
+    case IfTag:
+    {
+        INode *node = foldIf((IfNode *)*nodep, 0);
+        *nodep = node;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Fold a block's statements, dropping untaken if statements
+// and any statements after a folded-in block that leaves
+void foldBlock(BlockNode *blk) {
+    Nodes *stmts = newNodes(blk->stmts->used > 0 ? blk->stmts->used : 1);
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(blk->stmts, cnt, nodesp)) {
+        switch ((*nodesp)->tag) {
+        case ReturnTag:
+        case BlockRetTag:
+            if (((ReturnNode *)*nodesp)->exp != voidType)
+                foldExp(&((ReturnNode *)*nodesp)->exp);
+            break;
+        case BreakTag:
+            if (((BreakNode *)*nodesp)->exp)
+                foldExp(&((BreakNode *)*nodesp)->exp);
+            break;
+        case ContinueTag:
+            break;
+        case IfTag:
+        {
+            INode *node = foldIf((IfNode *)*nodesp, 1);
+            if (node == NULL)
+                continue;
+            // A block that leaves takes the place of all remaining statements
+            if (node->tag == BlockTag && foldBlockLeaves((BlockNode *)node)) {
+                INode **blknodesp;
+                uint32_t blkcnt;
+                for (nodesFor(((BlockNode *)node)->stmts, blkcnt, blknodesp))
+                    nodesAdd(&stmts, *blknodesp);
+                blk->stmts = stmts;
+                return;
+            }
+            nodesAdd(&stmts, node);
+            continue;
+        }
+        default:
+            foldExp(nodesp);
+        }
+        nodesAdd(&stmts, *nodesp);
+    }
+    // Generation expects a branch's block to have statements
+    if (stmts->used > 0)
+        blk->stmts = stmts;
+}
+
+// Fold the body of every function declared in a list of nodes
+void foldFns(INode **nodesp, uint32_t cnt) {
+    for (; cnt; cnt--, nodesp++) {
+        INode *node = *nodesp;
+        if (node->tag == FnDclTag) {
+            FnDclNode *fndcl = (FnDclNode *)node;
+            if (fndcl->value && fndcl->value->tag == BlockTag)
+                foldBlock((BlockNode *)fndcl->value);
+        }
+        else if (node->tag == ModuleTag)
+            foldModule((ModuleNode *)node);
+        // Methods
+        else if (node->tag == StructTag)
+            foldFns(((StructNode *)node)->nodelist.nodes, ((StructNode *)node)->nodelist.used);
+    }
+}
+
+// Fold constant expressions in all functions of a module (and its submodules)
+void foldModule(ModuleNode *mod) {
+    foldFns(nodesNodes(mod->nodes), mod->nodes->used);
+}
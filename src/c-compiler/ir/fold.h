@@ -0,0 +1,24 @@
+/** Constant folding of a type-checked program
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef fold_h
+#define fold_h
+
+// After type check, folding simplifies function bodies before they are generated:
+// - An immutable global number (e.g., a configuration constant) becomes its literal value
+// - An intrinsic operation (e.g., +) or number conversion on literals becomes a literal
+// - A logic operator whose left side is a literal becomes its result (or its right side)
+// - An if drops branches whose condition is a false literal,
+//   and any after the first branch whose condition is a true literal.
+//   When only one branch is left, its block replaces the if.
+//   Statements after a replaced block that ends with return/break/continue are dropped.
+// Fewer instructions and basic blocks are then handed to LLVM.
+
+// Fold constant expressions in all functions of a module (and its submodules)
+void foldModule(ModuleNode *mod);
+
+#endif
@@ -106,6 +106,14 @@ int iexpBiTypeInfer(INode **totypep, INode **from) {
     INode *totypedcl = iexpGetTypeDcl(totype);
     INode *fromtypedcl = iexpGetTypeDcl(*from);
 
+    // Re-type an array literal to match the expected soa array type
+    if ((*from)->tag == TypeLitTag && arrayIsSoa(totypedcl) && fromtypedcl->tag == ArrayTag
+        && ((ArrayNode*)totypedcl)->size == ((ArrayNode*)fromtypedcl)->size
+        && itypeIsSame(((ArrayNode*)totypedcl)->elemtype, ((ArrayNode*)fromtypedcl)->elemtype)) {
+        ((IExpNode*)(*from))->vtype = totypedcl;
+        return 1;
+    }
+
     // Are types equivalent, or is 'to' a subtype of fromtypedcl?
     int match = itypeMatches(totypedcl, fromtypedcl);
     if (match <= 1)
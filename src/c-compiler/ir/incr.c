@@ -0,0 +1,480 @@
+/** Incremental re-analysis of a program after edits
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "ir.h"
+#include "../parser/lexer.h"
+#include "../shared/memory.h"
+#include "../shared/fileio.h"
+
+#include <string.h>
+#include <assert.h>
+#include <sys/stat.h>
+
+// How a declaration is handled when re-analyzed
+enum IncrState {
+    IncrKeep,       // Unchanged: reuse the prior analyzed node
+    IncrBody,       // Reuse prior node, but re-analyze the function's (new) body
+    IncrFull        // Fully analyze the freshly parsed node
+};
+
+// What we remember about a top-level declaration of the program module
+typedef struct IncrDcl {
+    INode *node;            // The declaration's node
+    Name *name;             // Its name (may be NULL)
+    uint64_t sighash;       // Hash of source text, excluding any function body
+    uint64_t bodyhash;      // Hash of function body's source text (0 if none)
+    Nodes *sigdeps;         // Declarations its signature (or definition) refers to
+    Nodes *bodydeps;        // Declarations its function body refers to
+    INode *priorbody;       // For IncrBody, the prior body (restored if analysis fails)
+    struct IncrDcl *prior;  // Matching declaration from the prior compile (or NULL)
+    struct IncrDcl *next;   // For a prior declaration, its match in the current compile
+    uint32_t index;         // Position in the program module's nodes
+    uint16_t state;         // IncrState
+} IncrDcl;
+
+// A generation of declarations, mapped from their node
+typedef struct IncrDcls {
+    ModuleNode *pgmmod;     // The program module they belong to
+    IncrDcl **dcls;         // Declarations in module order
+    uint32_t used;
+    uint32_t avail;
+    INode **mapkeys;        // Open-addressed map from node to declaration
+    IncrDcl **mapvals;
+    uint32_t mapavail;      // Always a power of 2
+} IncrDcls;
+
+// A loaded source file and its content's fingerprint
+typedef struct IncrSrc {
+    char *url;
+    uint64_t hash;
+    time_t mtime;
+    off_t size;
+} IncrSrc;
+
+int gIncrActive = 0;
+
+IncrDcls gIncrCur;              // Declarations for the compile underway
+IncrDcls gIncrPrior;            // Declarations from the last successful compile
+IncrDcl *gIncrResDcl = NULL;    // Declaration whose names are being resolved (or types checked)
+int gIncrInBody = 0;            // Are we analyzing a function body?
+Nodes *gIncrAllNodes = NULL;    // All module nodes, while module holds only those to analyze
+
+IncrSrc *gIncrSrcs = NULL;      // Source files loaded by the last compile
+uint32_t gIncrSrcsUsed = 0;
+uint32_t gIncrSrcsAvail = 0;
+uint64_t gIncrLoadMix = 0;      // Sum of content hashes of all loaded files
+
+// ************************ Declaration tables *******************************
+
+#define incrMapSlot(node, avail) ((size_t)(((uintptr_t)(node) >> 3) * 2654435761u) & ((avail) - 1))
+
+// Find the declaration for a node, or NULL if it is not a top-level declaration
+IncrDcl *incrFind(IncrDcls *gen, INode *node) {
+    if (gen->mapavail == 0)
+        return NULL;
+    size_t slot = incrMapSlot(node, gen->mapavail);
+    while (gen->mapkeys[slot]) {
+        if (gen->mapkeys[slot] == node)
+            return gen->mapvals[slot];
+        slot = (slot + 1) & (gen->mapavail - 1);
+    }
+    return NULL;
+}
+
+// Map a node to its declaration
+void incrMapSet(IncrDcls *gen, INode *node, IncrDcl *dcl) {
+    size_t slot = incrMapSlot(node, gen->mapavail);
+    while (gen->mapkeys[slot] && gen->mapkeys[slot] != node)
+        slot = (slot + 1) & (gen->mapavail - 1);
+    gen->mapkeys[slot] = node;
+    gen->mapvals[slot] = dcl;
+}
+
+// Rebuild the node map, when it needs to grow or declarations' nodes have changed
+void incrRemap(IncrDcls *gen) {
+    uint32_t i;
+    while (gen->mapavail < (gen->used << 1))
+        gen->mapavail = gen->mapavail == 0 ? 256 : gen->mapavail << 1;
+    gen->mapkeys = (INode **)memAllocBlk(gen->mapavail * sizeof(INode*));
+    gen->mapvals = (IncrDcl **)memAllocBlk(gen->mapavail * sizeof(IncrDcl*));
+    memset(gen->mapkeys, 0, gen->mapavail * sizeof(INode*));
+    for (i = 0; i < gen->used; i++)
+        incrMapSet(gen, gen->dcls[i]->node, gen->dcls[i]);
+}
+
+// Return the name a top-level declaration defines (or NULL)
+Name *incrDclName(INode *node) {
+    if (isTypeNode(node))
+        return ((INsTypeNode*)node)->namesym;
+    switch (node->tag) {
+    case FnDclTag: return ((FnDclNode*)node)->namesym;
+    case VarDclTag: return ((VarDclNode*)node)->namesym;
+    case ModuleTag: return ((ModuleNode*)node)->namesym;
+    case GenericTag: return ((GenericNode*)node)->namesym;
+    default: return NULL;
+    }
+}
+
+// Add a new declaration to a generation
+IncrDcl *incrAddDcl(IncrDcls *gen, INode *node) {
+    IncrDcl *dcl = (IncrDcl *)memAllocBlk(sizeof(IncrDcl));
+    memset(dcl, 0, sizeof(IncrDcl));
+    dcl->node = node;
+    dcl->name = incrDclName(node);
+    dcl->sigdeps = newNodes(4);
+    dcl->bodydeps = newNodes(4);
+    dcl->state = IncrFull;
+
+    if (gen->used >= gen->avail) {
+        IncrDcl **olddcls = gen->dcls;
+        gen->avail = gen->avail == 0 ? 256 : gen->avail << 1;
+        gen->dcls = (IncrDcl **)memAllocBlk(gen->avail * sizeof(IncrDcl*));
+        if (olddcls)
+            memcpy(gen->dcls, olddcls, gen->used * sizeof(IncrDcl*));
+    }
+    gen->dcls[gen->used++] = dcl;
+    if ((gen->used << 1) > gen->mapavail)
+        incrRemap(gen);
+    else
+        incrMapSet(gen, node, dcl);
+    return dcl;
+}
+
+// ************************ Source files and parse *******************************
+
+// Begin a new compile of the program (before it is parsed)
+void incrBegin() {
+    memset(&gIncrCur, 0, sizeof(IncrDcls));
+    gIncrSrcsUsed = 0;
+}
+
+// Remember a source file as loaded, along with its content hash
+void incrSrcLoaded(char *url, char *src) {
+    if (gIncrSrcsUsed >= gIncrSrcsAvail) {
+        IncrSrc *oldsrcs = gIncrSrcs;
+        gIncrSrcsAvail = gIncrSrcsAvail == 0 ? 32 : gIncrSrcsAvail << 1;
+        gIncrSrcs = (IncrSrc *)memAllocBlk(gIncrSrcsAvail * sizeof(IncrSrc));
+        if (oldsrcs)
+            memcpy(gIncrSrcs, oldsrcs, gIncrSrcsUsed * sizeof(IncrSrc));
+    }
+    IncrSrc *srcfile = &gIncrSrcs[gIncrSrcsUsed++];
+    struct stat st;
+    int found = stat(url, &st) == 0;
+    srcfile->url = url;
+    srcfile->hash = fileHash(src, strlen(src));
+    srcfile->mtime = found ? st.st_mtime : 0;
+    srcfile->size = found ? st.st_size : 0;
+    gIncrLoadMix += srcfile->hash;
+}
+
+// Return 1 if any previously loaded source file has changed on disk.
+// As this is polled, it only looks at the file's modification time and size.
+int incrSrcChanged() {
+    uint32_t i;
+    struct stat st;
+    for (i = 0; i < gIncrSrcsUsed; i++) {
+        IncrSrc *srcfile = &gIncrSrcs[i];
+        if (stat(srcfile->url, &st) != 0 || st.st_mtime != srcfile->mtime || st.st_size != srcfile->size)
+            return 1;
+    }
+    return 0;
+}
+
+// Begin recording the source text of a global statement
+void incrSpanBegin(IncrSpan *span, ModuleNode *mod) {
+    span->lexer = lex;
+    span->startp = lex->tokp;
+    span->loadmix = gIncrLoadMix;
+    span->firstnode = mod->nodes->used;
+}
+
+// Hash the source text of each top-level declaration added by the global statement
+void incrSpanEnd(IncrSpan *span, ModuleNode *mod) {
+    char *endp = lex == span->lexer ? lex->tokp : span->startp + strlen(span->startp);
+    uint32_t i;
+    for (i = span->firstnode; i < mod->nodes->used; i++) {
+        INode *node = nodesGet(mod->nodes, i);
+        // Nodes added by a nested statement (e.g., in an included file) were already recorded
+        if (incrFind(&gIncrCur, node))
+            continue;
+        IncrDcl *dcl = incrAddDcl(&gIncrCur, node);
+        INode *body = node->tag == FnDclTag ? ((FnDclNode*)node)->value : NULL;
+        if (body && body->lexer == span->lexer && body->srcp > span->startp && body->srcp <= endp) {
+            dcl->sighash = fileHash(span->startp, body->srcp - span->startp);
+            dcl->bodyhash = fileHash(body->srcp, endp - body->srcp);
+        }
+        else
+            dcl->sighash = fileHash(span->startp, endp - span->startp);
+        // Fold in the content of files the statement loaded (e.g., a module's source file)
+        dcl->sighash ^= gIncrLoadMix - span->loadmix;
+    }
+}
+
+// ************************ Name resolution *******************************
+
+// Note which top-level declaration is being name resolved
+void incrNameResDcl(INode *node) {
+    IncrDcl *dcl = incrFind(&gIncrCur, node);
+    if (dcl) {
+        gIncrResDcl = dcl;
+        gIncrInBody = 0;
+    }
+}
+
+// Note whether names are being resolved in a function body (vs. its signature),
+// returning whether they were before (a generic's instance is resolved within another's body)
+int incrNameResBody(int inbody) {
+    int wasinbody = gIncrInBody;
+    gIncrInBody = inbody;
+    return wasinbody;
+}
+
+// Record that the top-level declaration being resolved depends on another declaration
+void incrNameUse(INode *dclnode) {
+    if (gIncrResDcl == NULL || dclnode == gIncrResDcl->node || !incrFind(&gIncrCur, dclnode))
+        return;
+
+    Nodes **deps = gIncrInBody ? &gIncrResDcl->bodydeps : &gIncrResDcl->sigdeps;
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(*deps, cnt, nodesp)) {
+        if (*nodesp == dclnode)
+            return;
+    }
+    nodesAdd(deps, dclnode);
+}
+
+// ************************ Type check *******************************
+
+// Note which top-level declaration's signature or body is being type checked
+void incrTypeCheckDcl(INode *node, int inbody) {
+    IncrDcl *dcl = incrFind(&gIncrCur, node);
+    if (dcl) {
+        gIncrResDcl = dcl;
+        gIncrInBody = inbody;
+    }
+}
+
+// Record that the top-level declaration being type checked uses a type's methods or fields.
+// Name resolution cannot see this dependency when the type is not named (e.g., p.x where p is inferred).
+void incrTypeUse(INode *typedcl) {
+    incrNameUse(typedcl);
+}
+
+// ************************ Re-analysis *******************************
+
+// Is a prior declaration unusable now (deleted or to be fully re-analyzed)?
+int incrIsStale(INode *priornode) {
+    IncrDcl *priordcl = incrFind(&gIncrPrior, priornode);
+    return priordcl == NULL || priordcl->next == NULL || priordcl->next->state == IncrFull;
+}
+
+// Are any of these prior declarations unusable now?
+int incrDepsStale(Nodes *deps) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(deps, cnt, nodesp)) {
+        if (incrIsStale(*nodesp))
+            return 1;
+    }
+    return 0;
+}
+
+// Is a prior trait's vtable implemented by any struct that is now unusable?
+int incrVtableStale(INode *priornode) {
+    if (priornode->tag != StructTag || ((StructNode*)priornode)->vtable == NULL)
+        return 0;
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(((StructNode*)priornode)->vtable->impl, cnt, nodesp)) {
+        INode *strnode = ((VtableImpl*)*nodesp)->structdcl;
+        if (incrFind(&gIncrPrior, strnode) && incrIsStale(strnode))
+            return 1;
+    }
+    return 0;
+}
+
+// Decide how each declaration is to be re-analyzed, based on what changed
+void incrDecide() {
+    uint32_t i;
+    int reuse = gIncrPrior.used > 0;
+
+    // Match each declaration by name with its prior version
+    for (i = 0; i < gIncrPrior.used; i++)
+        gIncrPrior.dcls[i]->next = NULL;
+    for (i = 0; i < gIncrCur.used; i++) {
+        IncrDcl *dcl = gIncrCur.dcls[i];
+        INode *priornode = dcl->name && reuse ? namespaceFind(&gIncrPrior.pgmmod->namespace, dcl->name) : NULL;
+        IncrDcl *prior = priornode && priornode->tag == dcl->node->tag ? incrFind(&gIncrPrior, priornode) : NULL;
+        if (prior == NULL || prior->next || prior->sighash != dcl->sighash) {
+            // A new name that hides a global (library) name changes what other uses refer to
+            if (prior == NULL && dcl->name && dcl->name->node)
+                reuse = 0;
+            continue;
+        }
+        dcl->prior = prior;
+        prior->next = dcl;
+        dcl->state = prior->bodyhash == dcl->bodyhash ? IncrKeep : IncrBody;
+    }
+    if (!reuse) {
+        for (i = 0; i < gIncrCur.used; i++)
+            gIncrCur.dcls[i]->state = IncrFull;
+        return;
+    }
+
+    // Propagate changes to dependent declarations, until nothing more changes
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (i = 0; i < gIncrCur.used; i++) {
+            IncrDcl *dcl = gIncrCur.dcls[i];
+            if (dcl->state == IncrFull)
+                continue;
+            IncrDcl *prior = dcl->prior;
+            int isfn = prior->node->tag == FnDclTag;
+            if (incrDepsStale(prior->sigdeps) || (!isfn && incrDepsStale(prior->bodydeps))
+                || incrVtableStale(prior->node)) {
+                dcl->state = IncrFull;
+                changed = 1;
+            }
+            else if (dcl->state == IncrKeep && incrDepsStale(prior->bodydeps))
+                dcl->state = IncrBody;
+        }
+    }
+}
+
+// Match a freshly parsed program module to the prior compile's declarations,
+// reusing unaffected ones. Until incrCommit(), the module holds only the nodes needing full analysis.
+void incrPrepare(ModuleNode *pgmmod) {
+    gIncrCur.pgmmod = pgmmod;
+    gIncrResDcl = NULL;
+    incrDecide();
+
+    // Swap in reused nodes, and gather the nodes needing full analysis
+    Nodes *work = newNodes(pgmmod->nodes->used + 1);
+    INode **nodesp;
+    uint32_t cnt;
+    uint32_t index = 0;
+    for (nodesFor(pgmmod->nodes, cnt, nodesp)) {
+        IncrDcl *dcl = incrFind(&gIncrCur, *nodesp);
+        if (dcl == NULL)
+            dcl = incrAddDcl(&gIncrCur, *nodesp);
+        dcl->index = index++;
+        IncrDcl *prior = dcl->prior;
+        switch (dcl->state) {
+        case IncrKeep:
+            dcl->sigdeps = prior->sigdeps;
+            dcl->bodydeps = prior->bodydeps;
+            break;
+        case IncrBody:
+            // Keep the prior function (and its signature), but give it the new body
+            dcl->sigdeps = prior->sigdeps;
+            dcl->priorbody = ((FnDclNode*)prior->node)->value;
+            ((FnDclNode*)prior->node)->value = ((FnDclNode*)*nodesp)->value;
+            break;
+        default:
+            nodesAdd(&work, *nodesp);
+            continue;
+        }
+        dcl->node = *nodesp = prior->node;
+        if (dcl->name)
+            namespaceSet(&pgmmod->namespace, dcl->name, prior->node);
+    }
+    incrRemap(&gIncrCur);
+    gIncrAllNodes = pgmmod->nodes;
+    pgmmod->nodes = work;
+}
+
+// Re-resolve names of functions whose body alone needs re-analysis
+void incrNameRes(NameResState *pstate) {
+    ModuleNode *pgmmod = gIncrCur.pgmmod;
+    uint32_t i;
+    modHook(NULL, pgmmod);
+    pstate->mod = pgmmod;
+    for (i = 0; i < gIncrCur.used; i++) {
+        IncrDcl *dcl = gIncrCur.dcls[i];
+        if (dcl->state != IncrBody)
+            continue;
+        gIncrResDcl = dcl;
+        fnDclNameResBody(pstate, (FnDclNode*)dcl->node);
+    }
+    gIncrResDcl = NULL;
+    modHook(pgmmod, NULL);
+    pstate->mod = NULL;
+}
+
+// Re-check types of functions whose body alone needs re-analysis
+void incrTypeCheck(TypeCheckState *pstate) {
+    uint32_t i;
+    for (i = 0; i < gIncrCur.used; i++) {
+        IncrDcl *dcl = gIncrCur.dcls[i];
+        if (dcl->state != IncrBody)
+            continue;
+        gIncrResDcl = dcl;
+        gIncrInBody = 1;
+        fnDclTypeCheckBody(pstate, (FnDclNode*)dcl->node);
+    }
+    gIncrResDcl = NULL;
+}
+
+// Finish analysis, restoring all the module's nodes. On success, remember declarations
+// for the next compile. On failure, restore the prior compile's declarations.
+void incrCommit(int success) {
+    ModuleNode *pgmmod = gIncrCur.pgmmod;
+    uint32_t i;
+    if (pgmmod && gIncrAllNodes) {
+        // Put analyzed nodes back in place (analysis may have replaced some)
+        uint32_t index = 0;
+        for (i = 0; i < gIncrCur.used; i++) {
+            IncrDcl *dcl = gIncrCur.dcls[i];
+            if (dcl->state == IncrFull)
+                dcl->node = nodesGet(gIncrAllNodes, dcl->index) = nodesGet(pgmmod->nodes, index++);
+        }
+        pgmmod->nodes = gIncrAllNodes;
+        gIncrAllNodes = NULL;
+
+        if (success) {
+            incrRemap(&gIncrCur);
+            gIncrPrior = gIncrCur;
+        }
+        else {
+            for (i = 0; i < gIncrCur.used; i++) {
+                IncrDcl *dcl = gIncrCur.dcls[i];
+                if (dcl->state == IncrBody)
+                    ((FnDclNode*)dcl->node)->value = dcl->priorbody;
+            }
+        }
+    }
+    memset(&gIncrCur, 0, sizeof(IncrDcls));
+    gIncrResDcl = NULL;
+}
+
+// Clear what generation memoized on a type node for the prior LLVM module
+void incrResetType(INode *node) {
+    ((INsTypeNode*)node)->llvmtype = NULL;
+    if (node->tag != StructTag || ((StructNode*)node)->vtable == NULL)
+        return;
+    Vtable *vtable = ((StructNode*)node)->vtable;
+    vtable->llvmvtable = NULL;
+    vtable->llvmreftype = NULL;
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(vtable->impl, cnt, nodesp))
+        ((VtableImpl*)*nodesp)->llvmvtablep = NULL;
+}
+
+// Clear any memoized generation state on reused nodes, before regenerating the module
+void incrResetGen(ModuleNode *mod) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(mod->nodes, cnt, nodesp)) {
+        if ((*nodesp)->tag == ModuleTag)
+            incrResetGen((ModuleNode*)*nodesp);
+        else if (isTypeNode(*nodesp))
+            incrResetType(*nodesp);
+    }
+}
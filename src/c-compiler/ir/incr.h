@@ -0,0 +1,74 @@
+/** Incremental re-analysis of a program after edits
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef incr_h
+#define incr_h
+
+#include <stdint.h>
+
+// Incremental re-analysis serves long-lived sessions (e.g., --watch), which
+// recompile the same program again and again after small edits.
+//
+// Every top-level declaration of the program module is remembered across compiles
+// with a hash of its source text (the signature and a function's body hashed separately)
+// and the other top-level declarations it refers to, as recorded during name resolution
+// and type check (which finds the types whose methods and fields it uses).
+// After a re-parse, each declaration is matched by name with its prior version:
+// - Unchanged declarations keep their already analyzed node
+// - A function whose body alone changed keeps its node (and signature), and only
+//   its new body is re-resolved and re-checked
+// - All others are fully re-analyzed. So too are any whose signatures depend on them
+//   (transitively). Functions whose bodies depend on them only re-check their bodies.
+// Reused nodes keep the source positions (line numbers) from when they were first parsed.
+
+// Is incremental re-analysis turned on?
+int gIncrActive;
+
+// Begin a new compile of the program (before it is parsed)
+void incrBegin();
+
+// Remember a source file as loaded, along with its content hash
+void incrSrcLoaded(char *url, char *src);
+// Return 1 if any previously loaded source file has changed on disk
+int incrSrcChanged();
+
+// Record the source text (span) of each top-level declaration parsed by a global statement
+typedef struct IncrSpan {
+    Lexer *lexer;           // Lexer the statement began in
+    char *startp;           // Start of the statement's source text
+    uint64_t loadmix;       // Mix of hashes for files loaded so far
+    uint32_t firstnode;     // Index of first module node added by the statement
+} IncrSpan;
+void incrSpanBegin(IncrSpan *span, ModuleNode *mod);
+void incrSpanEnd(IncrSpan *span, ModuleNode *mod);
+
+// Note which top-level declaration's signature or body is being name resolved
+void incrNameResDcl(INode *node);
+// Return whether names were being resolved in a function body before
+int incrNameResBody(int inbody);
+// Record that the top-level declaration being resolved depends on another declaration
+void incrNameUse(INode *dclnode);
+
+// Note which top-level declaration's signature or body is being type checked
+void incrTypeCheckDcl(INode *node, int inbody);
+// Record that the top-level declaration being type checked uses a type's methods or fields
+void incrTypeUse(INode *typedcl);
+
+// Match a freshly parsed program module to the prior compile's declarations,
+// reusing unaffected ones. Until incrCommit(), the module holds only the nodes needing full analysis.
+void incrPrepare(ModuleNode *pgmmod);
+// Re-resolve names of functions whose body alone needs re-analysis
+void incrNameRes(NameResState *pstate);
+// Re-check types of functions whose body alone needs re-analysis
+void incrTypeCheck(TypeCheckState *pstate);
+// Finish analysis, restoring all the module's nodes. On success, remember declarations
+// for the next compile. On failure, restore the prior compile's declarations.
+void incrCommit(int success);
+// Clear any memoized generation state on reused nodes, before regenerating the module
+void incrResetGen(ModuleNode *pgmmod);
+
+#endif
@@ -78,6 +78,8 @@ void inodePrintNode(INode *node) {
         varDclPrint((VarDclNode *)node); break;
     case FieldDclTag:
         fieldDclPrint((FieldDclNode *)node); break;
+    case GenericTag:
+        genericPrint((GenericNode *)node); break;
     case BlockTag:
         blockPrint((BlockNode *)node); break;
     case IfTag:
@@ -136,6 +138,8 @@ void inodePrintNode(INode *node) {
         arrayPrint((ArrayNode *)node); break;
     case IntNbrTag: case UintNbrTag: case FloatNbrTag:
         nbrTypePrint((NbrNode *)node); break;
+    case VecTag:
+        vecTypePrint((VecNode *)node); break;
     case PermTag:
         permPrint((PermNode *)node); break;
     case LifetimeTag:
@@ -190,6 +194,8 @@ void inodeNameRes(NameResState *pstate, INode **node) {
         varDclNameRes(pstate, (VarDclNode *)*node); break;
     case FieldDclTag:
         fieldDclNameRes(pstate, (FieldDclNode *)*node); break;
+    case GenericTag:
+        break;  // Only its instances are resolved
     case NameUseTag:
     case VarNameUseTag:
     case TypeNameUseTag:
@@ -254,7 +260,7 @@ void inodeNameRes(NameResState *pstate, INode **node) {
     case ULitTag:
     case FLitTag:
     case StrLitTag:
-    case IntNbrTag: case UintNbrTag: case FloatNbrTag:
+    case IntNbrTag: case UintNbrTag: case FloatNbrTag: case VecTag:
     case PermTag:
     case VoidTag:
     case NullTag:
@@ -293,6 +299,8 @@ void inodeTypeCheck(TypeCheckState *pstate, INode **node) {
         varDclTypeCheck(pstate, (VarDclNode *)*node); break;
     case FieldDclTag:
         fieldDclTypeCheck(pstate, (FieldDclNode *)*node); break;
+    case GenericTag:
+        break;  // Only its instances are checked
     case VarNameUseTag:
         nameUseTypeCheck(pstate, (NameUseNode **)node); break;
     case TypeLitTag:
@@ -363,7 +371,7 @@ void inodeTypeCheck(TypeCheckState *pstate, INode **node) {
 
     case MbrNameUseTag:
     case StrLitTag:
-    case IntNbrTag: case UintNbrTag: case FloatNbrTag:
+    case IntNbrTag: case UintNbrTag: case FloatNbrTag: case VecTag:
     case VoidTag:
     case NullTag:
         break;
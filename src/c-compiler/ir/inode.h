@@ -73,6 +73,7 @@ enum NodeTags {
     FnDclTag,       // Function/method declaration
     VarDclTag,      // Variable declaration (global, local, parm)
     FieldDclTag,    // Field declaration in a struct, etc.
+    GenericTag,     // Generic function or struct declaration (with type parameters)
 
     // Expression nodes (having value type - or sometimes nullType)
     VarNameUseTag = ExpGroup,  // Variable or Function name use node  
@@ -105,7 +106,7 @@ enum NodeTags {
     // Unnamed type node
     TypeNameUseTag = TypeGroup, // Type name use node
     FnSigTag,       // Also method, closure, behavior, co-routine, thread, ...
-    ArrayTag,       // Also dynamic arrays? SOA?
+    ArrayTag,       // Also dynamic arrays? (SoaLayout flag for struct-of-arrays)
     RefTag,         // Reference
     ArrayRefTag,    // Array reference (slice ref)
     VirtRefTag,     // Virtual reference
@@ -122,6 +123,7 @@ enum NodeTags {
     LifetimeTag,
     PermTag,
     AllocTag,
+    VecTag,         // SIMD vector of numbers
 };
 
 // *****************
@@ -133,6 +135,9 @@ enum NodeTags {
 #define FlagExtern    0x0002        // FnDcl, VarDcl: C ABI extern (no value, no mangle)
 #define FlagSystem    0x0004        // FnDcl: imported system call (+stdcall on Winx86)
 #define FlagSetMethod 0x0008        // FnDcl: "set" method
+#define FlagChecked   0x0020        // FnDcl, VarDcl: value is type checked (so may be evaluated at compile time)
+#define FlagChecking  0x0040        // FnDcl, VarDcl: value is in process of being type checked
+#define FlagReached   0x0080        // FnDcl, VarDcl: reachable by the program, so it is generated
 
 #define IsTagField    0x0010        // FieldNode: This field is the trait's discriminant tag
 
@@ -140,11 +145,15 @@ enum NodeTags {
 #define FlagLvalOp    0x0002        // FnCall: method is an operator assignment (e.g., +=)
 #define FlagBorrow    0x0004        // FnCall: part of a borrow chain
 #define FlagVDisp     0x0008        // FnCall: a virtual dispatch function call
+#define FlagInBounds  0x0010        // FnCall: index is known to be in bounds (no runtime check)
 
 #define FlagSuffix    0x0001        // Borrow: part of a borrow chain
 
 #define IfHasElse     0x0001        // IfNode: This node has an 'else' clause
 
+#define FlagLikely    0x0001        // Block: an if branch expected to be taken (@likely)
+#define FlagUnlikely  0x0002        // Block: an if branch expected not to be taken (@unlikely)
+
 // Flags used across all types
 #define MoveType           0x0001  // Type's values impose move semantics (vs. copy)
 #define ThreadBound        0x0002  // Type's value copies must stay in the same thread (vs. sendable)
@@ -153,6 +162,8 @@ enum NodeTags {
 #define TraitType          0x0008  // Is a trait (vs. struct)
 #define SameSize           0x0010  // An enumtrait, where all implementations are padded to same size
 #define HasTagField        0x0020  // A trait/struct has an enumerated field identifying the variant type
+#define SoaLayout          0x0040  // An array of structs stored as one array per field
+#define CLayout            0x0080  // An extern struct, whose fields keep their declared order (C ABI)
 
 #define TypeChecked        0x8000  // Type has been type-checked
 #define TypeChecking       0x4000  // Type is in process of being type-checked
@@ -161,6 +172,7 @@ enum NodeTags {
 #define newNode(node, nodestruct, nodetype) {\
     node = (nodestruct*) memAllocBlk(sizeof(nodestruct)); \
     node->tag = nodetype; \
+    gStats.nodes[statsNodeSlot(nodetype)]++; \
     node->flags = 0; \
     node->lexer = lex; \
     node->srcp = lex->tokp; \
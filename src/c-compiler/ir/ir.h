@@ -32,6 +32,7 @@
 #include "nodes.h"
 #include "nodelist.h"
 #include "namespace.h"
+#include "stats.h"
 typedef struct Name Name;        // ../nametbl.h
 typedef struct Lexer Lexer;        // ../../parser/lexer.h
 typedef struct NameResState NameResState;
@@ -57,6 +58,7 @@ typedef struct TypeCheckState TypeCheckState;
 #include "types/lifetime.h"
 #include "types/fnsig.h"
 #include "types/number.h"
+#include "types/vector.h"
 #include "types/reference.h"
 #include "types/arrayref.h"
 #include "types/pointer.h"
@@ -92,6 +94,7 @@ typedef struct AllocNode {
 #include "exp/logic.h"
 #include "exp/sizeof.h"
 #include "exp/vtuple.h"
+#include "stmt/generic.h"
 
 #include "../std/stdlib.h"
 
@@ -113,4 +116,9 @@ typedef struct TypeCheckState {
     uint32_t loopcnt;         // How many currently in the loop stack
 } TypeCheckState;
 
+#include "incr.h"
+#include "eval.h"
+#include "fold.h"
+#include "reach.h"
+
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "ir.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 
@@ -145,8 +146,8 @@ char *itypeMangle(char *bufp, INode *vtype) {
     case VirtRefTag:
     {
         RefNode *reftype = (RefNode *)vtype;
-        *bufp++ = vtype->tag==VirtRefTag? '<' : ArrayRefTag? '+' : '&';
-        if (permIsSame(reftype->perm, (INode*)constPerm)) {
+        *bufp++ = vtype->tag==VirtRefTag? '<' : vtype->tag==ArrayRefTag? '+' : '&';
+        if (!permIsSame(reftype->perm, (INode*)constPerm)) {
             bufp = itypeMangle(bufp, reftype->perm);
             *bufp++ = ' ';
         }
@@ -160,7 +161,40 @@ char *itypeMangle(char *bufp, INode *vtype) {
         bufp = itypeMangle(bufp, pvtype->pvtype);
         break;
     }
+    case ArrayTag:
+    {
+        ArrayNode *atype = (ArrayNode *)vtype;
+        bufp += sprintf(bufp, "[%u%s]", atype->size, (atype->flags & SoaLayout) ? " soa" : "");
+        bufp = itypeMangle(bufp, atype->elemtype);
+        break;
+    }
+    case FnSigTag:
+    {
+        FnSigNode *fnsig = (FnSigNode *)vtype;
+        INode **nodesp;
+        uint32_t cnt;
+        strcpy(bufp, "fn(");
+        bufp += 3;
+        for (nodesFor(fnsig->parms, cnt, nodesp)) {
+            bufp = itypeMangle(bufp, ((IExpNode *)*nodesp)->vtype);
+            if (cnt > 1)
+                *bufp++ = ',';
+        }
+        *bufp++ = ')';
+        *bufp = '\0';
+        if (fnsig->rettype != voidType)
+            bufp = itypeMangle(bufp, fnsig->rettype);
+        break;
+    }
+    case VoidTag:
+        strcpy(bufp, "void");
+        break;
     default:
+        // A type's declaration (e.g., a generic's canonical type argument)
+        if (isNamedNode(vtype)) {
+            strcpy(bufp, &((INsTypeNode*)vtype)->namesym->namestr);
+            break;
+        }
         assert(0 && "unknown type for parameter type mangling");
     }
     return bufp + strlen(bufp);
@@ -44,6 +44,7 @@ void namespaceGrow(Namespace *namespace) {
     else {
         oldTblAvail = namespace->avail;
         namespace->avail <<= 1;
+        gStats.nsgrown++;
     }
 
     // Allocate and initialize new name table
@@ -139,6 +139,12 @@ size_t nametblUnused() {
     return (gNameTblAvail-gNameTblUsed)*sizeof(Name*);
 }
 
+// Return how many names are interned, and (in avail) how many slots the table has for them
+size_t nametblUsed(size_t *avail) {
+    *avail = gNameTblAvail;
+    return gNameTblUsed;
+}
+
 // Initialize name table
 void nametblInit() {
     nametblGrow();
@@ -207,6 +213,8 @@ void nametblHookPush() {
     }
 
     HookTable *table = &gHookTables[gHookTablePos];
+    if ((uint32_t)gHookTablePos >= gStats.hookdepth)
+        gStats.hookdepth = gHookTablePos + 1;
 
     // Allocate a new HookTable, if we don't have one allocated yet
     if (table->alloc == 0) {
@@ -34,6 +34,9 @@ Name *nametblFind(char *strp, size_t strl);
 // Return how many bytes have been allocated for global name table but not yet used
 size_t nametblUnused();
 
+// Return how many names are interned, and (in avail) how many slots the table has for them
+size_t nametblUsed(size_t *avail);
+
 // The global name hook functions help with the name resolution pass.
 // Whenever we enter a namespace context, the context's names are temporarily
 // added to the global name table. This way the lookup of a NameUse node
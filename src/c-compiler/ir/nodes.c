@@ -32,6 +32,7 @@ void nodesAdd(Nodes **nodesp, INode *node) {
         INode **op, **np;
         oldnodes = nodes;
         nodes = newNodes(oldnodes->avail << 1);
+        gStats.nodesgrown++;
         op = (INode **)(oldnodes+1);
         np = (INode **)(nodes+1);
         memcpy(np, op, (nodes->used = oldnodes->used) * sizeof(INode*));
@@ -51,6 +52,7 @@ void nodesInsert(Nodes **nodesp, INode *node, size_t index) {
         Nodes *oldnodes;
         oldnodes = nodes;
         nodes = newNodes(oldnodes->avail << 1);
+        gStats.nodesgrown++;
         op = (INode **)(oldnodes + 1);
         np = (INode **)(nodes + 1);
         memcpy(np, op, (nodes->used = oldnodes->used) * sizeof(INode*));
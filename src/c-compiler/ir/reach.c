@@ -0,0 +1,267 @@
+/** Reachability of functions and global variables
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "ir.h"
+
+#include <string.h>
+
+void reachExp(INode *node);
+
+// Flag a function as reached, and then everything its body uses
+void reachFn(FnDclNode *fndcl) {
+    if (fndcl->flags & FlagReached)
+        return;
+    fndcl->flags |= FlagReached;
+    if (fndcl->value && fndcl->value->tag == BlockTag)
+        reachExp(fndcl->value);
+}
+
+// Flag a global variable as reached
+void reachVar(VarDclNode *vardcl) {
+    if (vardcl->scope == 0)
+        vardcl->flags |= FlagReached;
+}
+
+// Reach the vtable a struct implements for a trait, when a reference to the struct
+// is coerced to a virtual reference to the trait
+void reachVtableImpl(INode *vreftype, INode *strtype) {
+    StructNode *trait = (StructNode *)itypeGetTypeDcl(((RefNode *)vreftype)->pvtype);
+    INode *strnode = itypeGetTypeDcl(strtype);
+    if (trait->tag != StructTag || trait->vtable == NULL)
+        return;
+    INode **implp;
+    uint32_t implcnt;
+    for (nodesFor(trait->vtable->impl, implcnt, implp)) {
+        VtableImpl *impl = (VtableImpl *)*implp;
+        if (impl->structdcl != strnode || impl->reached)
+            continue;
+        impl->reached = 1;
+        INode **methp;
+        uint32_t methcnt;
+        for (nodesFor(impl->methfld, methcnt, methp)) {
+            if ((*methp)->tag == FnDclTag)
+                reachFn((FnDclNode *)*methp);
+        }
+    }
+}
+
+// Reach all the nodes in a list
+void reachNodes(Nodes *nodes) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(nodes, cnt, nodesp))
+        reachExp(*nodesp);
+}
+
+// Reach every function and global variable an expression (or statement) uses
+void reachExp(INode *node) {
+    switch (node->tag) {
+    case FnDclTag:
+        reachFn((FnDclNode *)node);
+        break;
+    case VarNameUseTag:
+    {
+        INode *dclnode = ((NameUseNode *)node)->dclnode;
+        if (dclnode->tag == FnDclTag)
+            reachFn((FnDclNode *)dclnode);
+        else if (dclnode->tag == VarDclTag)
+            reachVar((VarDclNode *)dclnode);
+        break;
+    }
+    case FnCallTag:
+    case ArrIndexTag:
+    case StrFieldTag:
+    case TypeLitTag:
+    {
+        FnCallNode *fncall = (FnCallNode *)node;
+        if (node->tag != TypeLitTag)
+            reachExp(fncall->objfn);
+        if (fncall->args)
+            reachNodes(fncall->args);
+        break;
+    }
+    case VTupleTag:
+        reachNodes(((VTupleNode *)node)->values);
+        break;
+    case AssignTag:
+        reachExp(((AssignNode *)node)->lval);
+        reachExp(((AssignNode *)node)->rval);
+        break;
+    case VarDclTag:
+        if (((VarDclNode *)node)->value)
+            reachExp(((VarDclNode *)node)->value);
+        break;
+    case CastTag:
+    {
+        CastNode *cast = (CastNode *)node;
+        INode *fromtype = iexpGetTypeDcl(cast->exp);
+        if (iexpGetTypeDcl(node)->tag == VirtRefTag && fromtype->tag == RefTag)
+            reachVtableImpl(iexpGetTypeDcl(node), ((RefNode *)fromtype)->pvtype);
+        reachExp(cast->exp);
+        break;
+    }
+    case IsTag:
+        reachExp(((CastNode *)node)->exp);
+        break;
+    case BorrowTag:
+    {
+        BorrowNode *borrow = (BorrowNode *)node;
+        if (iexpGetTypeDcl(node)->tag == VirtRefTag)
+            reachVtableImpl(iexpGetTypeDcl(node), ((IExpNode *)borrow->exp)->vtype);
+        reachExp(borrow->exp);
+        break;
+    }
+    case AllocateTag:
+        reachExp(((AllocateNode *)node)->exp);
+        break;
+    case DerefTag:
+        reachExp(((DerefNode *)node)->exp);
+        break;
+    case AliasTag:
+        reachExp(((AliasNode *)node)->exp);
+        break;
+    case NamedValTag:
+        reachExp(((NamedValNode *)node)->val);
+        break;
+    case NotLogicTag:
+        reachExp(((LogicNode *)node)->lexp);
+        break;
+    case AndLogicTag:
+    case OrLogicTag:
+        reachExp(((LogicNode *)node)->lexp);
+        reachExp(((LogicNode *)node)->rexp);
+        break;
+    case BlockTag:
+        reachNodes(((BlockNode *)node)->stmts);
+        break;
+    case IfTag:
+    {
+        // An 'else' condition is voidType, which reaches nothing
+        reachNodes(((IfNode *)node)->condblk);
+        break;
+    }
+    case LoopTag:
+        reachExp(((LoopNode *)node)->blk);
+        break;
+    case ReturnTag:
+    case BlockRetTag:
+        reachExp(((ReturnNode *)node)->exp);
+        break;
+    case BreakTag:
+        if (((BreakNode *)node)->exp)
+            reachExp(((BreakNode *)node)->exp);
+        break;
+    default:
+        break;
+    }
+}
+
+// Is this declaration's name public (not '_'-prefixed)?
+int reachIsPublic(INode *node) {
+    Name *namesym = ((VarDclNode *)node)->namesym;
+    return namesym && namesym->namestr != '_';
+}
+
+// Clear the reached flag on all functions and global variables (left by an earlier compile)
+void reachClear(Nodes *nodes) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(nodes, cnt, nodesp)) {
+        INode *node = *nodesp;
+        if (node->tag == FnDclTag || node->tag == VarDclTag)
+            node->flags &= ~FlagReached;
+        else if (node->tag == ModuleTag)
+            reachClear(((ModuleNode *)node)->nodes);
+        else if (node->tag == StructTag) {
+            INode **methp;
+            uint32_t methcnt;
+            for (nodelistFor(&((StructNode *)node)->nodelist, methcnt, methp))
+                (*methp)->flags &= ~FlagReached;
+            if (((StructNode *)node)->vtable) {
+                INode **implp;
+                uint32_t implcnt;
+                for (nodesFor(((StructNode *)node)->vtable->impl, implcnt, implp))
+                    ((VtableImpl *)*implp)->reached = 0;
+            }
+        }
+    }
+}
+
+// Reach every public function, method and global variable (when there is no main())
+void reachPublic(Nodes *nodes) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(nodes, cnt, nodesp)) {
+        INode *node = *nodesp;
+        if (node->tag == FnDclTag && reachIsPublic(node))
+            reachFn((FnDclNode *)node);
+        else if (node->tag == VarDclTag && reachIsPublic(node))
+            reachVar((VarDclNode *)node);
+        else if (node->tag == ModuleTag)
+            reachPublic(((ModuleNode *)node)->nodes);
+        else if (node->tag == StructTag) {
+            INode **methp;
+            uint32_t methcnt;
+            for (nodelistFor(&((StructNode *)node)->nodelist, methcnt, methp)) {
+                if ((*methp)->tag == FnDclTag && reachIsPublic(*methp))
+                    reachFn((FnDclNode *)*methp);
+            }
+        }
+    }
+}
+
+// Count functions and global variables declared, and those reached
+void reachCount(Nodes *nodes, ReachStats *stats) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(nodes, cnt, nodesp)) {
+        INode *node = *nodesp;
+        if (node->tag == FnDclTag && ((FnDclNode *)node)->value) {
+            stats->fns++;
+            stats->fnsreached += (node->flags & FlagReached) ? 1 : 0;
+        }
+        else if (node->tag == VarDclTag) {
+            stats->vars++;
+            stats->varsreached += (node->flags & FlagReached) ? 1 : 0;
+        }
+        else if (node->tag == ModuleTag)
+            reachCount(((ModuleNode *)node)->nodes, stats);
+        else if (node->tag == StructTag) {
+            INode **methp;
+            uint32_t methcnt;
+            for (nodelistFor(&((StructNode *)node)->nodelist, methcnt, methp)) {
+                if ((*methp)->tag == FnDclTag && ((FnDclNode *)*methp)->value) {
+                    stats->fns++;
+                    stats->fnsreached += ((*methp)->flags & FlagReached) ? 1 : 0;
+                }
+            }
+        }
+    }
+}
+
+// Find the program module's main(), or return NULL
+FnDclNode *reachFindMain(ModuleNode *mod) {
+    INode **nodesp;
+    uint32_t cnt;
+    for (nodesFor(mod->nodes, cnt, nodesp)) {
+        if ((*nodesp)->tag == FnDclTag && strcmp(&((FnDclNode *)*nodesp)->namesym->namestr, "main") == 0)
+            return (FnDclNode *)*nodesp;
+    }
+    return NULL;
+}
+
+// Flag all functions and global variables reachable from the program's roots
+void reachModule(ModuleNode *mod, ReachStats *stats) {
+    reachClear(mod->nodes);
+    FnDclNode *mainfn = reachFindMain(mod);
+    if (mainfn)
+        reachFn(mainfn);
+    else
+        reachPublic(mod->nodes);
+    memset(stats, 0, sizeof(ReachStats));
+    reachCount(mod->nodes, stats);
+}
@@ -0,0 +1,31 @@
+/** Reachability of functions and global variables
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef reach_h
+#define reach_h
+
+// Only functions and global variables the program can reach are generated.
+// Reachability begins with main(), or when there is no main() (e.g., compiling a library),
+// with every public (not '_'-prefixed) function and global variable.
+// It follows every function and global variable used by a reached function's body.
+// Coercing a reference to a struct into a virtual reference reaches the vtable
+// the struct implements for that trait, and all its methods, as calls through
+// the virtual reference do not name them. Other vtables the struct implements are not generated.
+// Reached declarations are flagged FlagReached, which generation checks.
+
+// Counts of functions and global variables declared in a program, and how many are reached
+typedef struct ReachStats {
+    uint32_t fns;
+    uint32_t fnsreached;
+    uint32_t vars;
+    uint32_t varsreached;
+} ReachStats;
+
+// Flag all functions and global variables reachable from the program's roots
+void reachModule(ModuleNode *mod, ReachStats *stats);
+
+#endif
@@ -0,0 +1,148 @@
+/** Compiler statistics
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "ir.h"
+#include "stmt/generic.h"
+#include "../shared/fileio.h"
+#include "../shared/memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// The name of every tag a node may have, in the order they are reported
+static struct {
+    uint16_t tag;
+    char *name;
+} statsTags[] = {
+    { IntrinsicTag, "Intrinsic" }, { ReturnTag, "Return" }, { BlockRetTag, "BlockRet" },
+    { BreakTag, "Break" }, { ContinueTag, "Continue" }, { NameUseTag, "NameUse" },
+    { ModuleTag, "Module" }, { FnDclTag, "FnDcl" }, { VarDclTag, "VarDcl" },
+    { FieldDclTag, "FieldDcl" }, { GenericTag, "Generic" }, { VarNameUseTag, "VarNameUse" },
+    { MbrNameUseTag, "MbrNameUse" }, { ULitTag, "ULit" }, { FLitTag, "FLit" }, { NullTag, "Null" },
+    { StrLitTag, "StrLit" }, { TypeLitTag, "TypeLit" }, { VTupleTag, "VTuple" },
+    { AssignTag, "Assign" }, { FnCallTag, "FnCall" }, { ArrIndexTag, "ArrIndex" },
+    { StrFieldTag, "StrField" }, { SizeofTag, "Sizeof" }, { CastTag, "Cast" },
+    { BorrowTag, "Borrow" }, { AllocateTag, "Allocate" }, { DerefTag, "Deref" },
+    { NotLogicTag, "NotLogic" }, { OrLogicTag, "OrLogic" }, { AndLogicTag, "AndLogic" },
+    { IsTag, "Is" }, { BlockTag, "Block" }, { IfTag, "If" }, { LoopTag, "Loop" },
+    { AliasTag, "Alias" }, { NamedValTag, "NamedVal" }, { TypeNameUseTag, "TypeNameUse" },
+    { FnSigTag, "FnSig" }, { ArrayTag, "Array" }, { RefTag, "Ref" }, { ArrayRefTag, "ArrayRef" },
+    { VirtRefTag, "VirtRef" }, { ArrayDerefTag, "ArrayDeref" }, { PtrTag, "Ptr" },
+    { TTupleTag, "TTuple" }, { VoidTag, "Void" }, { IntNbrTag, "IntNbr" },
+    { UintNbrTag, "UintNbr" }, { FloatNbrTag, "FloatNbr" }, { StructTag, "Struct" },
+    { EnumTag, "Enum" }, { LifetimeTag, "Lifetime" }, { PermTag, "Perm" }, { AllocTag, "Alloc" },
+    { VecTag, "Vec" },
+};
+#define StatsTagCount (sizeof(statsTags) / sizeof(statsTags[0]))
+
+// Start counting afresh, for a new program
+void statsReset() {
+    memset(&gStats, 0, sizeof(Stats));
+}
+
+// Count a struct whose fields were reordered to save space, given its size before and after
+void statsAddReorder(char *name, uint64_t declsize, uint64_t size) {
+    if (gStats.reordered == gStats.reorderavail) {
+        StatsReorder *oldreorders = gStats.reorders;
+        gStats.reorderavail = gStats.reorderavail == 0 ? 8 : gStats.reorderavail << 1;
+        gStats.reorders = (StatsReorder *)memAllocBlk(gStats.reorderavail * sizeof(StatsReorder));
+        if (gStats.reordered)
+            memcpy(gStats.reorders, oldreorders, gStats.reordered * sizeof(StatsReorder));
+    }
+    StatsReorder *reorder = &gStats.reorders[gStats.reordered++];
+    reorder->name = name;
+    reorder->declsize = declsize;
+    reorder->size = size;
+    gStats.reordersaved += declsize - size;
+}
+
+// Return the number of IR nodes created (of every tag)
+static uint64_t statsNodeTotal() {
+    uint64_t total = 0;
+    size_t i;
+    for (i = 0; i < StatsNodeSlots; i++)
+        total += gStats.nodes[i];
+    return total;
+}
+
+// Print the program's statistics as text
+void statsPrint(char *srcname) {
+    size_t names, slots;
+    size_t blkalloc, blkused, stralloc, strused;
+    uint32_t srcreads, srcprefetched;
+    names = nametblUsed(&slots);
+    memArenaStats(&blkalloc, &blkused, &stralloc, &strused);
+    fileSrcReadStats(&srcreads, &srcprefetched);
+
+    printf("Compiler statistics for %s:\n", srcname);
+    printf("  Sources read:        %u, %u of them ahead of parsing\n", srcreads, srcprefetched);
+    printf("  Tokens lexed:        %llu\n", (unsigned long long)gStats.tokens);
+    printf("  Names interned:      %zu of %zu slots (%.1f%% load)\n",
+        names, slots, slots ? 100.0 * names / slots : 0.0);
+    printf("  Hook table depth:    %u at most\n", gStats.hookdepth);
+    printf("  Namespaces grown:    %u\n", gStats.nsgrown);
+    printf("  Node lists grown:    %u\n", gStats.nodesgrown);
+    printf("  Block arena:         %zu bytes used of %zu allocated\n", blkused, blkalloc);
+    printf("  String arena:        %zu bytes used of %zu allocated\n", strused, stralloc);
+    printf("  IR nodes:            %llu\n", (unsigned long long)statsNodeTotal());
+    size_t i;
+    for (i = 0; i < StatsTagCount; i++) {
+        uint32_t count = gStats.nodes[statsNodeSlot(statsTags[i].tag)];
+        if (count)
+            printf("    %-18s %u\n", statsTags[i].name, count);
+    }
+    printf("  Functions reached:   %u of %u\n", gStats.fnsreached, gStats.fns);
+    printf("  Globals reached:     %u of %u\n", gStats.varsreached, gStats.vars);
+    printf("  Generic instances:   %u, for %u uses\n", gGenericStats.insts, gGenericStats.uses);
+    printf("  Structs reordered:   %u, saving %llu bytes\n", gStats.reordered, (unsigned long long)gStats.reordersaved);
+    for (i = 0; i < gStats.reordered; i++)
+        printf("    %-18s %llu -> %llu bytes\n", gStats.reorders[i].name,
+            (unsigned long long)gStats.reorders[i].declsize, (unsigned long long)gStats.reorders[i].size);
+    printf("  LLVM functions:      %u, with %u basic blocks\n", gStats.llvmfns, gStats.llvmblocks);
+    printf("  LLVM instructions:   %llu before optimization, %llu after\n",
+        (unsigned long long)gStats.llvminsts, (unsigned long long)gStats.llvmoptinsts);
+}
+
+// Write the program's statistics as JSON to a file
+void statsPrintJson(FILE *file, char *srcname) {
+    size_t names, slots;
+    size_t blkalloc, blkused, stralloc, strused;
+    uint32_t srcreads, srcprefetched;
+    names = nametblUsed(&slots);
+    memArenaStats(&blkalloc, &blkused, &stralloc, &strused);
+    fileSrcReadStats(&srcreads, &srcprefetched);
+
+    fprintf(file, "{\n  \"program\": \"%s\",\n", srcname);
+    fprintf(file, "  \"sources\": {\"read\": %u, \"read_ahead\": %u},\n", srcreads, srcprefetched);
+    fprintf(file, "  \"tokens\": %llu,\n", (unsigned long long)gStats.tokens);
+    fprintf(file, "  \"names\": {\"interned\": %zu, \"slots\": %zu, \"load\": %.4f},\n",
+        names, slots, slots ? (double)names / slots : 0.0);
+    fprintf(file, "  \"hook_depth\": %u,\n", gStats.hookdepth);
+    fprintf(file, "  \"namespaces_grown\": %u,\n", gStats.nsgrown);
+    fprintf(file, "  \"nodes_grown\": %u,\n", gStats.nodesgrown);
+    fprintf(file, "  \"arenas\": {\"block\": {\"allocated\": %zu, \"used\": %zu}, "
+        "\"string\": {\"allocated\": %zu, \"used\": %zu}},\n", blkalloc, blkused, stralloc, strused);
+    fprintf(file, "  \"ir_nodes\": {\"total\": %llu", (unsigned long long)statsNodeTotal());
+    size_t i;
+    for (i = 0; i < StatsTagCount; i++) {
+        uint32_t count = gStats.nodes[statsNodeSlot(statsTags[i].tag)];
+        if (count)
+            fprintf(file, ", \"%s\": %u", statsTags[i].name, count);
+    }
+    fprintf(file, "},\n");
+    fprintf(file, "  \"functions\": {\"declared\": %u, \"reached\": %u},\n", gStats.fns, gStats.fnsreached);
+    fprintf(file, "  \"globals\": {\"declared\": %u, \"reached\": %u},\n", gStats.vars, gStats.varsreached);
+    fprintf(file, "  \"generics\": {\"instances\": %u, \"uses\": %u},\n", gGenericStats.insts, gGenericStats.uses);
+    fprintf(file, "  \"reordered\": {\"structs\": %u, \"bytes_saved\": %llu, \"by_struct\": [",
+        gStats.reordered, (unsigned long long)gStats.reordersaved);
+    for (i = 0; i < gStats.reordered; i++)
+        fprintf(file, "%s{\"name\": \"%s\", \"size\": %llu, \"reordered_size\": %llu}", i ? ", " : "",
+            gStats.reorders[i].name, (unsigned long long)gStats.reorders[i].declsize, (unsigned long long)gStats.reorders[i].size);
+    fprintf(file, "]},\n");
+    fprintf(file, "  \"llvm\": {\"functions\": %u, \"blocks\": %u, \"instructions\": %llu, \"optimized_instructions\": %llu}\n}\n",
+        gStats.llvmfns, gStats.llvmblocks, (unsigned long long)gStats.llvminsts, (unsigned long long)gStats.llvmoptinsts);
+}
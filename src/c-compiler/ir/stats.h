@@ -0,0 +1,67 @@
+/** Compiler statistics
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef stats_h
+#define stats_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Counts of what compiling a program took, for tuning the compiler (e.g., arena sizes)
+// and finding pathological inputs. They are gathered for every program (cheaply),
+// and reported for each by --stats (as text) or --stats-json (as a .stats.json file).
+// The name table, memory arenas and source cache outlive a program, so in a batch their counts
+// include the programs compiled before it.
+
+// Where a node's tag is counted: a slot per tag, grouped by the tag's high (group) bits
+#define statsNodeSlot(tag) ((((tag) >> 12) << 6) | ((tag) & 0x3F))
+#define StatsNodeSlots (16 << 6)
+
+// A struct whose fields were reordered to save space: its size as declared, and as reordered
+typedef struct StatsReorder {
+    char *name;
+    uint64_t declsize;
+    uint64_t size;
+} StatsReorder;
+
+typedef struct Stats {
+    uint64_t tokens;            // Tokens lexed
+    uint32_t hookdepth;         // Deepest nesting of name hook tables
+    uint32_t nsgrown;           // Namespaces that doubled their size
+    uint32_t nodesgrown;        // Nodes lists that were reallocated to grow
+    uint32_t nodes[StatsNodeSlots];    // IR nodes created, by tag
+
+    uint32_t fns;               // Functions declared, and how many were reached
+    uint32_t fnsreached;
+    uint32_t vars;              // Global variables declared, and how many were reached
+    uint32_t varsreached;
+    uint32_t reordered;         // Structs whose fields were reordered to save space
+    uint64_t reordersaved;      // Bytes saved by reordering (summed over those structs)
+    StatsReorder *reorders;     // Each of those structs (reordered of them)
+    uint32_t reorderavail;
+
+    uint32_t llvmfns;           // LLVM functions defined, and their basic blocks
+    uint32_t llvmblocks;
+    uint64_t llvminsts;         // LLVM instructions, before and after optimization
+    uint64_t llvmoptinsts;
+} Stats;
+
+Stats gStats;
+
+// Start counting afresh, for a new program
+void statsReset();
+
+// Count a struct whose fields were reordered to save space, given its size before and after
+void statsAddReorder(char *name, uint64_t declsize, uint64_t size);
+
+// Print the program's statistics as text
+void statsPrint(char *srcname);
+
+// Write the program's statistics as JSON to a file
+void statsPrintJson(FILE *file, char *srcname);
+
+#endif
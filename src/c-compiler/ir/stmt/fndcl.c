@@ -21,6 +21,7 @@ FnDclNode *newFnDclNode(Name *namesym, uint16_t flags, INode *type, INode *val)
     name->llvmvar = NULL;
     name->genname = namesym? &namesym->namestr : "";
     name->nextnode = NULL;
+    name->attrs = 0;
     return name;
 }
 
@@ -44,7 +45,11 @@ void fnDclNameRes(NameResState *pstate, FnDclNode *name) {
     inodeNameRes(pstate, &name->vtype);
     if (!name->value)
         return;
+    fnDclNameResBody(pstate, name);
+}
 
+// Resolve all names in a function's body (its signature must already be resolved)
+void fnDclNameResBody(NameResState *pstate, FnDclNode *name) {
     uint16_t oldscope = pstate->scope;
     pstate->scope = 1;
 
@@ -57,7 +62,10 @@ void fnDclNameRes(NameResState *pstate, FnDclNode *name) {
     for (nodesFor(fnsig->parms, cnt, nodesp))
         nametblHookNode(((VarDclNode *)*nodesp)->namesym, *nodesp);
 
+    int wasinbody = gIncrActive ? incrNameResBody(1) : 0;
     inodeNameRes(pstate, &name->value);
+    if (gIncrActive)
+        incrNameResBody(wasinbody);
 
     nametblHookPop();
     pstate->scope = oldscope;
@@ -90,9 +98,18 @@ void fnImplicitReturn(INode *rettype, BlockNode *blk) {
 // - Perform type checking for all statements
 // - Perform data flow analysis on variables and references
 void fnDclTypeCheck(TypeCheckState *pstate, FnDclNode *fnnode) {
+    // Already checked when first called at compile time (see evalFnCall)
+    if (fnnode->flags & FlagChecked)
+        return;
     inodeTypeCheck(pstate, &fnnode->vtype);
     if (!fnnode->value)
         return;
+    fnDclTypeCheckBody(pstate, fnnode);
+}
+
+// Type check a function's body (its signature must already be checked)
+void fnDclTypeCheckBody(TypeCheckState *pstate, FnDclNode *fnnode) {
+    fnnode->flags = (fnnode->flags & ~FlagChecked) | FlagChecking;
 
     // Ensure self parameter on a method is (reference to) its enclosing type
     if (fnnode->flags & FlagMethFld) {
@@ -109,11 +126,13 @@ void fnDclTypeCheck(TypeCheckState *pstate, FnDclNode *fnnode) {
     pstate->fnsig = (FnSigNode*)fnnode->vtype;   // needed for return type check
     inodeTypeCheck(pstate, &fnnode->value);
     pstate->fnsig = oldfnsig;
+    fnnode->flags &= ~FlagChecking;
 
     // Immediately perform the data flow pass for this function
     // We run data flow separately as it requires type info which is inferred bottoms-up
     if (errors)
         return;
+    fnnode->flags |= FlagChecked;
     flowAliasInit();
     FlowState fstate;
     fstate.fnsig = (FnSigNode *)fnnode->vtype;
@@ -7,6 +7,18 @@
 #ifndef fndcl_h
 #define fndcl_h
 
+// Function attributes (e.g., @inline): hints on how to optimize and lay out a function
+enum FnAttrs {
+    FnAttrInline = 0x0001,      // @inline: always inline into callers
+    FnAttrNoInline = 0x0002,    // @noinline: never inline into callers
+    FnAttrHot = 0x0004,         // @hot: called often, so optimize it for speed
+    FnAttrCold = 0x0008,        // @cold: called rarely (e.g., error handling), so keep it out of the way
+    FnAttrPure = 0x0010,        // @pure: result depends only on its arguments (reads no memory)
+    FnAttrReadOnly = 0x0020,    // @readonly: may read memory, but never writes it
+    FnAttrNoReturn = 0x0040,    // @noreturn: never returns to its caller
+    FnAttrMultiversion = 0x0080, // @multiversion: compile for several CPU feature levels, picking one at load time
+};
+
 // Function/method declaration node
 typedef struct FnDclNode {
     IExpNodeHdr;                // 'vtype': type of this name's value
@@ -16,6 +28,7 @@ typedef struct FnDclNode {
     char *genname;                // Name of the function as known to the linker
     struct FnDclNode *nextnode;   // Link to next overloaded method with the same name (or NULL)
     uint16_t vtblidx;             // Method ptr's index in the type's vtable
+    uint16_t attrs;               // Function attributes (FnAttrs)
 } FnDclNode;
 
 FnDclNode *newFnDclNode(Name *namesym, uint16_t tag, INode *sig, INode *val);
@@ -23,11 +36,15 @@ void fnDclPrint(FnDclNode *fn);
 
 /// Resolve all names in a function
 void fnDclNameRes(NameResState *pstate, FnDclNode *name);
+// Resolve all names in a function's body (its signature must already be resolved)
+void fnDclNameResBody(NameResState *pstate, FnDclNode *name);
 
 // Type checking a function's logic, does more than you might think:
 // - Turn implicit returns into explicit returns
 // - Perform type checking for all statements
 // - Perform data flow analysis on variables and references
 void fnDclTypeCheck(TypeCheckState *pstate, FnDclNode *fnnode);
+// Type check a function's body (its signature must already be checked)
+void fnDclTypeCheckBody(TypeCheckState *pstate, FnDclNode *fnnode);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,338 @@
+/** Handling for generic declaration nodes
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "../ir.h"
+#include "../../parser/parser.h"
+
+#include <string.h>
+
+// How deeply instances may be created while checking other instances
+// (e.g., a generic that uses itself with ever larger type arguments)
+#define GenericDepthMax 64
+uint32_t gGenericDepth = 0;
+
+// Create a new generic declaration node
+GenericNode *newGenericNode(INode *dcl, Nodes *parms, ModuleNode *mod, char *prefix) {
+    GenericNode *gen;
+    newNode(gen, GenericNode, GenericTag);
+    copyNodeLex(gen, dcl);
+    gen->vtype = NULL;
+    gen->namesym = dcl->tag == FnDclTag ? ((FnDclNode *)dcl)->namesym : ((StructNode *)dcl)->namesym;
+    gen->dcl = dcl;
+    gen->parms = parms;
+    gen->mod = mod;
+    gen->gennamePrefix = prefix;
+    gen->insts = newNodes(4);
+    gen->instargs = newNodes(4);
+    return gen;
+}
+
+// Serialize a generic declaration node
+void genericPrint(GenericNode *node) {
+    INode **nodesp;
+    uint32_t cnt;
+    inodeFprint("generic %s[", &node->namesym->namestr);
+    for (nodesFor(node->parms, cnt, nodesp)) {
+        inodeFprint("%s", &((NameUseNode *)*nodesp)->namesym->namestr);
+        if (cnt > 1)
+            inodeFprint(", ");
+    }
+    inodeFprint("] with %u instances", node->insts->used);
+}
+
+// Is node a name use of a generic (before it is given type arguments)?
+int genericIsName(INode *node) {
+    if (node->tag != VarNameUseTag && node->tag != TypeNameUseTag)
+        return 0;
+    INode *dclnode = ((NameUseNode *)node)->dclnode;
+    return dclnode && dclnode->tag == GenericTag;
+}
+
+// Is node a generic type given its type arguments (e.g., Pair[i32]) before type check?
+int genericIsTypeUse(INode *node) {
+    if (node->tag != FnCallTag || !(node->flags & FlagIndex) || !genericIsName(((FnCallNode *)node)->objfn))
+        return 0;
+    GenericNode *gen = (GenericNode *)((NameUseNode *)((FnCallNode *)node)->objfn)->dclnode;
+    return gen->dcl->tag == StructTag;
+}
+
+// Return the name of an instance (a FnDcl or Struct)
+Name *genericInstNamesym(INode *inst) {
+    return inst->tag == FnDclTag ? ((FnDclNode *)inst)->namesym : ((StructNode *)inst)->namesym;
+}
+
+// A type argument's canonical form: its declaration if named, otherwise the type itself (e.g., &i32)
+INode *genericCanonType(INode *type) {
+    return itypeGetTypeDcl(type);
+}
+
+// Return the instance's name, which spells out its canonical type arguments, e.g., max[&i32]
+Name *genericInstName(GenericNode *gen, INode **typeargs) {
+    char workbuf[2048];
+    char *bufp = workbuf;
+    strcpy(bufp, &gen->namesym->namestr);
+    bufp += strlen(bufp);
+    *bufp++ = '[';
+    uint32_t i;
+    for (i = 0; i < gen->parms->used; i++) {
+        if (i > 0)
+            *bufp++ = ',';
+        bufp = itypeMangle(bufp, typeargs[i]);
+    }
+    *bufp++ = ']';
+    return nametblFind(workbuf, bufp - workbuf);
+}
+
+// Are these an instance's canonical type arguments? Named types must be the same declaration,
+// as same-named types declared in different modules (a::Point, b::Point) are different types.
+int genericIsInstArgs(GenericNode *gen, Nodes *instargs, INode **typeargs) {
+    uint32_t i;
+    for (i = 0; i < gen->parms->used; i++) {
+        INode *instarg = nodesGet(instargs, i);
+        if (instarg->tag == ArrayTag && typeargs[i]->tag == ArrayTag) {
+            if (!arrayEqual((ArrayNode *)instarg, (ArrayNode *)typeargs[i]))
+                return 0;
+        }
+        else if (!itypeIsSame(instarg, typeargs[i]))
+            return 0;
+    }
+    return 1;
+}
+
+// Return the instance of a generic for these (canonical) type arguments,
+// creating and type checking it if this is their first use. Return NULL on failure.
+INode *genericInstantiate(GenericNode *gen, INode **typeargs, INode *usenode) {
+    Name *instname = genericInstName(gen, typeargs);
+    ++gGenericStats.uses;
+
+    // Every use of the same type arguments shares one instance
+    uint32_t i;
+    for (i = 0; i < gen->insts->used; i++) {
+        if (genericIsInstArgs(gen, ((TTupleNode *)nodesGet(gen->instargs, i))->types, typeargs))
+            return nodesGet(gen->insts, i);
+    }
+    if (gGenericDepth >= GenericDepthMax) {
+        errorMsgNode(usenode, ErrorRecurse, "Generic instances are nested too deeply to create %s", &instname->namestr);
+        return NULL;
+    }
+
+    // Re-parse the generic's declaration as the instance, named for its type arguments
+    ParseState parse;
+    memset(&parse, 0, sizeof(ParseState));
+    parse.mod = gen->mod;
+    parse.gennamePrefix = gen->gennamePrefix;
+    parse.instname = instname;
+    lexInjectAt((INode *)gen);
+    INode *inst;
+    if (gen->dcl->tag == FnDclTag) {
+        // Attributes precede the re-parsed text, so carry them over
+        parse.fnattrs = ((FnDclNode *)gen->dcl)->attrs;
+        inst = parseFn(&parse, 0, ParseMayName | ParseMayImpl | ParseMayGeneric);
+        nameGenVarName((VarDclNode *)inst, parse.gennamePrefix);
+    }
+    else
+        inst = parseStruct(&parse, gen->dcl->flags);
+    lexPop();
+    // Registered before it is checked, so that it may use itself
+    TTupleNode *instargs = newTTupleNode(gen->parms->used);
+    for (i = 0; i < gen->parms->used; i++)
+        nodesAdd(&instargs->types, typeargs[i]);
+    nodesAdd(&gen->insts, inst);
+    nodesAdd(&gen->instargs, (INode *)instargs);
+
+    // Resolve its names in the generic's module, where each type parameter names its type argument
+    NameResState nstate;
+    nstate.mod = gen->mod;
+    nstate.typenode = NULL;
+    nstate.scope = 0;
+    nstate.flags = 0;
+    nametblHookPush();
+    nametblHookNamespace(&gen->mod->namespace);
+    nametblHookPush();
+    for (i = 0; i < gen->parms->used; i++)
+        nametblHookNode(((NameUseNode *)nodesGet(gen->parms, i))->namesym, typeargs[i]);
+    nametblHookNode(instname, inst);
+    inodeNameRes(&nstate, &inst);
+    nametblHookPop();
+    nametblHookPop();
+
+    // Type check it now, as the use needs its signature or type
+    TypeCheckState tstate;
+    tstate.fnsig = NULL;
+    tstate.typenode = NULL;
+    tstate.loopcnt = 0;
+    tstate.loopstack = memAllocBlk(sizeof(LoopNode*) * TypeCheckLoopMax);
+    int olderrors = errors;
+    ++gGenericDepth;
+    inodeTypeCheck(&tstate, &inst);
+    --gGenericDepth;
+    if (errors > olderrors)
+        errorMsgNode(usenode, ErrorInvType, "The errors above are in %s, instantiated here", &instname->namestr);
+    return inst;
+}
+
+// Return a name use of an instance, to replace the generic's use
+INode *genericNameUse(INode *inst, INode *usenode) {
+    NameUseNode *use = newNameUseNode(genericInstNamesym(inst));
+    copyNodeLex(use, usenode);
+    use->dclnode = inst;
+    if (inst->tag == FnDclTag) {
+        use->tag = VarNameUseTag;
+        use->vtype = ((FnDclNode *)inst)->vtype;
+    }
+    else
+        use->tag = TypeNameUseTag;
+    return (INode *)use;
+}
+
+// Type check a generic's use with explicit type arguments (e.g., max[i32] or Pair[i32]),
+// replacing it with a name use of the instance for those arguments
+void genericTypeCheckUse(TypeCheckState *pstate, FnCallNode **nodep) {
+    FnCallNode *node = *nodep;
+    GenericNode *gen = (GenericNode *)((NameUseNode *)node->objfn)->dclnode;
+    if (node->args->used != gen->parms->used) {
+        errorMsgNode((INode *)node, node->args->used < gen->parms->used ? ErrorFewArgs : ErrorManyArgs,
+            "%s expects %u type arguments", &gen->namesym->namestr, gen->parms->used);
+        return;
+    }
+
+    INode **typeargs = (INode **)memAllocBlk(gen->parms->used * sizeof(INode *));
+    uint32_t i;
+    for (i = 0; i < gen->parms->used; i++) {
+        INode *arg = nodesGet(node->args, i);
+        if (!isTypeNode(arg)) {
+            errorMsgNode(arg, ErrorInvType, "Expected a type argument for %s", &gen->namesym->namestr);
+            return;
+        }
+        typeargs[i] = genericCanonType(arg);
+    }
+
+    INode *inst = genericInstantiate(gen, typeargs, (INode *)node);
+    if (inst)
+        *((INode **)nodep) = genericNameUse(inst, (INode *)node);
+}
+
+// Infer type arguments by matching a parameter's declared type (not yet resolved)
+// against its argument's type. Return 0 if an inference conflicts with an earlier one.
+int genericInfer(GenericNode *gen, INode **typeargs, INode *parmtype, INode *argtype) {
+    argtype = itypeGetTypeDcl(argtype);
+    switch (parmtype->tag) {
+    case NameUseTag:
+    {
+        NameUseNode *name = (NameUseNode *)parmtype;
+        uint32_t i;
+        if (name->qualNames)
+            return 1;
+        for (i = 0; i < gen->parms->used; i++) {
+            if (((NameUseNode *)nodesGet(gen->parms, i))->namesym != name->namesym)
+                continue;
+            if (typeargs[i] == NULL)
+                typeargs[i] = genericCanonType(argtype);
+            else if (!itypeIsSame(typeargs[i], argtype))
+                return 0;
+        }
+        return 1;
+    }
+    case RefTag:
+    case ArrayRefTag:
+    case VirtRefTag:
+        if (argtype->tag != parmtype->tag)
+            return 1;
+        return genericInfer(gen, typeargs, ((RefNode *)parmtype)->pvtype, ((RefNode *)argtype)->pvtype);
+    case FnCallTag:
+    {
+        // A generic type given type arguments (e.g., Pair[T]) matches the arguments of its instance
+        FnCallNode *typeuse = (FnCallNode *)parmtype;
+        if (argtype->tag != StructTag || typeuse->objfn->tag != NameUseTag || typeuse->args == NULL)
+            return 1;
+        GenericNode *typegen = (GenericNode *)namespaceFind(&gen->mod->namespace, ((NameUseNode *)typeuse->objfn)->namesym);
+        if (typegen == NULL || typegen->tag != GenericTag)
+            return 1;
+        uint32_t i;
+        for (i = 0; i < typegen->insts->used; i++) {
+            if (nodesGet(typegen->insts, i) != argtype)
+                continue;
+            Nodes *instargs = ((TTupleNode *)nodesGet(typegen->instargs, i))->types;
+            uint32_t j;
+            for (j = 0; j < typeuse->args->used && j < instargs->used; j++) {
+                if (!genericInfer(gen, typeargs, nodesGet(typeuse->args, j), nodesGet(instargs, j)))
+                    return 0;
+            }
+        }
+        return 1;
+    }
+    case PtrTag:
+        if (argtype->tag != PtrTag)
+            return 1;
+        return genericInfer(gen, typeargs, ((PtrNode *)parmtype)->pvtype, ((PtrNode *)argtype)->pvtype);
+    case ArrayTag:
+        if (argtype->tag != ArrayTag)
+            return 1;
+        return genericInfer(gen, typeargs, ((ArrayNode *)parmtype)->elemtype, ((ArrayNode *)argtype)->elemtype);
+    default:
+        return 1;
+    }
+}
+
+// Point a call of a generic function (e.g., max(a, b)) to the instance whose type arguments
+// are inferred from the (already type checked) arguments. Return 0 if they cannot be inferred.
+int genericInferCall(FnCallNode *node) {
+    GenericNode *gen = (GenericNode *)((NameUseNode *)node->objfn)->dclnode;
+    if (gen->dcl->tag != FnDclTag) {
+        errorMsgNode((INode *)node, ErrorNotFn, "Specify the type arguments of %s in [], e.g., %s[i32]",
+            &gen->namesym->namestr, &gen->namesym->namestr);
+        return 0;
+    }
+
+    INode **typeargs = (INode **)memAllocBlk(gen->parms->used * sizeof(INode *));
+    memset(typeargs, 0, gen->parms->used * sizeof(INode *));
+    Nodes *parms = ((FnSigNode *)((FnDclNode *)gen->dcl)->vtype)->parms;
+    uint32_t i;
+    for (i = 0; i < parms->used && i < node->args->used; i++) {
+        INode *arg = nodesGet(node->args, i);
+        if (!isExpNode(arg) || ((IExpNode *)arg)->vtype == NULL)
+            continue;
+        INode *parmtype = ((VarDclNode *)nodesGet(parms, i))->vtype;
+        if (parmtype && !genericInfer(gen, typeargs, parmtype, ((IExpNode *)arg)->vtype)) {
+            errorMsgNode(arg, ErrorInvType, "Argument's type differs from the type an earlier argument gave a type parameter of %s",
+                &gen->namesym->namestr);
+            return 0;
+        }
+    }
+    for (i = 0; i < gen->parms->used; i++) {
+        if (typeargs[i] == NULL) {
+            errorMsgNode((INode *)node, ErrorNoType, "Cannot infer type parameter %s of %s from the arguments. Specify it in [].",
+                &((NameUseNode *)nodesGet(gen->parms, i))->namesym->namestr, &gen->namesym->namestr);
+            return 0;
+        }
+    }
+
+    INode *inst = genericInstantiate(gen, typeargs, (INode *)node);
+    if (inst == NULL)
+        return 0;
+    node->objfn = genericNameUse(inst, node->objfn);
+    return 1;
+}
+
+// Add every generic's instances to its module's nodes, so they are generated (after type check)
+void genericAddInsts(ModuleNode *mod) {
+    uint32_t used = mod->nodes->used;
+    uint32_t i;
+    for (i = 0; i < used; i++) {
+        INode *node = nodesGet(mod->nodes, i);
+        if (node->tag == ModuleTag)
+            genericAddInsts((ModuleNode *)node);
+        else if (node->tag == GenericTag) {
+            INode **nodesp;
+            uint32_t cnt;
+            for (nodesFor(((GenericNode *)node)->insts, cnt, nodesp)) {
+                nodesAdd(&mod->nodes, *nodesp);
+                ++gGenericStats.insts;
+            }
+        }
+    }
+}
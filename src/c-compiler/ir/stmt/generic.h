@@ -0,0 +1,61 @@
+/** Handling for generic declaration nodes
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef generic_h
+#define generic_h
+
+// A generic is a global function or struct declared with type parameters
+// (e.g., fn max[T](a T, b T) T, or struct Pair[T]). It is never resolved, checked or
+// generated itself. Each use of it (e.g., max[i32](a, b), max(a, b), or Pair[f32])
+// names an instance: a declaration for one tuple of type arguments, given or inferred.
+//
+// An instance is keyed by the canonical spelling of its type arguments (e.g., max[&i32]),
+// so that every use of the same arguments in the program shares one instance.
+// It is created on first use by re-parsing the generic's source text under the instance's name,
+// then resolved with each type parameter standing for its type argument, and type checked.
+// Instances join their module's nodes after type check, so they are folded, reached and generated
+// like any other declaration. Instances whose LLVM bodies are identical (e.g., for references
+// to different types) are merged during optimization.
+typedef struct GenericNode {
+    IExpNodeHdr;
+    Name *namesym;
+    INode *dcl;             // The FnDcl or Struct as parsed, before name resolution
+    Nodes *parms;           // Type parameters (NameUse nodes)
+    ModuleNode *mod;        // Module the generic is declared in (whose names it resolves to)
+    char *gennamePrefix;    // Module prefix for the linker names of its instances
+    Nodes *insts;           // Instances made so far, each a FnDcl or Struct
+    Nodes *instargs;        // Each instance's canonical type arguments (a TTuple)
+} GenericNode;
+
+// Counts of generic instances and their uses, for the compile's statistics
+typedef struct GenericStats {
+    uint32_t insts;         // Instances generated
+    uint32_t uses;          // Uses that named an instance
+} GenericStats;
+
+GenericStats gGenericStats;
+
+GenericNode *newGenericNode(INode *dcl, Nodes *parms, ModuleNode *mod, char *prefix);
+void genericPrint(GenericNode *node);
+
+// Is node a name use of a generic (before it is given type arguments)?
+int genericIsName(INode *node);
+// Is node a generic type given its type arguments (e.g., Pair[i32]) before type check?
+int genericIsTypeUse(INode *node);
+
+// Type check a generic's use with explicit type arguments (e.g., max[i32] or Pair[i32]),
+// replacing it with a name use of the instance for those arguments
+void genericTypeCheckUse(TypeCheckState *pstate, FnCallNode **nodep);
+
+// Point a call of a generic function (e.g., max(a, b)) to the instance whose type arguments
+// are inferred from the (already type checked) arguments. Return 0 if they cannot be inferred.
+int genericInferCall(FnCallNode *node);
+
+// Add every generic's instances to its module's nodes, so they are generated (after type check)
+void genericAddInsts(ModuleNode *mod);
+
+#endif
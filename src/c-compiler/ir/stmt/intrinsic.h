@@ -40,14 +40,37 @@ enum IntrinsicFn {
     XorIntrinsic,
     ShlIntrinsic,
     ShrIntrinsic,
+    PopcountIntrinsic,  // count of 1 bits
+    ClzIntrinsic,       // count of leading 0 bits
+    CtzIntrinsic,       // count of trailing 0 bits
+    BswapIntrinsic,     // reverse byte order
+    RotlIntrinsic,      // rotate bits left
+    RotrIntrinsic,      // rotate bits right
+
+    // Saturating arithmetic (clamps to the type's range rather than wrapping)
+    AddSatIntrinsic,
+    SubSatIntrinsic,
 
     // Reference methods
     CountIntrinsic,
+    PrefetchIntrinsic,  // hint that the referenced value will soon be read
 
     // Intrinsic functions
     SqrtIntrinsic,
     SinIntrinsic,
-    CosIntrinsic
+    CosIntrinsic,
+    FmaIntrinsic,       // a*b+c, rounded once
+
+    // Vector methods
+    ShuffleIntrinsic,   // rearrange lanes
+    SelectIntrinsic,    // pick lanes from one of two vectors using a mask
+    SumIntrinsic,       // horizontal reductions
+    MinIntrinsic,       // also number methods (of two values)
+    MaxIntrinsic,
+    AnyIntrinsic,
+    AllIntrinsic,
+    LoadIntrinsic,      // load lanes from an array reference
+    StoreIntrinsic      // store lanes into an array reference
 };
 
 // An internal operation (e.g., add). 
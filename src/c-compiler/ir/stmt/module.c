@@ -91,6 +91,8 @@ void modNameRes(NameResState *pstate, ModuleNode *mod) {
     INode **nodesp;
     uint32_t cnt;
     for (nodesFor(mod->nodes, cnt, nodesp)) {
+        if (gIncrActive)
+            incrNameResDcl(*nodesp);
         inodeNameRes(pstate, nodesp);
     }
 
@@ -108,6 +110,8 @@ void modTypeCheck(TypeCheckState *pstate, ModuleNode *mod) {
     INode **nodesp;
     uint32_t cnt;
     for (nodesFor(mod->nodes, cnt, nodesp)) {
+        if (gIncrActive)
+            incrTypeCheckDcl(*nodesp, 0);
         switch ((*nodesp)->tag) {
         case VarDclTag:
         {
@@ -129,6 +133,8 @@ void modTypeCheck(TypeCheckState *pstate, ModuleNode *mod) {
     // Now we can process the full node info
     if (errors == 0) {
         for (nodesFor(mod->nodes, cnt, nodesp)) {
+            if (gIncrActive)
+                incrTypeCheckDcl(*nodesp, (*nodesp)->tag == FnDclTag);
             inodeTypeCheck(pstate, nodesp);
         }
     }
@@ -82,6 +82,19 @@ void varDclNameRes(NameResState *pstate, VarDclNode *name) {
 
 // Type check variable against its initial value
 void varDclTypeCheck(TypeCheckState *pstate, VarDclNode *name) {
+    // A global variable may already have been checked when first used (see nameUseTypeCheck)
+    if (name->scope == 0) {
+        if (name->flags & FlagChecked)
+            return;
+        if (name->flags & FlagChecking) {
+            errorMsgNode((INode*)name, ErrorRecurse, "Global variable's value may not depend on itself.");
+            if (name->vtype == NULL)
+                name->vtype = voidType;
+            return;
+        }
+        name->flags |= FlagChecking;
+    }
+
     inodeTypeCheck(pstate, (INode**)&name->perm);
     if (name->vtype)
         inodeTypeCheck(pstate, &name->vtype);
@@ -95,8 +108,9 @@ void varDclTypeCheck(TypeCheckState *pstate, VarDclNode *name) {
     }
     // Type check the initialization value
     else {
-        // Global variables and function parameters require literal initializers
-        if (name->scope <= 1 && !litIsLiteral(name->value))
+        // Function parameters require literal initializers. A global variable's
+        // initializer is evaluated at compile time once all is type checked (see evalGlobals).
+        if (name->scope == 1 && !litIsLiteral(name->value))
             errorMsgNode(name->value, ErrorNotLit, "Variable may only be initialized with a literal value.");
         // Verify that declared type and initial value type match
         if (!iexpTypeCheckAndMatch(pstate, &name->vtype, &name->value))
@@ -106,6 +120,7 @@ void varDclTypeCheck(TypeCheckState *pstate, VarDclNode *name) {
     // Variables cannot hold a void or opaque struct value
     if (!itypeIsConcrete(name->vtype))
         errorMsgNode((INode*)name, ErrorInvType, "Variable's type must be concrete and instantiable.");
+    name->flags |= FlagChecked;
 }
 
 // Perform data flow analysis
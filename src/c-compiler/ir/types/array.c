@@ -13,6 +13,7 @@ ArrayNode *newArrayNode() {
     newNode(anode, ArrayNode, ArrayTag);
     anode->namesym = anonName;
     anode->llvmtype = NULL;
+    anode->sizeexp = NULL;
     iNsTypeInit((INsTypeNode*)anode, 0);
     return anode;
 }
@@ -27,17 +28,42 @@ ArrayNode *newArrayNodeTyped(size_t size, INode *elemtype) {
 
 // Serialize an array type
 void arrayPrint(ArrayNode *node) {
-    inodeFprint("[%d]", (int)node->size);
+    if (node->sizeexp) {
+        inodeFprint("[");
+        inodePrintNode(node->sizeexp);
+        inodeFprint(node->flags & SoaLayout ? " soa]" : "]");
+    }
+    else
+        inodeFprint(node->flags & SoaLayout ? "[%d soa]" : "[%d]", (int)node->size);
     inodePrintNode(node->elemtype);
 }
 
 // Name resolution of an array type
 void arrayNameRes(NameResState *pstate, ArrayNode *node) {
+    if (node->sizeexp)
+        inodeNameRes(pstate, &node->sizeexp);
     inodeNameRes(pstate, &node->elemtype);
 }
 
 // Type check an array type
 void arrayTypeCheck(TypeCheckState *pstate, ArrayNode *node) {
+    // A size given by an expression must be computable now, as an unsigned integer
+    if (node->sizeexp) {
+        inodeTypeCheck(pstate, &node->sizeexp);
+        INode *sizetype = iexpGetTypeDcl(node->sizeexp);
+        char *whynot;
+        INode *size;
+        if (sizetype->tag != IntNbrTag && sizetype->tag != UintNbrTag)
+            errorMsgNode(node->sizeexp, ErrorInvType, "Array size must be an integer");
+        else if ((size = evalConst(pstate, node->sizeexp, &whynot)) == NULL)
+            errorMsgNode(node->sizeexp, ErrorNotLit, "Array size must be computable at compile time, but %s", whynot);
+        else if (((ULitNode *)size)->uintlit >= 0x100000000ull)
+            errorMsgNode(node->sizeexp, ErrorInvType, "Array size must not be negative, and less than 2^32");
+        else
+            node->size = (uint32_t)((ULitNode *)size)->uintlit;
+        node->sizeexp = NULL;
+    }
+
     inodeTypeCheck(pstate, &node->elemtype);
     if (!itypeIsConcrete(node->elemtype)) {
         errorMsgNode((INode*)node, ErrorInvType, "Element's type must be concrete and instantiable.");
@@ -45,10 +71,20 @@ void arrayTypeCheck(TypeCheckState *pstate, ArrayNode *node) {
     // If the element's type if ThreadBound or Move, so is the array's type
     ITypeNode *elemtype = (ITypeNode*)itypeGetTypeDcl(node->elemtype);
     node->flags |= elemtype->flags & (ThreadBound | MoveType);
+
+    // A struct-of-arrays layout needs fields to split up
+    if ((node->flags & SoaLayout) && (elemtype->tag != StructTag || (elemtype->flags & TraitType)))
+        errorMsgNode((INode*)node, ErrorInvType, "An soa array's element type must be a struct.");
+}
+
+// Is this an array of structs stored as one array per field?
+int arrayIsSoa(INode *type) {
+    return type->tag == ArrayTag && (type->flags & SoaLayout);
 }
 
 // Compare two struct signatures to see if they are equivalent
 int arrayEqual(ArrayNode *node1, ArrayNode *node2) {
     return (node1->size == node2->size
+        && (node1->flags & SoaLayout) == (node2->flags & SoaLayout)
         && itypeIsSame(node1->elemtype, node2->elemtype));
 }
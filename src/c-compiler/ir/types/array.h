@@ -13,6 +13,7 @@ typedef struct ArrayNode {
     INsTypeNodeHdr;
     uint32_t size;    // LLVM 5 C-interface is restricted to 32-bits
     INode *elemtype;
+    INode *sizeexp;   // nullable. Constant expression for size, evaluated during type check
 } ArrayNode;
 
 ArrayNode *newArrayNode();
@@ -26,6 +27,9 @@ void arrayNameRes(NameResState *pstate, ArrayNode *node);
 // Type check an array type
 void arrayTypeCheck(TypeCheckState *pstate, ArrayNode *name);
 
+// Is this an array of structs stored as one array per field?
+int arrayIsSoa(INode *type);
+
 int arrayEqual(ArrayNode *node1, ArrayNode *node2);
 
 #endif
\ No newline at end of file
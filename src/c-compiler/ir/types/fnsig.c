@@ -84,7 +84,8 @@ int fnSigVrefEqual(FnSigNode *node1, FnSigNode *node2) {
     // Every parameter's type must also match
     nodes2p = &nodesGet(node2->parms, 0);
     for (nodesFor(node1->parms, cnt, nodes1p)) {
-        if (cnt < node1->parms->used && !itypeIsSame(*nodes1p, *nodes2p))
+        if (cnt < node1->parms->used
+            && !itypeIsSame(((VarDclNode*)*nodes1p)->vtype, ((VarDclNode*)*nodes2p)->vtype))
             return 0;
         nodes2p++;
     }
@@ -233,6 +233,7 @@ int structVirtRefMatches(StructNode *trait, StructNode *strnode) {
     // Create Vtable impl data structure and populate
     VtableImpl *impl = memAllocBlk(sizeof(VtableImpl));
     impl->llvmvtablep = NULL;
+    impl->reached = 0;
     impl->structdcl = (INode*)strnode;
 
     // Construct a global name for this vtable implementation
@@ -16,6 +16,7 @@ typedef struct {
     Nodes *methfld;            // specific methods and fields in same order as vtable
     char *name;                // generated name for the implemented vtable
     LLVMValueRef llvmvtablep;  // generates a pointer to the implemented vtable
+    int reached;               // a reference to the struct is coerced to a virtual reference (so it is generated)
 } VtableImpl;
 
 // Describes the virtual interface supported by some trait/struct
@@ -0,0 +1,13 @@
+/** Handling for SIMD vector types
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#include "../ir.h"
+
+// Serialize a vector type
+void vecTypePrint(VecNode *node) {
+    inodeFprint("%s", &node->namesym->namestr);
+}
@@ -0,0 +1,21 @@
+/** Handling for SIMD vector types
+ * @file
+ *
+ * This source file is part of the Cone Programming Language C compiler
+ * See Copyright Notice in conec.h
+*/
+
+#ifndef vector_h
+#define vector_h
+
+// A fixed number of same-typed number lanes (e.g., f32x4), operated on all at once.
+// Its methods apply number operations elementwise, lowered to LLVM vector instructions.
+typedef struct VecNode {
+    INsTypeNodeHdr;
+    NbrNode *elemtype;  // Number type of every lane
+    uint16_t lanes;     // Number of lanes (a power of two)
+} VecNode;
+
+void vecTypePrint(VecNode *node);
+
+#endif
@@ -1,7 +1,12 @@
 /** Lexer
  * @file
  *
- * The lexer divides up the source program into tokens, producing each for the parser on demand.
+ * The lexer divides up the source program into tokens for the parser.
+ * It scans them in chunks, in a tight loop, into a ring of compact tokens ahead of the parser,
+ * which consumes them one at a time (lexNextToken) and may peek ahead at several (lexPeek).
+ * A file named by an include scanned ahead starts being read (on a worker thread) right away,
+ * and that thread scans the whole file into tokens, which the ring then takes instead of scanning.
+ * Scanning interns no names and reports no problems: both are done as tokens enter the ring.
  * The lexer assumes UTF-8 encoding for the source program.
  *
  * This source file is part of the Cone Programming Language C compiler
@@ -21,34 +26,106 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <assert.h>
 
 // Global lexer state
-Lexer *lex = NULL;        // Current lexer
+lexThreadLocal Lexer *lex = NULL;        // Current lexer
+
+// A problem found while scanning ahead, to be reported when its token enters the ring
+typedef struct LexAheadMsg {
+    char *msg;          // The formatted message (malloc'd)
+    int code;           // Error or warning code
+    uint32_t tokidx;    // Index of the token being scanned when it was found
+    uint32_t srcoff;    // Where it is in the source
+    uint32_t lineoff;   // Start of its line
+    uint32_t linenbr;   // Its line number
+} LexAheadMsg;
+
+// A whole file's tokens, scanned by the file prefetch worker (see lexScanAhead).
+// Its arrays are malloc'd, as the worker must not allocate from the arenas.
+struct LexAhead {
+    LexToken *toks;     // All its tokens, through its EofToken
+    LexAheadMsg *msgs;  // The problems found, in the order found
+    uint32_t ntoks;
+    uint32_t nmsgs;
+    uint32_t next;      // The next token for lexFill to take
+    uint32_t nextmsg;   // The next problem to report
+};
+
+static void lexAheadMsg(int code, const char *msg, ...);
+
+// Report a problem with the source text, unless it was already reported when first lexed.
+// One found while scanning ahead is kept to be reported later.
+#define lexMsg(code, ...) do { \
+    if (lex->flags & LexWorker) lexAheadMsg(code, __VA_ARGS__); \
+    else if (!(lex->flags & LexRelex)) errorMsgLex(code, __VA_ARGS__); \
+} while (0)
+
+#define lexRingSlot(i) (&lex->toks[(i) & (LEX_TOKEN_RING - 1)])
+
+void lexDecodeString(char *srcp);
+
+// Save the token just scanned into a ring slot
+static void lexSaveToken(LexToken *tok) {
+    tok->val = lex->val;
+    tok->srcoff = (uint32_t)(lex->tokp - lex->source);
+    tok->toktype = lex->toktype;
+    tok->stmtbeg = lex->nbrToksInStmt <= 1;
+    tok->littype = lex->littype;
+}
 
-// Inject a new source stream into the lexer
-void lexInject(char *url, char *src) {
-    Lexer *prev;
+// Get the type node for a number literal's type
+static INode *lexLitType(int littype) {
+    switch (littype) {
+    case LexLitI8: return (INode*)i8Type;
+    case LexLitI16: return (INode*)i16Type;
+    case LexLitI64: return (INode*)i64Type;
+    case LexLitIsize: return (INode*)isizeType;
+    case LexLitU32: return (INode*)u32Type;
+    case LexLitU8: return (INode*)u8Type;
+    case LexLitU16: return (INode*)u16Type;
+    case LexLitU64: return (INode*)u64Type;
+    case LexLitUsize: return (INode*)usizeType;
+    case LexLitF32: return (INode*)f32Type;
+    case LexLitF64: return (INode*)f64Type;
+    default: return (INode*)i32Type;
+    }
+}
 
-    // Obtain next lexer block via link chain or allocation
-    prev = lex;
-    if (lex == NULL)
-        lex = (Lexer*) memAllocBlk(sizeof(Lexer));
-    else if (lex->next == NULL) {
-        lex->next = (Lexer*) memAllocBlk(sizeof(Lexer));
-        lex = lex->next;
+// Make a ring slot's token the current one. Its line is found by counting the lines
+// from the current token to it, and a string literal's text is decoded now.
+static void lexLoadToken(LexToken *tok) {
+    char *tokp = lex->source + tok->srcoff;
+    char *srcp = lex->tokp;
+    char *nl;
+    while ((nl = memchr(srcp, '\n', tokp - srcp))) {
+        lex->linep = srcp = nl + 1;
+        lex->linenbr++;
     }
+    lex->tokp = tokp;
+    lex->val = tok->val;
+    lex->toktype = tok->toktype;
+    lex->stmtbeg = tok->stmtbeg;
+    if (tok->toktype == StrLitToken)
+        lexDecodeString(tokp);
     else
-        lex = lex->next; // Re-use an old lexer block
-    lex->next = NULL;
-    lex->prev = prev;
+        lex->langtype = lexLitType(tok->littype);
+}
 
+// Empty a new lexer's ring, with the scanner starting where the current token is
+static void lexRingInit() {
+    lex->toktype = EofToken;
+    lex->tokhead = lex->toktail = 0;
+    lex->scanlinep = lex->linep;
+    lex->scanlinenbr = lex->linenbr;
+}
+
+// Start the current lexer scanning a source text from its beginning
+static void lexStart(char *src) {
     // Skip over UTF8 Byte-order mark (BOM = U+FEFF) at start of source, if there
     if (*src=='\xEF' && *(src+1)=='\xBB' && *(src+2)=='\xBF')
         src += 3;
-
-    // Initialize lexer's source info
-    lex->url = url;
-    lex->fname = fileName(url);
     lex->source = src;
 
     // Initialize lexer context
@@ -62,23 +139,89 @@ void lexInject(char *url, char *src) {
     lex->curindent = 0;
     lex->indentlvl = 0;
     lex->indents[0] = 0;
+    lex->ahead = NULL;
+    lexRingInit();
+}
+
+// Inject a new source stream into the lexer, with its tokens if already scanned (else NULL)
+static void lexInjectScanned(char *url, char *src, LexAhead *ahead) {
+    Lexer *prev;
+
+    // Allocate a new lexer block. Nodes keep pointing to the lexer they were parsed from
+    // (e.g., for error messages and debug info), so a block is never re-used for another stream.
+    prev = lex;
+    lex = (Lexer*) memAllocBlk(sizeof(Lexer));
+    if (prev)
+        prev->next = lex;
+    lex->next = NULL;
+    lex->prev = prev;
+
+    // Initialize lexer's source info and context
+    lex->url = url;
+    lex->fname = fileName(url);
+    lexStart(src);
+    lex->ahead = ahead;
 
     // Prime the pump with the first token
     lexNextToken();
 }
 
 // Inject a new source stream into the lexer
-void lexInjectFile(char *url) {
+void lexInject(char *url, char *src) {
+    lexInjectScanned(url, src, NULL);
+}
+
+// Inject a new source stream into the lexer, returning the source file's canonical path
+char *lexInjectFile(char *url) {
     char *src;
     char *fn;
+    char *path;
+    void *scanned;
     timerBegin(LoadTimer);
     // Load specified source file
-    src = fileLoadSrc(lex? lex->url : NULL, url, &fn);
+    src = fileLoadSrc(lex? lex->url : NULL, url, &fn, &path, &scanned);
     if (!src)
         errorExit(ExitNF, "Cannot find or read source file %s", url);
+    if (gIncrActive)
+        incrSrcLoaded(fn, src);
 
     timerBegin(ParseTimer);
-    lexInject(fn, src);
+    lexInjectScanned(fn, src, (LexAhead*)scanned);
+    return path;
+}
+
+// Inject a lexer that re-reads the source from where a node began (e.g., to re-parse a declaration).
+// Nodes it parses point to it, so it is never re-used for another stream. It reports no lexical
+// problems: they were reported when the source was first lexed (and scanning ahead may pass the node's end).
+void lexInjectAt(INode *node) {
+    Lexer *from = node->lexer;
+    Lexer *prev = lex;
+    lex = (Lexer*) memAllocBlk(sizeof(Lexer));
+    lex->next = NULL;
+    lex->prev = prev;
+
+    // Initialize lexer's source info
+    lex->url = from->url;
+    lex->fname = from->fname;
+    lex->source = from->source;
+
+    // Initialize lexer context, with the node's line indentation as the base for the off-side rule
+    lex->srcp = lex->tokp = node->srcp;
+    lex->linep = node->linep;
+    lex->linenbr = node->linenbr;
+    lex->flags = LexRelex;
+    lex->nbrcurly = 0;
+    lex->nbrToksInStmt = 0;
+    lex->indentch = from->indentch;
+    lex->inject = 0;
+    lex->curindent = (int16_t)(node->srcp - node->linep);
+    lex->indentlvl = 0;
+    lex->indents[0] = lex->curindent;
+    lex->ahead = NULL;
+    lexRingInit();
+
+    // Prime the pump with the first token
+    lexNextToken();
 }
 
 // Restore previous lexer's stream
@@ -99,7 +242,7 @@ char *lexHexDigits(int cnt, char *srcp, uint64_t *val) {
         else if (*srcp>='a' && *srcp<='f')
             *val += *srcp++ - ('a' - 10);
         else {
-            errorMsgLex(ErrorBadTok, "Invalid hexadecimal character '%c'", *srcp);
+            lexMsg(ErrorBadTok, "Invalid hexadecimal character '%c'", *srcp);
             return srcp;
         }
     }
@@ -124,7 +267,7 @@ char *lexScanEscape(char *srcp, uint64_t *charval) {
     case 'u': return lexHexDigits(4, ++srcp, charval);
     case 'U': return lexHexDigits(8, ++srcp, charval);
     default:
-        errorMsgLex(ErrorBadTok, "Invalid escape sequence '%c'", *srcp);
+        lexMsg(ErrorBadTok, "Invalid escape sequence '%c'", *srcp);
         *charval = *srcp++;
         return srcp;
     }
@@ -141,7 +284,7 @@ void lexScanChar(char *srcp) {
             ++srcp;
         // Accept it if next char is non-single quote punctuation
         if (*srcp != '\'' && !(*srcp & 0x80)) {
-            lex->val.ident = nametblFind(srcbeg, srcp - srcbeg);
+            lex->val.uintlit = srcp - srcbeg;    // Interned by lexIntern
             lex->toktype = LifetimeToken;
             lex->srcp = srcp;
             return;
@@ -161,11 +304,11 @@ void lexScanChar(char *srcp) {
     {
         srcp++;
         if (*srcp == 'u') {
-            lex->langtype = (INode*)u32Type;
+            lex->littype = LexLitU32;
             srcp++;
         }
         else
-            lex->langtype = lex->val.uintlit >= 0x100 ? (INode*)u32Type : (INode*)u8Type;
+            lex->littype = lex->val.uintlit >= 0x100 ? LexLitU32 : LexLitU8;
         lex->toktype = IntLitToken;
         lex->srcp = srcp;
         return;
@@ -179,33 +322,43 @@ void lexScanChar(char *srcp) {
         }
         ++srcp;
     }
-    errorMsgLex(ErrorBadTok, "Invalid lifetime or too-long character literal");
-    lex->langtype = (INode*)u8Type;
+    lexMsg(ErrorBadTok, "Invalid lifetime or too-long character literal");
+    lex->littype = LexLitU8;
     lex->toktype = IntLitToken;
     lex->srcp = srcp;
 }
 
+// Scan to the end of a string literal. Its text is decoded when it becomes the current token.
 void lexScanString(char *srcp) {
-    uint64_t uchar;
     lex->tokp = srcp++;
-
-    // Conservatively count the size of the string
-    uint32_t srclen = 0;
     while (*srcp && *srcp != '"') {
-        srclen++;
+        if (*srcp == '\\' && *(srcp + 1))
+            srcp++;
         srcp++;
-        if (*srcp == '\\' && *(srcp + 1) == '"') {
-            srclen++;
-            srcp += 2;
-        }
+    }
+    if (*srcp == '"')
+        srcp++;
+    lex->toktype = StrLitToken;
+    lex->srcp = srcp;
+}
+
+// Decode the string literal at srcp (its opening quote) as the current token's value and type
+void lexDecodeString(char *srcp) {
+    uint64_t uchar;
+
+    // Find the closing quote. Decoding never lengthens the text, so that is enough to allocate.
+    char *endp = ++srcp;
+    while (*endp && *endp != '"') {
+        if (*endp == '\\' && *(endp + 1))
+            endp++;
+        endp++;
     }
 
     // Build string literal
-    char *newp = memAllocStr(NULL, srclen);
-    srclen = 0;
+    char *newp = memAllocStr(NULL, endp - srcp);
+    uint32_t srclen = 0;
     lex->val.strlit = newp;
-    srcp = lex->tokp+1;
-    while (*srcp != '"') {
+    while (srcp < endp) {
         if (*srcp == '\\')
             srcp = lexScanEscape(srcp, &uchar);
         else
@@ -234,12 +387,9 @@ void lexScanString(char *srcp) {
         }
     }
     *newp = '\0';
-    srcp++;
     srclen++;
 
     lex->langtype = (INode*)newArrayNodeTyped(srclen, (INode*)u8Type);
-    lex->toktype = StrLitToken;
-    lex->srcp = srcp;
 }
 
 /** Tokenize an integer or floating point number */
@@ -301,45 +451,45 @@ void lexScanNumber(char *srcp) {
     if (*srcp=='d') {
         isFloat = 'd';
         srcp++;
-        lex->langtype = (INode*)f64Type;
+        lex->littype = LexLitF64;
     } else if (*srcp=='f') {
         isFloat = 'f';
-        lex->langtype = (INode*)f32Type;
+        lex->littype = LexLitF32;
         if (*(++srcp)=='6' && *(srcp+1)=='4') {
-            lex->langtype = (INode*)f64Type;
+            lex->littype = LexLitF64;
             srcp += 2;
         }
         else if (*srcp=='3' && *(srcp+1)=='2')
             srcp += 2;
     } else if (*srcp=='i') {
-        lex->langtype = (INode*)i32Type;
+        lex->littype = LexLitI32;
         if (*(++srcp)=='8') {        
-            srcp++; lex->langtype = (INode*)i8Type;
+            srcp++; lex->littype = LexLitI8;
         } else if (*srcp=='1' && *(srcp+1)=='6') {
-            srcp += 2; lex->langtype = (INode*)i16Type;
+            srcp += 2; lex->littype = LexLitI16;
         } else if (*srcp=='3' && *(srcp+1)=='2') {
             srcp += 2;
         } else if (*srcp=='6' && *(srcp+1)=='4') {
-            srcp += 2; lex->langtype = (INode*)i64Type;
+            srcp += 2; lex->littype = LexLitI64;
         } else if (strncmp(srcp, "size", 4)==0) {
-            srcp += 4; lex->langtype = (INode*)isizeType;
+            srcp += 4; lex->littype = LexLitIsize;
         }
     } else if (*srcp=='u') {
-        lex->langtype = (INode*)u32Type;
+        lex->littype = LexLitU32;
         if (*(++srcp)=='8') {        
-            srcp++; lex->langtype = (INode*)u8Type;
+            srcp++; lex->littype = LexLitU8;
         } else if (*srcp=='1' && *(srcp+1)=='6') {
-            srcp += 2; lex->langtype = (INode*)u16Type;
+            srcp += 2; lex->littype = LexLitU16;
         } else if (*srcp=='3' && *(srcp+1)=='2') {
             srcp += 2;
         } else if (*srcp=='6' && *(srcp+1)=='4') {
-            srcp += 2; lex->langtype = (INode*)u64Type;
+            srcp += 2; lex->littype = LexLitU64;
         } else if (strncmp(srcp, "size", 4)==0) {
-            srcp += 4; lex->langtype = (INode*)usizeType;
+            srcp += 4; lex->littype = LexLitUsize;
         }
     }
     else
-        lex->langtype = (INode*)(isFloat ? f32Type : i32Type);
+        lex->littype = isFloat ? LexLitF32 : LexLitI32;
 
     // Set value and type
     if (isFloat) {
@@ -382,17 +532,10 @@ void lexScanIdent(char *srcp) {
             if (utf8IsLetter(srcp))
                 srcp += utf8ByteSkip(srcp);
             else {
-                INode *identNode;
-                // Find identifier token in name table and preserve info about it
-                // Substitute token type when identifier is a keyword
-                lex->val.ident = nametblFind(srcbeg, srcp-srcbeg);
-                identNode = (INode*)lex->val.ident->node;
-                if (identNode && identNode->tag == KeywordTag)
-                    lex->toktype = identNode->flags;
-                else if (identNode && identNode->tag == PermTag)
-                    lex->toktype = PermToken;
-                else
-                    lex->toktype = IdentToken;
+                // Keep the name's length: lexIntern finds it in the name table
+                // (and substitutes the token type when it is a keyword)
+                lex->val.uintlit = srcp - srcbeg;
+                lex->toktype = IdentToken;
                 lex->srcp = srcp;
                 return;
             }
@@ -409,12 +552,12 @@ void lexScanTickedIdent(char *srcp) {
     while (*srcp != '`' && *srcp && *srcp != '\n' && *srcp != '\x1a')
         srcp++;
     if (*srcp != '`') {
-        errorMsgLex(ErrorBadTok, "Back-ticked identifier requires closing backtick");
+        lexMsg(ErrorBadTok, "Back-ticked identifier requires closing backtick");
         srcp = srcbeg + 2;
     }
 
-    // Find identifier token in name table and preserve info about it
-    lex->val.ident = nametblFind(srcbeg+1, srcp - srcbeg - 1);
+    // Keep the name's length (after the backtick): lexIntern finds it in the name table
+    lex->val.uintlit = srcp - srcbeg - 1;
     lex->toktype = IdentToken;
     lex->srcp = srcp+1;
 }
@@ -464,8 +607,15 @@ char *lexBlockComment(char *srcp) {
 int lexInjectToken() {
     // Inject '{' if indentation increases
     if (lex->curindent > lex->indents[lex->indentlvl]) {
-        if (lex->indentlvl >= LEX_MAX_INDENTS)
+        if (lex->indentlvl >= LEX_MAX_INDENTS) {
+            // Scanning ahead gives up here: the file is then scanned as it is parsed, which exits
+            if (lex->flags & LexWorker) {
+                lex->flags |= LexAbandon;
+                lex->toktype = EofToken;
+                return 1;
+            }
             errorExit(ExitIndent, "Too many indent levels in source file.");
+        }
         lex->indents[++lex->indentlvl] = lex->curindent;
         lex->inject = 0;
         lex->toktype = LCurlyToken;
@@ -491,7 +641,7 @@ int lexInjectToken() {
 // End of statement is either a semicolon or new line before current token
 int lexIsEndOfStatement() {
     return lex->toktype == SemiToken || lex->toktype == RCurlyToken 
-        || lex->nbrToksInStmt <= 1 || lex->toktype == EofToken;
+        || lex->stmtbeg || lex->toktype == EofToken;
 }
 
 // Decode next token from the source into new lex->token
@@ -661,6 +811,7 @@ void lexNextTokenx() {
             }
 
         case '?': lexReturnPuncTok(QuesToken, 1);
+        case '@': lexReturnPuncTok(AtToken, 1);
         case '[': 
             lex->nbrcurly++;
             lexReturnPuncTok(LBracketToken, 1);
@@ -760,9 +911,9 @@ void lexNextTokenx() {
                         if (*srcp != lex->indentch) {
                             lex->tokp = lex->srcp = srcp;
                             if (*srcp == ' ')
-                                errorMsgLex(WarnIndent, "Inconsistent indentation - using space where tab is expected.");
+                                lexMsg(WarnIndent, "Inconsistent indentation - using space where tab is expected.");
                             else
-                                errorMsgLex(WarnIndent, "Inconsistent indentation - using tab where space is expected.");
+                                lexMsg(WarnIndent, "Inconsistent indentation - using tab where space is expected.");
                         }
                         srcp++;
                         lex->curindent++;
@@ -800,15 +951,217 @@ void lexNextTokenx() {
         default:
             {
                 lex->tokp = srcp;
-                errorMsgLex(ErrorBadTok, "Bad character '%c' starting unknown token", *srcp);
+                lexMsg(ErrorBadTok, "Bad character '%c' starting unknown token", *srcp);
                 srcp += utf8ByteSkip(srcp);
             }
         }
     }
 }
 
-void lexNextToken() {
+#define lexIsFileName(toktype) ((toktype) == StrLitToken || (toktype) == IdentToken)
+
+// Start reading the file named by a scanned token on the worker thread.
+// A quoted name is not decoded yet, so one with escapes is left to be read when included.
+static void lexPrefetchName(LexToken *tok) {
+    if (tok->toktype == IdentToken) {
+        filePrefetchSrc(lex->url, &tok->val.ident->namestr);
+        return;
+    }
+    char *namep = lex->source + tok->srcoff + 1;
+    size_t len = strcspn(namep, "\\\"\n");
+    if (namep[len] == '"')
+        filePrefetchSrc(lex->url, memAllocStr(namep, len));
+}
+
+// Start reading a source file on the worker thread, as soon as the token just scanned shows
+// that it will be loaded: the name after 'include', or the end of a 'mod name' statement
+// (a module without a block of its own is read from its file)
+static void lexPrefetch() {
+    LexToken *tok = lexRingSlot(lex->toktail - 1);
+    LexToken *prev = lexRingSlot(lex->toktail - 2);
+    if (lexIsFileName(tok->toktype) && lex->toktail >= 2 && prev->toktype == IncludeToken)
+        lexPrefetchName(tok);
+    else if (tok->toktype == SemiToken && lex->toktail >= 3 && lexIsFileName(prev->toktype)
+        && lexRingSlot(lex->toktail - 3)->toktype == ModToken)
+        lexPrefetchName(prev);
+}
+
+// Find a scanned identifier or lifetime in the name table (its value holds the name's length).
+// Substitute the token type when an identifier (not back-ticked) is a keyword.
+static void lexIntern(LexToken *tok) {
+    char *namep = lex->source + tok->srcoff;
+    size_t len = (size_t)tok->val.uintlit;
+    if (*namep == '`') {
+        tok->val.ident = nametblFind(namep + 1, len);
+        return;
+    }
+    tok->val.ident = nametblFind(namep, len);
+    if (tok->toktype != IdentToken)
+        return;
+    INode *identNode = (INode*)tok->val.ident->node;
+    if (identNode && identNode->tag == KeywordTag)
+        tok->toktype = identNode->flags;
+    else if (identNode && identNode->tag == PermTag)
+        tok->toktype = PermToken;
+}
+
+// Keep a problem found while scanning ahead (at the scanner's token) to be reported later
+static void lexAheadMsg(int code, const char *msg, ...) {
+    LexAhead *ahead = lex->ahead;
+    if ((ahead->nmsgs & (ahead->nmsgs - 1)) == 0 && ahead->nmsgs >= 8) {
+        LexAheadMsg *msgs = (LexAheadMsg*)realloc(ahead->msgs, 2 * ahead->nmsgs * sizeof(LexAheadMsg));
+        if (msgs == NULL)
+            return;
+        ahead->msgs = msgs;
+    }
+    char buf[512];
+    va_list argptr;
+    va_start(argptr, msg);
+    vsnprintf(buf, sizeof(buf), msg, argptr);
+    va_end(argptr);
+    char *msgcopy = (char*)malloc(strlen(buf) + 1);
+    if (msgcopy == NULL)
+        return;
+    strcpy(msgcopy, buf);
+
+    LexAheadMsg *aheadmsg = &ahead->msgs[ahead->nmsgs++];
+    aheadmsg->msg = msgcopy;
+    aheadmsg->code = code;
+    aheadmsg->tokidx = ahead->ntoks;
+    aheadmsg->srcoff = (uint32_t)(lex->tokp - lex->source);
+    aheadmsg->lineoff = (uint32_t)(lex->linep - lex->source);
+    aheadmsg->linenbr = lex->linenbr;
+}
+
+// Free a file's tokens scanned ahead
+static void lexAheadFree(void *scanned) {
+    LexAhead *ahead = (LexAhead*)scanned;
+    uint32_t i;
+    for (i = ahead->nextmsg; i < ahead->nmsgs; i++)
+        free(ahead->msgs[i].msg);
+    free(ahead->msgs);
+    free(ahead->toks);
+    free(ahead);
+}
+
+// Scan a whole source file into tokens, on the file prefetch worker thread.
+// Return NULL if there is no memory for them (the file is then scanned as it is parsed).
+static void *lexScanAhead(char *src) {
+    Lexer scanner;
+    LexAhead *ahead = (LexAhead*)malloc(sizeof(LexAhead));
+    if (ahead == NULL)
+        return NULL;
+    uint32_t avail = (uint32_t)(strlen(src) >> 2) + 16;
+    ahead->toks = (LexToken*)malloc(avail * sizeof(LexToken));
+    ahead->msgs = (LexAheadMsg*)malloc(8 * sizeof(LexAheadMsg));
+    ahead->ntoks = ahead->nmsgs = ahead->next = ahead->nextmsg = 0;
+
+    lex = &scanner;
+    lexStart(src);
+    lex->flags = LexWorker;
+    lex->ahead = ahead;
+    while (ahead->toks && ahead->msgs) {
+        if (ahead->ntoks == avail) {
+            LexToken *toks = (LexToken*)realloc(ahead->toks, 2 * avail * sizeof(LexToken));
+            if (toks == NULL)
+                break;
+            ahead->toks = toks;
+            avail <<= 1;
+        }
+        lexNextTokenx();
+        lexSaveToken(&ahead->toks[ahead->ntoks++]);
+        if (lex->toktype == EofToken) {
+            if (lex->flags & LexAbandon)
+                break;
+            lex = NULL;
+            return ahead;
+        }
+    }
+    lex = NULL;
+    lexAheadFree(ahead);
+    return NULL;
+}
+
+// Take the next token scanned ahead into a ring slot, first reporting the problems found before it.
+// After its last token, the scanner is left at the end of the source.
+static void lexTakeAhead(LexToken *tok) {
+    LexAhead *ahead = lex->ahead;
+    while (ahead->nextmsg < ahead->nmsgs && ahead->msgs[ahead->nextmsg].tokidx <= ahead->next) {
+        LexAheadMsg *aheadmsg = &ahead->msgs[ahead->nextmsg++];
+        lex->tokp = lex->source + aheadmsg->srcoff;
+        lex->linep = lex->source + aheadmsg->lineoff;
+        lex->linenbr = aheadmsg->linenbr;
+        errorMsgLex(aheadmsg->code, "%s", aheadmsg->msg);
+        free(aheadmsg->msg);
+    }
+    *tok = ahead->toks[ahead->next++];
+    if (tok->toktype == EofToken) {
+        lex->srcp = lex->source + tok->srcoff;
+        lexAheadFree(ahead);
+        lex->ahead = NULL;
+    }
+}
+
+// Set up the lexer: the file prefetch worker scans each file it reads ahead into tokens
+void lexInit() {
+    filePrefetchScanner(lexScanAhead, lexAheadFree);
+}
+
+// Scan tokens into the ring until it is full (or the source ends), or take them from those scanned ahead.
+// The scanner works in lex's token fields (resuming from where it stopped),
+// so the current token's are set aside meanwhile.
+static void lexFill() {
     timerBegin(LexTimer);
-    lexNextTokenx();
+    LexVal val = lex->val;
+    INode *langtype = lex->langtype;
+    char *tokp = lex->tokp;
+    char *linep = lex->linep;
+    uint32_t linenbr = lex->linenbr;
+    uint16_t toktype = lex->toktype;
+    uint16_t stmtbeg = lex->stmtbeg;
+    lex->linep = lex->scanlinep;
+    lex->linenbr = lex->scanlinenbr;
+
+    uint32_t start = lex->toktail;
+    while (lex->toktail - lex->tokhead < LEX_TOKEN_RING - 1) {
+        LexToken *tok = lexRingSlot(lex->toktail++);
+        if (lex->ahead)
+            lexTakeAhead(tok);
+        else {
+            lexNextTokenx();
+            lexSaveToken(tok);
+        }
+        if (tok->toktype == IdentToken || tok->toktype == LifetimeToken)
+            lexIntern(tok);
+        lexPrefetch();
+        if (tok->toktype == EofToken)
+            break;
+    }
+    gStats.tokens += lex->toktail - start;
+
+    lex->scanlinep = lex->linep;
+    lex->scanlinenbr = lex->linenbr;
+    lex->val = val;
+    lex->langtype = langtype;
+    lex->tokp = tokp;
+    lex->linep = linep;
+    lex->linenbr = linenbr;
+    lex->toktype = toktype;
+    lex->stmtbeg = stmtbeg;
     timerBegin(ParseTimer);
 }
+
+// Make the next token the current one
+void lexNextToken() {
+    if (lex->tokhead == lex->toktail)
+        lexFill();
+    lexLoadToken(lexRingSlot(lex->tokhead++));
+}
+
+// Return the token n ahead of the current one (1 is the next), without consuming any
+LexToken *lexPeek(uint32_t n) {
+    assert(n < LEX_TOKEN_RING);
+    while (lex->toktail - lex->tokhead < n)
+        lexFill();
+    return lexRingSlot(lex->tokhead + n - 1);
+}
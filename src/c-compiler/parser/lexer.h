@@ -10,20 +10,44 @@
 
 typedef struct INode INode;    // ../ast/ast.h
 typedef struct Name Name;    // ../ast/nametbl.h
+typedef struct LexAhead LexAhead;    // lexer.c
 
 #include <stdint.h>
 
 #define LEX_MAX_INDENTS 1024
+#define LEX_TOKEN_RING 64    // Tokens held by a lexer: its current one, and those scanned ahead (power of 2)
+
+// Value info about a discovered token
+typedef union LexVal {
+    double floatlit;
+    uint64_t uintlit;
+    char *strlit;
+    Name *ident;
+} LexVal;
+
+// The type of a number literal token, as kept in a LexToken
+enum LexLitTypes {
+    LexLitI32, LexLitI8, LexLitI16, LexLitI64, LexLitIsize,
+    LexLitU32, LexLitU8, LexLitU16, LexLitU64, LexLitUsize,
+    LexLitF32, LexLitF64
+};
+
+// A token scanned ahead of the parser (16 bytes). It keeps only its 32-bit source offset:
+// its line is found from the offset when it becomes the current token, and so is a string
+// literal's value (decoded from the source) and a literal's type (from littype or its length).
+typedef struct LexToken {
+    LexVal val;         // A number literal's value or an identifier's name (unused for a string).
+                        // As scanned, an identifier's or lifetime's holds its length, until it is interned.
+    uint32_t srcoff;    // Start of the token
+    uint16_t toktype;   // TokenTypes
+    uint8_t stmtbeg;    // Non-zero if the token begins a statement (see lexIsEndOfStatement)
+    uint8_t littype;    // A number literal's type (LexLitTypes)
+} LexToken;
 
 // Lexer state (one per source file)
 typedef struct Lexer {
-    // Value info about a discovered token
-    union {
-        double floatlit;
-        uint64_t uintlit;
-        char *strlit;
-        Name *ident;
-    } val;
+    // Value info about the current token
+    LexVal val;
     INode *langtype;
 
     // immutable info about source
@@ -40,8 +64,21 @@ typedef struct Lexer {
     char *linep;    // Pointer to start of current line
 
     uint32_t linenbr;    // Current line number
-    uint32_t flags;        // Lexer flags
+    uint32_t flags;        // Lexer flags (LexRelex, LexWorker, LexAbandon)
     uint16_t toktype;    // TokenTypes
+    uint16_t stmtbeg;    // Non-zero if the current token begins a statement
+    uint8_t littype;     // Type of the number literal just scanned (LexLitTypes)
+
+    // Where the scanner is, ahead of the current token: the start of its line, and the line's number
+    char *scanlinep;
+    uint32_t scanlinenbr;
+
+    // Ring of tokens, scanned in chunks ahead of the parser. The slot before tokhead
+    // holds the current token; tokhead up to toktail are the tokens after it.
+    LexToken toks[LEX_TOKEN_RING];
+    uint32_t tokhead;    // Next token to give the parser (indexes wrap around the ring)
+    uint32_t toktail;    // Where the next scanned token goes
+    LexAhead *ahead;     // The whole file's tokens, if scanned by the file prefetch worker (else NULL)
 
     // ** Off-side rule state -->
     // if nbrcurly > 0, offside rule is turned off
@@ -55,6 +92,11 @@ typedef struct Lexer {
     char inject;        // non-zero if we need to inject tokens
 } Lexer;
 
+// Lexer flags
+#define LexRelex 0x0001     // Re-reading source already lexed (and diagnosed), e.g., a generic's
+#define LexWorker 0x0002    // Scanning a whole file on the file prefetch worker (problems are reported later)
+#define LexAbandon 0x0004   // Scanning ahead gave up (the file is scanned again as it is parsed)
+
 // All the possible types for a token
 enum TokenTypes {
     EofToken,        // End-of-file
@@ -91,6 +133,7 @@ enum TokenTypes {
     CaretToken,            // '^'
     NotToken,            // '!'
     QuesToken,          // '?'
+    AtToken,            // '@'
     TildeToken,            // '~'
     AssgnToken,            // '='
     IsToken,            // 'is'
@@ -149,16 +192,31 @@ enum TokenTypes {
     NbrTokens
 };
 
-// Current lexer
-Lexer *lex;
+// conec is an executable, so its thread-local variables can use the cheapest (local-exec) access
+#if defined(_MSC_VER)
+#define lexThreadLocal __declspec(thread)
+#else
+#define lexThreadLocal _Thread_local __attribute__((tls_model("local-exec")))
+#endif
+
+// Current lexer. Each thread has its own: the file prefetch worker scans files with one.
+extern lexThreadLocal Lexer *lex;
 
 #define lexIsToken(tok) (lex->toktype == (tok))
+// Is the token n ahead of the current one (n >= 1) of this type?
+#define lexPeekIsToken(n, tok) (lexPeek(n)->toktype == (tok))
 
 // Lexer functions
-void lexInjectFile(char *url);
+void lexInit();
+char *lexInjectFile(char *url);
 void lexInject(char *url, char *src);
+// Inject a lexer that re-reads the source from where a node began (e.g., to re-parse a declaration)
+void lexInjectAt(INode *node);
 void lexPop();
 void lexNextToken();
+// Return the token n ahead of the current one (1 is the next), without consuming any.
+// n must be less than LEX_TOKEN_RING.
+LexToken *lexPeek(uint32_t n);
 int lexIsEndOfStatement();
 
 #endif
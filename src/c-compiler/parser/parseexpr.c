@@ -116,6 +116,14 @@ INode *parseTerm(ParseState *parse) {
 
 // Parse a function/method call argument
 INode *parseArg(ParseState *parse) {
+    // Named argument: a name followed by ':' and its value
+    if (lexIsToken(IdentToken) && lexPeekIsToken(1, ColonToken)) {
+        NamedValNode *arg = newNamedValNode((INode*)newNameUseNode(lex->val.ident));
+        lexNextToken();
+        lexNextToken();
+        arg->val = parseSimpleExpr(parse);
+        return (INode*)arg;
+    }
     INode *arg = parseSimpleExpr(parse);
     if (lexIsToken(ColonToken)) {
         if (arg->tag != NameUseTag)
@@ -15,6 +15,7 @@
 #include "lexer.h"
 
 #include <stdio.h>
+#include <string.h>
 
 INode *parseEach(ParseState *parse, INode *blk, LifetimeNode *life);
 
@@ -148,6 +149,27 @@ void parseBoundMatch(ParseState *parse, IfNode *ifnode, NameUseNode *expnamenode
     nodesAdd(&ifnode->condblk, (INode*)blknode);
 }
 
+// Parse an if condition, and the block it guards.
+// A condition may be preceded by @likely or @unlikely, which flags its block for branch layout.
+void parseIfCondBlk(ParseState *parse, IfNode *ifnode) {
+    uint16_t hint = 0;
+    if (lexIsToken(AtToken)) {
+        lexNextToken();
+        if (lexIsToken(IdentToken) && strcmp(&lex->val.ident->namestr, "likely") == 0)
+            hint = FlagLikely;
+        else if (lexIsToken(IdentToken) && strcmp(&lex->val.ident->namestr, "unlikely") == 0)
+            hint = FlagUnlikely;
+        else
+            errorMsgLex(ErrorBadTok, "Expected @likely or @unlikely in front of a condition");
+        if (lexIsToken(IdentToken))
+            lexNextToken();
+    }
+    nodesAdd(&ifnode->condblk, parseSimpleExpr(parse));
+    INode *blk = parseBlockOrStmt(parse);
+    blk->flags |= hint;
+    nodesAdd(&ifnode->condblk, blk);
+}
+
 // Parse if statement/expression
 INode *parseIf(ParseState *parse) {
     IfNode *ifnode = newIfNode();
@@ -169,8 +191,7 @@ INode *parseIf(ParseState *parse) {
         parseBoundMatch(parse, ifnode, valnamenode, valnode);
     }
     else {
-        nodesAdd(&ifnode->condblk, parseSimpleExpr(parse));
-        nodesAdd(&ifnode->condblk, parseBlockOrStmt(parse));
+        parseIfCondBlk(parse, ifnode);
     }
     while (1) {
         // Process final else clause and break loop
@@ -206,8 +227,7 @@ INode *parseIf(ParseState *parse) {
             parseBoundMatch(parse, ifnode, valnamenode, valnode);
         }
         else {
-            nodesAdd(&ifnode->condblk, parseSimpleExpr(parse));
-            nodesAdd(&ifnode->condblk, parseBlockOrStmt(parse));
+            parseIfCondBlk(parse, ifnode);
         }
     }
     return retnode;
@@ -360,6 +380,76 @@ INode *parseEach(ParseState *parse, INode *innerblk, LifetimeNode *life) {
         parseInsertWhileBreak(innerblk, iter);
         nodesAdd(&outerblk->stmts, (INode*)loopnode);
     }
+
+    // Assemble logic for iterating over a fixed array or array reference, e.g.:
+    // { imm 'each = &arr; mut 'index = 0; while 'index < 'each.len { imm elemname = 'each[index]; 'index++; ... }}
+    // 'each is an array ref (slice) onto the iterable. Because 'index stays below its count,
+    // indexing needs no runtime bounds check. 'each x in &arr' instead binds a borrowed ref to each element.
+    else {
+        BorrowNode *slice;
+        int byref = iter->tag == BorrowTag && !(iter->flags & FlagSuffix);
+        if (byref)
+            slice = (BorrowNode *)iter;
+        else {
+            RefNode *slicetype = newRefNode();
+            slicetype->alloc = voidType;
+            slicetype->perm = NULL;
+            slicetype->pvtype = NULL;
+            slice = newBorrowNode();
+            slice->vtype = (INode*)slicetype;
+            slice->exp = iter;
+            copyNodeLex(slice, iter);
+        }
+        // Borrow as if part of a borrow chain: an array ref is de-referenced, so
+        // borrowing it or a fixed array yields an array ref onto the same elements
+        slice->flags |= FlagSuffix;
+
+        Name *slicename = nametblFind("'each", 5);
+        Name *indexname = nametblFind("'index", 6);
+        VarDclNode *slicedcl = newVarDclNode(slicename, VarDclTag, (INode*)immPerm);
+        slicedcl->value = (INode*)slice;
+        nodesAdd(&outerblk->stmts, (INode*)slicedcl);
+        VarDclNode *indexdcl = newVarDclNode(indexname, VarDclTag, (INode*)mutPerm);
+        indexdcl->value = (INode*)newULitNode(0, (INode*)usizeType);
+        nodesAdd(&outerblk->stmts, (INode*)indexdcl);
+
+        // The element: 'each[index] or &'each[index]
+        FnCallNode *elem;
+        if (byref) {
+            RefNode *elemreftype = newRefNode();
+            elemreftype->alloc = voidType;
+            elemreftype->perm = ((RefNode*)slice->vtype)->perm;
+            elemreftype->pvtype = NULL;
+            BorrowNode *elemref = newBorrowNode();
+            elemref->vtype = (INode*)elemreftype;
+            elemref->exp = (INode*)newNameUseNode(slicename);
+            elemref->flags |= FlagSuffix;
+            elem = newFnCallNode((INode*)elemref, 1);
+            elem->flags |= FlagBorrow;
+        }
+        else
+            elem = newFnCallNode((INode*)newNameUseNode(slicename), 1);
+        elem->flags |= FlagIndex | FlagInBounds;
+        nodesAdd(&elem->args, (INode*)newNameUseNode(indexname));
+        VarDclNode *elemdcl = newVarDclNode(elemname, VarDclTag, (INode*)immPerm);
+        elemdcl->value = (INode*)elem;
+
+        // Advance the index before the loop's statements, so 'continue' cannot skip it
+        INode *incr = (INode *)newFnCallOpname((INode *)newNameUseNode(indexname), incrPostName, 0);
+        nodesInsert(&((BlockNode*)innerblk)->stmts, incr, 0);
+        nodesInsert(&((BlockNode*)innerblk)->stmts, (INode*)elemdcl, 0);
+
+        FnCallNode *count = newFnCallNode((INode*)newNameUseNode(slicename), 0);
+        count->methfld = newMemberUseNode(nametblFind("len", 3));
+        FnCallNode *itercmp = newFnCallOpname((INode*)newNameUseNode(indexname), ltName, 1);
+        nodesAdd(&itercmp->args, (INode*)count);
+        // Errors on these injected nodes should point to the iterable
+        copyNodeLex(count, iter);
+        copyNodeLex(itercmp, iter);
+        copyNodeLex(elem, iter);
+        parseInsertWhileBreak(innerblk, (INode*)itercmp);
+        nodesAdd(&outerblk->stmts, (INode*)loopnode);
+    }
     return (INode *)outerblk;
 }
 
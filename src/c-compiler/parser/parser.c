@@ -69,11 +69,51 @@ void parseCloseTok(uint16_t closetok) {
     lexNextToken();
 }
 
+// Parse the attributes (e.g., @inline @hot) in front of a function
+uint16_t parseFnAttrs() {
+    uint16_t attrs = 0;
+    while (lexIsToken(AtToken)) {
+        lexNextToken();
+        if (!lexIsToken(IdentToken)) {
+            errorMsgLex(ErrorNoIdent, "Expected an attribute name after '@'");
+            continue;
+        }
+        char *attrname = &lex->val.ident->namestr;
+        uint16_t attr = 0;
+        if (strcmp(attrname, "inline") == 0) attr = FnAttrInline;
+        else if (strcmp(attrname, "noinline") == 0) attr = FnAttrNoInline;
+        else if (strcmp(attrname, "hot") == 0) attr = FnAttrHot;
+        else if (strcmp(attrname, "cold") == 0) attr = FnAttrCold;
+        else if (strcmp(attrname, "pure") == 0) attr = FnAttrPure;
+        else if (strcmp(attrname, "readonly") == 0) attr = FnAttrReadOnly;
+        else if (strcmp(attrname, "noreturn") == 0) attr = FnAttrNoReturn;
+        else if (strcmp(attrname, "multiversion") == 0) attr = FnAttrMultiversion;
+        else
+            errorMsgLex(ErrorBadTok, "Unknown function attribute @%s", attrname);
+        attrs |= attr;
+        if ((attrs & (FnAttrInline | FnAttrNoInline)) == (FnAttrInline | FnAttrNoInline)
+            || (attrs & (FnAttrHot | FnAttrCold)) == (FnAttrHot | FnAttrCold)) {
+            errorMsgLex(ErrorBadTok, "Attribute @%s contradicts an earlier attribute", attrname);
+            attrs &= ~attr;
+        }
+        lexNextToken();
+        // Attributes may be on their own line(s), above the function
+        while (lexIsToken(SemiToken))
+            lexNextToken();
+    }
+    return attrs;
+}
+
 // Parse a function block
 INode *parseFn(ParseState *parse, uint16_t nodeflags, uint16_t mayflags) {
     FnDclNode *fnnode;
+    Name *instname = parse->instname;
+    Nodes *genparms = NULL;
+    parse->instname = NULL;
 
     fnnode = newFnDclNode(NULL, nodeflags, NULL, NULL);
+    fnnode->attrs = parse->fnattrs;
+    parse->fnattrs = 0;
 
     // Skip past the 'fn'
     lexNextToken();
@@ -82,7 +122,7 @@ INode *parseFn(ParseState *parse, uint16_t nodeflags, uint16_t mayflags) {
     if (lexIsToken(IdentToken)) {
         if (!(mayflags&ParseMayName))
             errorMsgLex(WarnName, "Unnecessary function name is ignored");
-        fnnode->namesym = lex->val.ident;
+        fnnode->namesym = instname? instname : lex->val.ident;
         fnnode->genname = &fnnode->namesym->namestr;
         lexNextToken();
     }
@@ -91,6 +131,15 @@ INode *parseFn(ParseState *parse, uint16_t nodeflags, uint16_t mayflags) {
             errorMsgLex(ErrorNoName, "Function declarations must be named");
     }
 
+    // Process a generic function's type parameters (ignored when re-parsed as an instance)
+    if (lexIsToken(LBracketToken)) {
+        if (!(mayflags&ParseMayGeneric))
+            errorMsgLex(ErrorBadTok, "Only global functions and structs may have type parameters");
+        genparms = parseGenericParms(parse);
+        if (instname || !(mayflags&ParseMayGeneric))
+            genparms = NULL;
+    }
+
     // Process the function's signature info.
     fnnode->vtype = parseFnSig(parse);
 
@@ -108,6 +157,8 @@ INode *parseFn(ParseState *parse, uint16_t nodeflags, uint16_t mayflags) {
         parseEndOfStatement();
     }
 
+    if (genparms)
+        return (INode*)newGenericNode((INode*)fnnode, genparms, parse->mod, parse->gennamePrefix);
     return (INode*) fnnode;
 }
 
@@ -132,6 +183,29 @@ char *parseFile() {
 
 void parseGlobalStmts(ParseState *parse, ModuleNode *mod);
 
+// Remember a source file (by canonical path) as included into a module.
+// Return 1 if it already was: including it again would only duplicate its declarations.
+// A file without a known path is never taken to have been included.
+int parseIncludeOnce(ParseState *parse, ModuleNode *mod, char *path) {
+    if (path == NULL)
+        return 0;
+    uint32_t i;
+    for (i = 0; i < parse->includedUsed; i++) {
+        if (parse->included[i].mod == mod && strcmp(parse->included[i].path, path) == 0)
+            return 1;
+    }
+    if (parse->includedUsed >= parse->includedAvail) {
+        ParseIncluded *oldincluded = parse->included;
+        parse->includedAvail = parse->includedAvail == 0 ? 16 : parse->includedAvail << 1;
+        parse->included = (ParseIncluded *)memAllocBlk(parse->includedAvail * sizeof(ParseIncluded));
+        if (oldincluded)
+            memcpy(parse->included, oldincluded, parse->includedUsed * sizeof(ParseIncluded));
+    }
+    parse->included[parse->includedUsed].mod = mod;
+    parse->included[parse->includedUsed++].path = path;
+    return 0;
+}
+
 // Parse include statement
 void parseInclude(ParseState *parse) {
     char *filename;
@@ -139,7 +213,11 @@ void parseInclude(ParseState *parse) {
     filename = parseFile();
     parseEndOfStatement();
 
-    lexInjectFile(filename);
+    char *path = lexInjectFile(filename);
+    if (parseIncludeOnce(parse, parse->mod, path)) {
+        lexPop();
+        return;
+    }
     parseGlobalStmts(parse, parse->mod);
     if (lex->toktype != EofToken) {
         errorMsgLex(ErrorNoEof, "Expected end-of-file");
@@ -152,7 +230,11 @@ void parseInclude(ParseState *parse) {
 void parseFnOrVar(ParseState *parse, uint16_t flags) {
 
     if (lexIsToken(FnToken)) {
-        FnDclNode *node = (FnDclNode*)parseFn(parse, 0, (flags&FlagExtern)? (ParseMayName | ParseMaySig) : (ParseMayName | ParseMayImpl));
+        FnDclNode *node = (FnDclNode*)parseFn(parse, 0, (flags&FlagExtern)? (ParseMayName | ParseMaySig) : (ParseMayName | ParseMayImpl | ParseMayGeneric));
+        if (node->tag == GenericTag) {
+            modAddNode(parse->mod, ((GenericNode*)node)->namesym, (INode*)node);
+            return;
+        }
         node->flags |= flags;
         nameGenVarName((VarDclNode *)node, parse->gennamePrefix);
         modAddNode(parse->mod, node->namesym, (INode*)node);
@@ -179,8 +261,14 @@ ModuleNode *parseModule(ParseState *parse);
 // Parse a global area statement (within a module)
 // modAddNode adds node to module, as needed, including error message for dupes
 void parseGlobalStmts(ParseState *parse, ModuleNode *mod) {
+    // For incremental re-analysis, record the source text of the program's declarations
+    IncrSpan span;
+    int incrspan = gIncrActive && mod == parse->pgmmod;
+
     // Create and populate a Module node for the program
     while (!lexIsToken(EofToken) && !lexIsToken(RCurlyToken)) {
+        if (incrspan)
+            incrSpanBegin(&span, mod);
         switch (lex->toktype) {
 
         case IncludeToken:
@@ -196,7 +284,10 @@ void parseGlobalStmts(ParseState *parse, ModuleNode *mod) {
         // 'struct'-style type definition
         case StructToken: {
             StructNode *strnode = (StructNode*)parseStruct(parse, 0);
-            modAddNode(mod, strnode->namesym, (INode*)strnode);
+            if (strnode->tag == GenericTag)
+                modAddNode(mod, ((GenericNode*)strnode)->namesym, (INode*)strnode);
+            else
+                modAddNode(mod, strnode->namesym, (INode*)strnode);
             break;
         }
 
@@ -218,6 +309,12 @@ void parseGlobalStmts(ParseState *parse, ModuleNode *mod) {
         case ExternToken:
         {
             lexNextToken();
+            // 'extern struct' keeps C layout: fields are never reordered
+            if (lexIsToken(StructToken)) {
+                StructNode *strnode = (StructNode*)parseStruct(parse, CLayout);
+                modAddNode(mod, strnode->namesym, (INode*)strnode);
+                break;
+            }
             uint16_t extflag = FlagExtern;
             if (lexIsToken(IdentToken)) {
                 if (strcmp(&lex->val.ident->namestr, "system")==0)
@@ -242,12 +339,26 @@ void parseGlobalStmts(ParseState *parse, ModuleNode *mod) {
             parseFnOrVar(parse, 0);
             break;
 
+        // Attributes (e.g., @inline) in front of a function
+        case AtToken:
+            parse->fnattrs = parseFnAttrs();
+            if (lexIsToken(FnToken))
+                parseFnOrVar(parse, 0);
+            else {
+                errorMsgLex(ErrorNotFn, "Expected fn declaration after attributes");
+                parse->fnattrs = 0;
+                parseSkipToNextStmt();
+            }
+            break;
+
         default:
             errorMsgLex(ErrorBadGloStmt, "Invalid global area statement");
             lexNextToken();
             parseSkipToNextStmt();
             break;
         }
+        if (incrspan)
+            incrSpanEnd(&span, mod);
     }
 }
 
@@ -295,10 +406,8 @@ ModuleNode *parseModule(ParseState *parse) {
 }
 
 // Parse a program = the main module
+// The name table must already be initialized and populated with std library names
 ModuleNode *parsePgm(ConeOptions *opt) {
-    // Initialize name table and populate with std library names
-    nametblInit();
-    stdlibInit(opt->ptrsize);
     lexInjectFile(opt->srcpath);
 
     ParseState parse;
@@ -308,5 +417,13 @@ ModuleNode *parsePgm(ConeOptions *opt) {
     parse.mod = NULL;
     parse.typenode = NULL;
     parse.gennamePrefix = "";
-    return parseModuleBlk(&parse, mod);
+    parse.instname = NULL;
+    parse.fnattrs = 0;
+    parse.included = NULL;
+    parse.includedUsed = 0;
+    parse.includedAvail = 0;
+    parseIncludeOnce(&parse, mod, lex->url);
+    parseModuleBlk(&parse, mod);
+    lexPop();
+    return mod;
 }
@@ -11,11 +11,22 @@
 #include "../ir/ir.h"
 typedef struct ConeOptions ConeOptions;
 
+// A source file already included into a module
+typedef struct ParseIncluded {
+    ModuleNode *mod;        // Module the file's statements were added to
+    char *path;             // The file's canonical path
+} ParseIncluded;
+
 typedef struct ParseState {
     ModuleNode *pgmmod;     // Root module for program
     ModuleNode *mod;        // Current module
     INsTypeNode *typenode;  // Current type
     char *gennamePrefix;    // Module or type prefix for unique linker names
+    Name *instname;         // Name for the generic instance being re-parsed (or NULL)
+    uint16_t fnattrs;       // Attributes (e.g., @inline) for the next function parsed
+    ParseIncluded *included;    // Source files included so far
+    uint32_t includedUsed;
+    uint32_t includedAvail;
 } ParseState;
 
 // When parsing a variable definition, what syntax is allowed?
@@ -24,13 +35,16 @@ enum ParseFlags {
     ParseMayAnon = 0x4000,        // The variable may be anonymous
     ParseMaySig  = 0x2000,        // The variable may be signature only
     ParseMayImpl = 0x1000,        // The variable may implement a code block
-    ParseMayConst = 0x0800      // const allowed for variable declaration
+    ParseMayConst = 0x0800,     // const allowed for variable declaration
+    ParseMayGeneric = 0x0400    // The function may declare type parameters
 };
 
 // parser.c
 ModuleNode *parsePgm(ConeOptions *opt);
 ModuleNode *parseModuleBlk(ParseState *parse, ModuleNode *mod);
 INode *parseFn(ParseState *parse, uint16_t nodeflags, uint16_t mayflags);
+// Parse the attributes (e.g., @inline @hot) in front of a function
+uint16_t parseFnAttrs();
 void parseEndOfStatement();
 void parseRCurly();
 void parseLCurly();
@@ -57,6 +71,7 @@ void parseAllocPerm(RefNode *refnode);
 VarDclNode *parseVarDcl(ParseState *parse, PermNode *defperm, uint16_t flags);
 INode *parseFnSig(ParseState *parse);
 INode *parseStruct(ParseState *parse, uint16_t flags);
+Nodes *parseGenericParms(ParseState *parse);
 INode *parseVtype(ParseState *parse);
 
 #endif
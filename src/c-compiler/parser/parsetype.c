@@ -123,6 +123,16 @@ INode *parseStruct(ParseState *parse, uint16_t strflags) {
     INsTypeNode *svtype = parse->typenode;
     StructNode *strnode;
     uint16_t fieldnbr = 0;
+    Name *instname = parse->instname;
+    Nodes *genparms = NULL;
+    parse->instname = NULL;
+
+    // Remember where the declaration begins, in case it is generic (and re-parsed for each instance)
+    INode dclpos;
+    dclpos.lexer = lex;
+    dclpos.srcp = lex->tokp;
+    dclpos.linep = lex->linep;
+    dclpos.linenbr = lex->linenbr;
 
     // Capture the kind of type, then get next token (name)
     uint16_t tag = StructTag;
@@ -130,7 +140,7 @@ INode *parseStruct(ParseState *parse, uint16_t strflags) {
 
     // Process struct type name, if provided
     if (lexIsToken(IdentToken)) {
-        strnode = newStructNode(lex->val.ident);
+        strnode = newStructNode(instname? instname : lex->val.ident);
         strnode->tag = tag;
         strnode->flags |= strflags;
         strnode->mod = parse->mod;
@@ -143,6 +153,15 @@ INode *parseStruct(ParseState *parse, uint16_t strflags) {
         return NULL;
     }
 
+    // Process a generic struct's type parameters (ignored when re-parsed as an instance)
+    if (lexIsToken(LBracketToken)) {
+        if (strflags)
+            errorMsgLex(ErrorBadTok, "Only a struct may have type parameters");
+        genparms = parseGenericParms(parse);
+        if (instname || strflags)
+            genparms = NULL;
+    }
+
     uint16_t methflags = ParseMayName | ParseMayImpl;
     if (strnode->flags & TraitType)
         methflags |= ParseMaySig;
@@ -157,6 +176,14 @@ INode *parseStruct(ParseState *parse, uint16_t strflags) {
     if (lexIsToken(LCurlyToken)) {
         lexNextToken();
         while (1) {
+            // Attributes (e.g., @inline) apply to the method that follows
+            if (lexIsToken(AtToken)) {
+                parse->fnattrs = parseFnAttrs();
+                if (!lexIsToken(FnToken) && !lexIsToken(SetToken)) {
+                    errorMsgLex(ErrorNotFn, "Expected fn declaration after attributes");
+                    parse->fnattrs = 0;
+                }
+            }
             if (lexIsToken(SetToken)) {
                 lexNextToken();
                 if (!lexIsToken(FnToken))
@@ -197,9 +224,31 @@ INode *parseStruct(ParseState *parse, uint16_t strflags) {
 
     parse->typenode = svtype;
     parse->gennamePrefix = svprefix;
+    if (genparms) {
+        GenericNode *gen = newGenericNode((INode*)strnode, genparms, parse->mod, svprefix);
+        copyNodeLex(gen, &dclpos);
+        return (INode*)gen;
+    }
     return (INode*)strnode;
 }
 
+// Parse a generic's type parameters, e.g., [T, U]
+Nodes *parseGenericParms(ParseState *parse) {
+    Nodes *parms = newNodes(2);
+    lexNextToken();
+    while (lexIsToken(IdentToken)) {
+        nodesAdd(&parms, (INode*)newNameUseNode(lex->val.ident));
+        lexNextToken();
+        if (!lexIsToken(CommaToken))
+            break;
+        lexNextToken();
+    }
+    if (parms->used == 0)
+        errorMsgLex(ErrorNoIdent, "Expected a type parameter name");
+    parseCloseTok(RBracketToken);
+    return parms;
+}
+
 void parseInjectSelf(FnSigNode *fnsig, Name *typename) {
     NameUseNode *selftype = newNameUseNode(typename);
     VarDclNode *selfparm = newVarDclFull(nametblFind("self", 4), VarDclTag, (INode*)selftype, newPermUseNode(constPerm), NULL);
@@ -282,13 +331,23 @@ INode *parseFnSig(ParseState *parse) {
 INode *parseArrayType(ParseState *parse) {
     ArrayNode *atype = newArrayNode();
 
-    // Obtain size as an unsigned integer literal
-    if (lexIsToken(IntLitToken)) {
-        atype->size = (uint32_t) lex->val.uintlit;
+    // Obtain size as an unsigned integer literal, or else as a constant expression
+    // (evaluated during type check)
+    if (lexIsToken(RBracketToken) || (lexIsToken(IdentToken) && lex->val.ident == nametblFind("soa", 3)))
+        errorMsgLex(ErrorBadTok, "Expected array size");
+    else {
+        INode *size = parseSimpleExpr(parse);
+        if (size && size->tag == ULitTag)
+            atype->size = (uint32_t)((ULitNode *)size)->uintlit;
+        else
+            atype->sizeexp = size;
+    }
+
+    // [N soa]Struct stores the array's structs as one array per field
+    if (lexIsToken(IdentToken) && lex->val.ident == nametblFind("soa", 3)) {
+        atype->flags |= SoaLayout;
         lexNextToken();
     }
-    else
-        errorMsgLex(ErrorBadTok, "Expected integer literal for array size");
 
     if (lexIsToken(RBracketToken))
         lexNextToken();
@@ -396,6 +455,25 @@ INode* parseVtype(ParseState *parse) {
     case IdentToken:
         vtype = (INode*)newNameUseNode(lex->val.ident);
         lexNextToken();
+        // A generic type's arguments, e.g., Pair[i32]
+        if (lexIsToken(LBracketToken)) {
+            FnCallNode *typeuse = newFnCallNode(vtype, 2);
+            typeuse->flags |= FlagIndex;
+            lexNextToken();
+            while (!lexIsToken(RBracketToken)) {
+                INode *typearg = parseVtype(parse);
+                if (typearg == voidType) {
+                    errorMsgLex(ErrorNoVtype, "Expected a type argument");
+                    break;
+                }
+                nodesAdd(&typeuse->args, typearg);
+                if (!lexIsToken(CommaToken))
+                    break;
+                lexNextToken();
+            }
+            parseCloseTok(RBracketToken);
+            vtype = (INode*)typeuse;
+        }
         return vtype;
     default:
         return voidType;
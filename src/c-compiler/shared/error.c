@@ -99,6 +99,12 @@ void errorMsg(int code, const char *msg, ...) {
     va_end(argptr);
 }
 
+// Reset error and warning counts, before compiling another program
+void errorReset() {
+    errors = 0;
+    warnings = 0;
+}
+
 // Generate final message for a compile
 void errorSummary() {
     if (errors > 0)
@@ -79,9 +79,12 @@ enum ErrorCode {
     WarnIndent,        // Inconsistent indent character
     WarnCopy,       // Unsafe attempt to copy a CopyMethod or CopyMove typed value
     WarnLoop,       // Infinite loop with no break
+    WarnProfile,    // Profile data does not fit the code (e.g., source changed since profiling)
+    WarnMultiversion,    // @multiversion is not supported for the target
 };
 
 int errors;
+int warnings;
 
 // Send an error message to stderr
 void errorExit(int exitcode, const char *msg, ...);
@@ -89,5 +92,7 @@ void errorMsgNode(INode *node, int code, const char *msg, ...);
 void errorMsgLex(int code, const char *msg, ...);
 void errorMsg(int code, const char *msg, ...);
 void errorSummary();
+// Reset error and warning counts, before compiling another program
+void errorReset();
 
 #endif
\ No newline at end of file
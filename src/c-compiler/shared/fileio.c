@@ -9,8 +9,16 @@
 #include "memory.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 /** Load a file into an allocated string, return pointer or NULL if not found */
 char *fileLoad(char *fn) {
@@ -107,14 +115,377 @@ char *fileSrcUrl(char *cururl, char *srcfn, int newfolder) {
     return outnm;
 }
 
+// Hash some text (FNV-1a)
+uint64_t fileHash(char *srcp, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    while (len--) {
+        hash ^= (unsigned char)*srcp++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Get the canonical (absolute, resolved) path for an existing file, or NULL if none
+char *fileCanonPath(char *fn) {
+    char *canon;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+    canon = _fullpath(NULL, fn, 0);
+#else
+    canon = realpath(fn, NULL);
+#endif
+    if (canon == NULL)
+        return NULL;
+    char *path = memAllocStr(canon, strlen(canon));
+    free(canon);
+    return path;
+}
+
+// ************************ Source file cache *******************************
+
+// Loaded source files are cached by canonical path, for the compiler's lifetime.
+// A file is only re-read from disk when its modification time or size changes.
+// Every cached source has one canonical path string, which may be compared by pointer.
+typedef struct FileSrc {
+    char *path;         // Canonical path
+    uint64_t pathhash;  // Hash of canonical path
+    char *src;          // Source text
+    uint64_t hash;      // Hash of source text
+    time_t mtime;       // Modification time when last read
+    off_t size;         // File size when last read
+    void *scanned;      // What the worker scanned from src, until fileLoadSrc hands it back
+} FileSrc;
+
+FileSrc **gFileSrcs = NULL;     // Open-addressed table of cached sources
+size_t gFileSrcsAvail = 0;      // Always a power of 2
+size_t gFileSrcsUsed = 0;
+
+// Find the cache slot for a canonical path
+FileSrc **fileSrcSlot(char *path, uint64_t pathhash) {
+    size_t slot = (size_t)pathhash & (gFileSrcsAvail - 1);
+    while (gFileSrcs[slot]) {
+        if (gFileSrcs[slot]->pathhash == pathhash && strcmp(gFileSrcs[slot]->path, path) == 0)
+            break;
+        slot = (slot + 1) & (gFileSrcsAvail - 1);
+    }
+    return &gFileSrcs[slot];
+}
+
+// Double the size of the source cache
+void fileSrcGrow() {
+    FileSrc **oldsrcs = gFileSrcs;
+    size_t oldavail = gFileSrcsAvail;
+    size_t i;
+    gFileSrcsAvail = oldavail == 0 ? 64 : oldavail << 1;
+    gFileSrcs = (FileSrc **)memAllocBlk(gFileSrcsAvail * sizeof(FileSrc*));
+    memset(gFileSrcs, 0, gFileSrcsAvail * sizeof(FileSrc*));
+    for (i = 0; i < oldavail; i++) {
+        if (oldsrcs[i])
+            *fileSrcSlot(oldsrcs[i]->path, oldsrcs[i]->pathhash) = oldsrcs[i];
+    }
+}
+
+// ************************ Source prefetching *******************************
+
+// Source files may be read ahead on a worker thread, as soon as the lexer scans an
+// include (or file-backed module) naming them, so the reading overlaps with parsing what comes before.
+// The worker reads and hashes into a buffer the main thread allocates (from the arena, as fileLoad does)
+// when it queues the file, and then scans it with the registered scanner (the lexer's, into tokens).
+// Neither allocates from the (single-threaded) arenas: the scanner mallocs what it returns.
+// A file read ahead is used by fileSrcLoad only if it is unchanged since it was queued.
+
+#if defined(_WIN32)
+typedef CRITICAL_SECTION FileLock;
+typedef CONDITION_VARIABLE FileCond;
+#define fileLockInit(lock) InitializeCriticalSection(lock)
+#define fileLock(lock) EnterCriticalSection(lock)
+#define fileUnlock(lock) LeaveCriticalSection(lock)
+#define fileCondInit(cond) InitializeConditionVariable(cond)
+#define fileCondWait(cond, lock) SleepConditionVariableCS(cond, lock, INFINITE)
+#define fileCondSignal(cond) WakeAllConditionVariable(cond)
+#else
+typedef pthread_mutex_t FileLock;
+typedef pthread_cond_t FileCond;
+#define fileLockInit(lock) pthread_mutex_init(lock, NULL)
+#define fileLock(lock) pthread_mutex_lock(lock)
+#define fileUnlock(lock) pthread_mutex_unlock(lock)
+#define fileCondInit(cond) pthread_cond_init(cond, NULL)
+#define fileCondWait(cond, lock) pthread_cond_wait(cond, lock)
+#define fileCondSignal(cond) pthread_cond_broadcast(cond)
+#endif
+
+enum FilePrefetchState {
+    PrefetchFree,       // Slot is unused (or its file was taken)
+    PrefetchQueued,     // Waiting for the worker
+    PrefetchReading,    // Being read (and scanned) by the worker
+    PrefetchDone        // Read: src, hash and scanned are ready to take
+};
+
+// A source file to be read ahead. The main thread fills in what to read (before it is queued),
+// the worker what it read (before it is done). Its state is only changed under gFilePrefetchLock.
+typedef struct FilePrefetch {
+    char *path;         // Canonical path
+    uint64_t pathhash;  // Hash of canonical path
+    time_t mtime;       // Modification time when queued
+    off_t size;         // File size when queued
+    char *src;          // Buffer for the source text (size+1 bytes), or NULL if it could not be read
+    uint64_t hash;      // Hash of source text
+    void *scanned;      // What the scanner returned for the source text (or NULL)
+    int state;          // FilePrefetchState
+} FilePrefetch;
+
+#define FilePrefetchSlots 16    // Power of 2
+FilePrefetch gFilePrefetch[FilePrefetchSlots];
+uint32_t gFilePrefetchTail = 0;     // Where the main thread queues the next file
+uint32_t gFilePrefetchNext = 0;     // Where the worker looks for the next queued file
+int gFilePrefetchStarted = 0;       // Has the worker thread been started?
+FileLock gFilePrefetchLock;
+FileCond gFilePrefetchQueued;       // Signalled when a file is queued
+FileCond gFilePrefetchDone;         // Signalled when a file has been read
+void *(*gFilePrefetchScan)(char *src) = NULL;       // Scans a file the worker has read
+void (*gFilePrefetchDrop)(void *scanned) = NULL;    // Frees a scan that is not used
+
+uint32_t gFileSrcReads = 0;         // Source files read from disk
+uint32_t gFilePrefetchUsed = 0;     // ... of which were read ahead
+
+// Read a file of the given size into its buffer. Return 0 if it cannot be read or is no longer that size.
+static int filePrefetchRead(char *path, char *src, size_t size) {
+    FILE *file;
+    if (!(file = fopen(path, "rb")))
+        return 0;
+    // Reading one byte more than expected finds a file that has grown
+    size_t len = fread(src, 1, size + 1, file);
+    fclose(file);
+    src[size] = '\0';
+    return len == size;
+}
+
+// Have the worker thread also scan each source file it reads ahead (e.g., into tokens).
+// fileLoadSrc hands back what scan returns; drop frees one that is not used.
+// Set it up before any file is read ahead.
+void filePrefetchScanner(void *(*scan)(char *src), void (*drop)(void *scanned)) {
+    gFilePrefetchScan = scan;
+    gFilePrefetchDrop = drop;
+}
+
+// Free what the worker scanned from a file that is not used
+static void filePrefetchDropScan(FilePrefetch *pre) {
+    if (pre->scanned)
+        gFilePrefetchDrop(pre->scanned);
+    pre->scanned = NULL;
+}
+
+// The worker: read, hash and scan each queued file, in order
+static void filePrefetchWork() {
+    fileLock(&gFilePrefetchLock);
+    while (1) {
+        while (gFilePrefetchNext == gFilePrefetchTail)
+            fileCondWait(&gFilePrefetchQueued, &gFilePrefetchLock);
+        FilePrefetch *pre = &gFilePrefetch[gFilePrefetchNext++ & (FilePrefetchSlots - 1)];
+        // Skip one the main thread took back (or re-used, to be found again later)
+        if (pre->state != PrefetchQueued)
+            continue;
+        pre->state = PrefetchReading;
+        fileUnlock(&gFilePrefetchLock);
+
+        int read = filePrefetchRead(pre->path, pre->src, (size_t)pre->size);
+        uint64_t hash = read ? fileHash(pre->src, (size_t)pre->size) : 0;
+        void *scanned = read && gFilePrefetchScan ? gFilePrefetchScan(pre->src) : NULL;
+
+        fileLock(&gFilePrefetchLock);
+        if (!read)
+            pre->src = NULL;
+        pre->hash = hash;
+        pre->scanned = scanned;
+        pre->state = PrefetchDone;
+        fileCondSignal(&gFilePrefetchDone);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI filePrefetchThread(LPVOID arg) {
+    filePrefetchWork();
+    return 0;
+}
+#else
+static void *filePrefetchThread(void *arg) {
+    filePrefetchWork();
+    return NULL;
+}
+#endif
+
+// Start the worker thread. Return 0 if it could not be started
+static int filePrefetchStart() {
+    fileLockInit(&gFilePrefetchLock);
+    fileCondInit(&gFilePrefetchQueued);
+    fileCondInit(&gFilePrefetchDone);
+#if defined(_WIN32)
+    HANDLE thread = CreateThread(NULL, 0, filePrefetchThread, NULL, 0, NULL);
+    if (thread == NULL)
+        return 0;
+    CloseHandle(thread);
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, filePrefetchThread, NULL) != 0)
+        return 0;
+    pthread_detach(thread);
+#endif
+    return 1;
+}
+
+// Start reading a source file on the worker thread, ahead of fileLoadSrc (given the same names).
+// Nothing is done if it is not found, is cached and unchanged, is already queued,
+// or the worker is behind by a full queue.
+void filePrefetchSrc(char *cururl, char *srcfn) {
+    struct stat st;
+    char *path = fileCanonPath(fileSrcUrl(cururl, srcfn, 0));
+    if (path == NULL)
+        path = fileCanonPath(fileSrcUrl(cururl, srcfn, 1));
+    if (path == NULL || stat(path, &st) != 0)
+        return;
+    uint64_t pathhash = fileHash(path, strlen(path));
+    if (gFileSrcsAvail > 0) {
+        FileSrc *srcfile = *fileSrcSlot(path, pathhash);
+        if (srcfile && srcfile->mtime == st.st_mtime && srcfile->size == st.st_size)
+            return;
+    }
+
+    if (!gFilePrefetchStarted) {
+        if (!filePrefetchStart())
+            return;
+        gFilePrefetchStarted = 1;
+    }
+    fileLock(&gFilePrefetchLock);
+    FilePrefetch *pre;
+    uint32_t i;
+    for (i = 0; i < FilePrefetchSlots; i++) {
+        pre = &gFilePrefetch[i];
+        if (pre->state != PrefetchFree && pre->pathhash == pathhash && strcmp(pre->path, path) == 0) {
+            fileUnlock(&gFilePrefetchLock);
+            return;
+        }
+    }
+    pre = &gFilePrefetch[gFilePrefetchTail & (FilePrefetchSlots - 1)];
+    if (pre->state == PrefetchQueued || pre->state == PrefetchReading) {
+        fileUnlock(&gFilePrefetchLock);
+        return;
+    }
+    // A slot whose file was read ahead but never taken (e.g., it was already included) is re-used
+    if (pre->state == PrefetchDone)
+        filePrefetchDropScan(pre);
+    pre->path = path;
+    pre->pathhash = pathhash;
+    pre->mtime = st.st_mtime;
+    pre->size = st.st_size;
+    pre->src = memAllocStr(NULL, (size_t)st.st_size);
+    pre->state = PrefetchQueued;
+    ++gFilePrefetchTail;
+    fileCondSignal(&gFilePrefetchQueued);
+    fileUnlock(&gFilePrefetchLock);
+}
+
+// Take the source text of a file read ahead (and what was scanned from it), waiting for the worker
+// if it is reading it now. Return NULL (and leave the reading to the caller) if it was not read ahead
+// or has since changed.
+static char *filePrefetchTake(char *path, uint64_t pathhash, struct stat *st, uint64_t *hash, void **scanned) {
+    if (!gFilePrefetchStarted)
+        return NULL;
+    fileLock(&gFilePrefetchLock);
+    uint32_t i;
+    for (i = 0; i < FilePrefetchSlots; i++) {
+        FilePrefetch *pre = &gFilePrefetch[i];
+        if (pre->state == PrefetchFree || pre->pathhash != pathhash || strcmp(pre->path, path) != 0)
+            continue;
+        // Still queued: reading it now beats waiting for the worker to get to it
+        if (pre->state == PrefetchQueued) {
+            pre->state = PrefetchFree;
+            break;
+        }
+        while (pre->state == PrefetchReading)
+            fileCondWait(&gFilePrefetchDone, &gFilePrefetchLock);
+        char *src = pre->src;
+        int unchanged = pre->mtime == st->st_mtime && pre->size == st->st_size;
+        *hash = pre->hash;
+        if (src && unchanged) {
+            *scanned = pre->scanned;
+            pre->scanned = NULL;
+        }
+        else
+            filePrefetchDropScan(pre);
+        pre->state = PrefetchFree;
+        fileUnlock(&gFilePrefetchLock);
+        if (src && unchanged) {
+            ++gFilePrefetchUsed;
+            return src;
+        }
+        return NULL;
+    }
+    fileUnlock(&gFilePrefetchLock);
+    return NULL;
+}
+
+// Get how many source files were read from disk, and how many of those were read ahead
+void fileSrcReadStats(uint32_t *reads, uint32_t *prefetched) {
+    *reads = gFileSrcReads;
+    *prefetched = gFilePrefetchUsed;
+}
+
+// Load a source file via the cache, returning its cache entry (or NULL if not found)
+FileSrc *fileSrcLoad(char *fn) {
+    struct stat st;
+    char *path = fileCanonPath(fn);
+    if (path == NULL || stat(path, &st) != 0)
+        return NULL;
+
+    if ((gFileSrcsUsed + 1) << 1 > gFileSrcsAvail)
+        fileSrcGrow();
+    uint64_t pathhash = fileHash(path, strlen(path));
+    FileSrc **slotp = fileSrcSlot(path, pathhash);
+    FileSrc *srcfile = *slotp;
+    if (srcfile && srcfile->mtime == st.st_mtime && srcfile->size == st.st_size)
+        return srcfile;
+
+    // Not cached or changed on disk: take it from the worker thread if read ahead, else read it
+    uint64_t hash;
+    void *scanned = NULL;
+    char *src = filePrefetchTake(path, pathhash, &st, &hash, &scanned);
+    if (src == NULL) {
+        if ((src = fileLoad(path)) == NULL)
+            return NULL;
+        hash = fileHash(src, strlen(src));
+    }
+    ++gFileSrcReads;
+    if (srcfile == NULL) {
+        srcfile = *slotp = (FileSrc *)memAllocBlk(sizeof(FileSrc));
+        srcfile->path = path;
+        srcfile->pathhash = pathhash;
+        srcfile->src = NULL;
+        ++gFileSrcsUsed;
+    }
+    // Touched but unchanged content keeps the same source text
+    if (srcfile->src == NULL || srcfile->hash != hash)
+        srcfile->src = src;
+    srcfile->scanned = scanned;
+    srcfile->hash = hash;
+    srcfile->mtime = st.st_mtime;
+    srcfile->size = st.st_size;
+    return srcfile;
+}
+
 // Load source file, where srcfn is relative to cururl
 // - Look at fn+.cone or fn+/mod.cone
-// - return full pathname for source file
-char *fileLoadSrc(char *cururl, char *srcfn, char **fn) {
-    char *src;
+// - return full pathname for source file, and its canonical path
+// Sources are cached, so a file is only read again if it has changed.
+// scanned gets what the worker scanned from a file just read ahead (else NULL), to be freed by the caller.
+char *fileLoadSrc(char *cururl, char *srcfn, char **fn, char **path, void **scanned) {
+    FileSrc *srcfile;
     *fn = fileSrcUrl(cururl, srcfn, 0);
-    if (src = fileLoad(*fn))
-        return src;
-    *fn = fileSrcUrl(cururl, srcfn, 1);
-    return fileLoad(*fn);
+    if ((srcfile = fileSrcLoad(*fn)) == NULL) {
+        *fn = fileSrcUrl(cururl, srcfn, 1);
+        srcfile = fileSrcLoad(*fn);
+    }
+    *path = srcfile ? srcfile->path : NULL;
+    *scanned = srcfile ? srcfile->scanned : NULL;
+    if (srcfile)
+        srcfile->scanned = NULL;
+    return srcfile ? srcfile->src : NULL;
 }
@@ -8,21 +8,46 @@
 #ifndef fileio_h
 #define fileio_h
 
+#include <stdint.h>
+#include <stddef.h>
+
 // Load a file into an allocated string, return pointer or NULL if not found
 char *fileLoad(char *fn);
 
 // Extract a filename only (no extension) from a path
 char *fileName(char *fn);
 
+// Get number of characters in path up to file name (including the last slash)
+size_t fileFolder(char *fn);
+
 // Concatenate folder, filename and extension into a path
 char *fileMakePath(char *dir, char *srcfn, char *ext);
 
 // Create a new source file url relative to current, substituting new path and .cone extension
 char *fileSrcUrl(char *cururl, char *srcfn, int newfolder);
 
+// Hash some text
+uint64_t fileHash(char *srcp, size_t len);
+
+// Get the canonical (absolute, resolved) path for an existing file, or NULL if none
+char *fileCanonPath(char *fn);
+
 // Load source file, where srcfn is relative to cururl
 // - Look at fn+.cone or fn+/mod.cone
-// - return full pathname for source file
-char *fileLoadSrc(char *cururl, char *srcfn, char **fn);
+// - return full pathname for source file, and its canonical path
+// Sources are cached, so a file is only read again if it has changed.
+// A file's canonical path is always the same string, so it may be compared by pointer.
+// scanned gets what the worker scanned from a file just read ahead (else NULL), to be freed by the caller.
+char *fileLoadSrc(char *cururl, char *srcfn, char **fn, char **path, void **scanned);
+
+// Start reading a source file on a worker thread, ahead of fileLoadSrc (given the same names)
+void filePrefetchSrc(char *cururl, char *srcfn);
+
+// Have the worker thread also scan each source file it reads ahead (e.g., into tokens).
+// fileLoadSrc hands back what scan returns; drop frees one that is not used.
+void filePrefetchScanner(void *(*scan)(char *src), void (*drop)(void *scanned));
+
+// Get how many source files were read from disk, and how many of those were read ahead
+void fileSrcReadStats(uint32_t *reads, uint32_t *prefetched);
 
 #endif
\ No newline at end of file
@@ -16,6 +16,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
 
 // Public globals: Arena size configuration values
 size_t gMemBlkArenaSize = 256 * 4096;
@@ -28,6 +31,7 @@ static void *gMemStrArenaPos = NULL;
 static size_t gMemStrArenaLeft = 0;
 
 size_t memAllocated = 0;
+static size_t memBlkAllocated = 0;      // Of memAllocated, how much is for blocks (vs. strings)
 
 /** Allocate memory for a block, aligned to a 16-byte boundary */
 void *memAllocBlk(size_t size) {
@@ -48,6 +52,7 @@ void *memAllocBlk(size_t size) {
     if (size > gMemBlkArenaSize) {
         memp = malloc(size);
         memAllocated += size;
+        memBlkAllocated += size;
         if (memp==NULL)
             errorExit(ExitMem, "Error: Out of memory");
         return memp;
@@ -56,6 +61,7 @@ void *memAllocBlk(size_t size) {
     // Allocate a new Arena and return next bite out of it
     gMemBlkArenaPos = malloc(gMemBlkArenaSize);
     memAllocated += gMemBlkArenaSize;
+    memBlkAllocated += gMemBlkArenaSize;
     if (gMemBlkArenaPos==NULL)
         errorExit(ExitMem, "Error: Out of memory");
     gMemBlkArenaLeft = gMemBlkArenaSize - size;
@@ -111,3 +117,27 @@ size_t nametblUnused();
 size_t memUsed() {
     return memAllocated - gMemBlkArenaLeft - gMemStrArenaLeft - nametblUnused();
 }
+
+// Get how many bytes the block and string arenas have allocated, and how many are used
+void memArenaStats(size_t *blkalloc, size_t *blkused, size_t *stralloc, size_t *strused) {
+    *blkalloc = memBlkAllocated;
+    *blkused = memBlkAllocated - gMemBlkArenaLeft;
+    *stralloc = memAllocated - memBlkAllocated;
+    *strused = *stralloc - gMemStrArenaLeft;
+}
+
+// Return the most memory the compiler's process has had resident (in kb), or 0 if unknown
+size_t memPeakRss() {
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss / 1024;    // In bytes on macOS
+#else
+    return (size_t)usage.ru_maxrss;
+#endif
+#endif
+}
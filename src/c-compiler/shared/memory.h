@@ -25,4 +25,10 @@ char *memAllocStr(char *str, size_t size);
 // Return memory allocated and used
 size_t memUsed();
 
+// Get how many bytes the block and string arenas have allocated, and how many are used
+void memArenaStats(size_t *blkalloc, size_t *blkused, size_t *stralloc, size_t *strused);
+
+// Return the most memory the compiler's process has had resident (in kb), or 0 if unknown
+size_t memPeakRss();
+
 #endif
\ No newline at end of file
@@ -25,16 +25,25 @@ uint64_t timerTick() {
     QueryPerformanceFrequency(&captureFreq);
     return (uint64_t)captureFreq.QuadPart;
 }
+void timerSleep(unsigned int msecs) {
+    Sleep(msecs);
+}
 #else
 #include <time.h>
 uint64_t timerGet() {
     struct timespec tp;
-    clock_gettime(CLOCK_REALTIME, &tp);
-    return (uint64_t)tp.tv_nsec;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec * 1000000000 + (uint64_t)tp.tv_nsec;
 }
 uint64_t timerTick() {
     return 1000000000;
 }
+void timerSleep(unsigned int msecs) {
+    struct timespec tp;
+    tp.tv_sec = msecs / 1000;
+    tp.tv_nsec = (long)(msecs % 1000) * 1000000;
+    nanosleep(&tp, NULL);
+}
 #endif
 
 void timerBegin(size_t aTimer) {
@@ -66,7 +75,7 @@ void timerPrint() {
     printf("  Load:       %.6g\n", timerGetSecs(LoadTimer));
     printf("  Lexer:      %.6g\n", timerGetSecs(LexTimer));
     printf("  Parse:      %.6g\n", timerGetSecs(ParseTimer));
-    printf("  Analysis    %.6g\n", timerGetSecs(SemTimer));
+    printf("  Analysis:   %.6g\n", timerGetSecs(SemTimer));
     printf("  Gen:        %.6g\n", timerGetSecs(GenTimer));
     printf("  Verify:     %.6g\n", timerGetSecs(VerifyTimer));
     printf("  Optimize:   %.6g\n", timerGetSecs(OptTimer));
@@ -39,4 +39,7 @@ double timerSummary();
 // Print out all timers
 void timerPrint();
 
+// Suspend the compiler for some number of milliseconds
+void timerSleep(unsigned int msecs);
+
 #endif
\ No newline at end of file
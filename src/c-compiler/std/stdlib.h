@@ -86,6 +86,19 @@ NbrNode *usizeType;
 NbrNode *f32Type;
 NbrNode *f64Type;
 
+// SIMD vector types
+VecNode *u8x16Type;
+VecNode *u32x2Type;
+VecNode *u32x4Type;
+VecNode *u32x8Type;
+VecNode *u32x16Type;
+VecNode *i32x4Type;
+VecNode *i32x8Type;
+VecNode *f32x4Type;
+VecNode *f32x8Type;
+VecNode *f64x2Type;
+VecNode *f64x4Type;
+
 INsTypeNode *ptrType;
 INsTypeNode *refType;
 INsTypeNode *arrayRefType;
@@ -72,6 +72,17 @@ NbrNode *newNbrTypeNode(char *name, uint16_t typ, char bits) {
         if (bits > 1) {
             iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(shlName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(ShlIntrinsic)));
             iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(shrName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(ShrIntrinsic)));
+
+            // Bit manipulation and saturating arithmetic (intrinsics)
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("popcount", 8), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(PopcountIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("clz", 3), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(ClzIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("ctz", 3), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(CtzIntrinsic)));
+            if (bits % 16 == 0)
+                iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("bswap", 5), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(BswapIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("rotl", 4), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(RotlIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("rotr", 4), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(RotrIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("addsat", 6), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(AddSatIntrinsic)));
+            iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("subsat", 6), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(SubSatIntrinsic)));
         }
     }
     // Floating point functions (intrinsics)
@@ -82,6 +93,20 @@ NbrNode *newNbrTypeNode(char *name, uint16_t typ, char bits) {
         iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(opsym, FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(SinIntrinsic)));
         opsym = nametblFind("cos", 3);
         iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(opsym, FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(CosIntrinsic)));
+
+        // Fused multiply-add: a.fma(b, c) is a*b+c
+        FnSigNode *fmasig = newFnSigNode();
+        fmasig->rettype = (INode*)nbrtypenode;
+        nodesAdd(&fmasig->parms, (INode *)newVarDclFull(parm1, VarDclTag, (INode*)nbrtypenode, newPermUseNode(immPerm), NULL));
+        nodesAdd(&fmasig->parms, (INode *)newVarDclFull(parm2, VarDclTag, (INode*)nbrtypenode, newPermUseNode(immPerm), NULL));
+        nodesAdd(&fmasig->parms, (INode *)newVarDclFull(nametblFind("c", 1), VarDclTag, (INode*)nbrtypenode, newPermUseNode(immPerm), NULL));
+        iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("fma", 3), FlagMethFld, (INode *)fmasig, (INode *)newIntrinsicNode(FmaIntrinsic)));
+    }
+
+    // Lesser and greater of two numbers
+    if (bits > 1) {
+        iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("min", 3), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(MinIntrinsic)));
+        iNsTypeAddFn((INsTypeNode*)nbrtypenode, newFnDclNode(nametblFind("max", 3), FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(MaxIntrinsic)));
     }
 
     // Create function signature for comparison methods for this type
@@ -107,6 +132,149 @@ NbrNode *newNbrTypeNode(char *name, uint16_t typ, char bits) {
     return nbrtypenode;
 }
 
+// Add a parameter to a built-in method's signature
+void stdSigParm(FnSigNode *sig, char *name, INode *type) {
+    Name *parmname = nametblFind(name, strlen(name));
+    nodesAdd(&sig->parms, (INode *)newVarDclFull(parmname, VarDclTag, type, newPermUseNode(immPerm), NULL));
+}
+
+// Create a new SIMD vector type node, whose lanes are all of the elemtype number type.
+// Comparisons produce a masktype vector (Bool lanes), and shuffles select lanes using
+// an idxtype vector (u32 lanes). Both must have the same number of lanes.
+// A mask type is created with no masktype, and an index type with no idxtype (it is its own).
+VecNode *newVecTypeNode(char *name, NbrNode *elemtype, uint16_t lanes, VecNode *masktype, VecNode *idxtype) {
+    Name *namesym = nametblFind(name, strlen(name));
+
+    VecNode *vectypenode;
+    newNode(vectypenode, VecNode, VecTag);
+    vectypenode->namesym = namesym;
+    vectypenode->llvmtype = NULL;
+    iNsTypeInit((INsTypeNode*)vectypenode, 32);
+    vectypenode->elemtype = elemtype;
+    vectypenode->lanes = lanes;
+    if (idxtype == NULL)
+        idxtype = vectypenode;
+
+    namesym->node = (INode*)vectypenode;
+    INsTypeNode *vectype = (INsTypeNode*)vectypenode;
+    INode *vec = (INode*)vectypenode;
+
+    FnSigNode *unarysig = newFnSigNode();
+    unarysig->rettype = vec;
+    stdSigParm(unarysig, "a", vec);
+
+    FnSigNode *binsig = newFnSigNode();
+    binsig->rettype = vec;
+    stdSigParm(binsig, "a", vec);
+    stdSigParm(binsig, "b", vec);
+
+    // Horizontal reductions across all lanes
+    FnSigNode *reducesig = newFnSigNode();
+    reducesig->rettype = (INode*)elemtype;
+    stdSigParm(reducesig, "a", vec);
+
+    // Masks: bitwise logic across lanes, testing lanes, and selecting lanes from other vectors
+    if (masktype == NULL) {
+        iNsTypeAddFn(vectype, newFnDclNode(nametblFind("~", 1), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(NotIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(andName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(AndIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(orName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(OrIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(xorName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(XorIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(nametblFind("any", 3), FlagMethFld, (INode *)reducesig, (INode *)newIntrinsicNode(AnyIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(nametblFind("all", 3), FlagMethFld, (INode *)reducesig, (INode *)newIntrinsicNode(AllIntrinsic)));
+        return vectypenode;
+    }
+
+    // mask.select(a, b) takes each lane from a where the mask is true, otherwise from b
+    FnSigNode *selectsig = newFnSigNode();
+    selectsig->rettype = vec;
+    stdSigParm(selectsig, "self", (INode*)masktype);
+    stdSigParm(selectsig, "a", vec);
+    stdSigParm(selectsig, "b", vec);
+    iNsTypeAddFn((INsTypeNode*)masktype, newFnDclNode(nametblFind("select", 6), FlagMethFld, (INode *)selectsig, (INode *)newIntrinsicNode(SelectIntrinsic)));
+
+    // Binary methods whose second operand is a scalar apply it to every lane
+    FnSigNode *scalarsig = newFnSigNode();
+    scalarsig->rettype = vec;
+    stdSigParm(scalarsig, "a", vec);
+    stdSigParm(scalarsig, "b", (INode*)elemtype);
+
+    // Elementwise arithmetic
+    iNsTypeAddFn(vectype, newFnDclNode(minusName, FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(NegIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(plusName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(AddIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(plusName, FlagMethFld, (INode *)scalarsig, (INode *)newIntrinsicNode(AddIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(minusName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(SubIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(minusName, FlagMethFld, (INode *)scalarsig, (INode *)newIntrinsicNode(SubIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(multName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(MulIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(multName, FlagMethFld, (INode *)scalarsig, (INode *)newIntrinsicNode(MulIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(divName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(DivIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(divName, FlagMethFld, (INode *)scalarsig, (INode *)newIntrinsicNode(DivIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(remName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(RemIntrinsic)));
+
+    // Elementwise bitwise operators (integer only) or floating point functions
+    if (elemtype->tag != FloatNbrTag) {
+        iNsTypeAddFn(vectype, newFnDclNode(nametblFind("~", 1), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(NotIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(andName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(AndIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(orName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(OrIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(xorName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(XorIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(shlName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(ShlIntrinsic)));
+        iNsTypeAddFn(vectype, newFnDclNode(shrName, FlagMethFld, (INode *)binsig, (INode *)newIntrinsicNode(ShrIntrinsic)));
+    }
+    else
+        iNsTypeAddFn(vectype, newFnDclNode(nametblFind("sqrt", 4), FlagMethFld, (INode *)unarysig, (INode *)newIntrinsicNode(SqrtIntrinsic)));
+
+    // Elementwise comparisons produce a mask
+    FnSigNode *cmpsig = newFnSigNode();
+    cmpsig->rettype = (INode*)masktype;
+    stdSigParm(cmpsig, "a", vec);
+    stdSigParm(cmpsig, "b", vec);
+    iNsTypeAddFn(vectype, newFnDclNode(eqName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(EqIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(neName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(NeIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(ltName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(LtIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(leName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(LeIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(gtName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(GtIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(geName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(GeIntrinsic)));
+
+    // Shuffles: a.shuffle(u32x4[3,2,1,0]) or a.shuffle(b, u32x4[0,4,1,5]).
+    // Lane indexes must be literals: those at or above the vector's lanes select from b
+    Name *shufflename = nametblFind("shuffle", 7);
+    FnSigNode *shufflesig = newFnSigNode();
+    shufflesig->rettype = vec;
+    stdSigParm(shufflesig, "a", vec);
+    stdSigParm(shufflesig, "lanes", (INode*)idxtype);
+    iNsTypeAddFn(vectype, newFnDclNode(shufflename, FlagMethFld, (INode *)shufflesig, (INode *)newIntrinsicNode(ShuffleIntrinsic)));
+    FnSigNode *shuffle2sig = newFnSigNode();
+    shuffle2sig->rettype = vec;
+    stdSigParm(shuffle2sig, "a", vec);
+    stdSigParm(shuffle2sig, "b", vec);
+    stdSigParm(shuffle2sig, "lanes", (INode*)idxtype);
+    iNsTypeAddFn(vectype, newFnDclNode(shufflename, FlagMethFld, (INode *)shuffle2sig, (INode *)newIntrinsicNode(ShuffleIntrinsic)));
+
+    iNsTypeAddFn(vectype, newFnDclNode(nametblFind("sum", 3), FlagMethFld, (INode *)reducesig, (INode *)newIntrinsicNode(SumIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(nametblFind("min", 3), FlagMethFld, (INode *)reducesig, (INode *)newIntrinsicNode(MinIntrinsic)));
+    iNsTypeAddFn(vectype, newFnDclNode(nametblFind("max", 3), FlagMethFld, (INode *)reducesig, (INode *)newIntrinsicNode(MaxIntrinsic)));
+
+    // v.load(arr, index) fills v from the array reference's lanes starting at index
+    RefNode *constarr = newRefNodeFull(voidType, newPermUseNode(constPerm), (INode*)elemtype);
+    constarr->tag = ArrayRefTag;
+    FnSigNode *loadsig = newFnSigNode();
+    loadsig->rettype = vec;
+    stdSigParm(loadsig, "self", (INode*)newRefNodeFull(voidType, newPermUseNode(mutPerm), vec));
+    stdSigParm(loadsig, "arr", (INode*)constarr);
+    stdSigParm(loadsig, "index", (INode*)usizeType);
+    iNsTypeAddFn(vectype, newFnDclNode(nametblFind("load", 4), FlagMethFld, (INode *)loadsig, (INode *)newIntrinsicNode(LoadIntrinsic)));
+
+    // v.store(arr, index) writes v's lanes into the array reference starting at index
+    RefNode *mutarr = newRefNodeFull(voidType, newPermUseNode(mutPerm), (INode*)elemtype);
+    mutarr->tag = ArrayRefTag;
+    FnSigNode *storesig = newFnSigNode();
+    stdSigParm(storesig, "self", vec);
+    stdSigParm(storesig, "arr", (INode*)mutarr);
+    stdSigParm(storesig, "index", (INode*)usizeType);
+    iNsTypeAddFn(vectype, newFnDclNode(nametblFind("store", 5), FlagMethFld, (INode *)storesig, (INode *)newIntrinsicNode(StoreIntrinsic)));
+
+    return vectypenode;
+}
+
 // Create a generic ptr type for holding valid pointer methods
 INsTypeNode *newPtrTypeMethods() {
 
@@ -215,6 +383,12 @@ INsTypeNode *newRefTypeMethods() {
     iNsTypeAddFn((INsTypeNode*)reftypenode, newFnDclNode(gtName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(GtIntrinsic)));
     iNsTypeAddFn((INsTypeNode*)reftypenode, newFnDclNode(geName, FlagMethFld, (INode *)cmpsig, (INode *)newIntrinsicNode(GeIntrinsic)));
 
+    // Prefetch the referenced value into cache
+    FnSigNode *prefetchsig = newFnSigNode();
+    prefetchsig->rettype = voidType;
+    nodesAdd(&prefetchsig->parms, (INode *)newVarDclFull(self, VarDclTag, (INode*)voidref, newPermUseNode(immPerm), NULL));
+    iNsTypeAddFn((INsTypeNode*)reftypenode, newFnDclNode(nametblFind("prefetch", 8), FlagMethFld, (INode *)prefetchsig, (INode *)newIntrinsicNode(PrefetchIntrinsic)));
+
     return reftypenode;
 }
 
@@ -272,4 +446,21 @@ void stdNbrInit(int ptrsize) {
     ptrType = newPtrTypeMethods();
     refType = newRefTypeMethods();
     arrayRefType = newArrayRefTypeMethods();
+
+    // SIMD vector types, preceded by the mask and lane index types they rely on
+    VecNode *mask2 = newVecTypeNode("Boolx2", boolType, 2, NULL, NULL);
+    VecNode *mask4 = newVecTypeNode("Boolx4", boolType, 4, NULL, NULL);
+    VecNode *mask8 = newVecTypeNode("Boolx8", boolType, 8, NULL, NULL);
+    VecNode *mask16 = newVecTypeNode("Boolx16", boolType, 16, NULL, NULL);
+    u32x2Type = newVecTypeNode("u32x2", u32Type, 2, mask2, NULL);
+    u32x4Type = newVecTypeNode("u32x4", u32Type, 4, mask4, NULL);
+    u32x8Type = newVecTypeNode("u32x8", u32Type, 8, mask8, NULL);
+    u32x16Type = newVecTypeNode("u32x16", u32Type, 16, mask16, NULL);
+    u8x16Type = newVecTypeNode("u8x16", u8Type, 16, mask16, u32x16Type);
+    i32x4Type = newVecTypeNode("i32x4", i32Type, 4, mask4, u32x4Type);
+    i32x8Type = newVecTypeNode("i32x8", i32Type, 8, mask8, u32x8Type);
+    f32x4Type = newVecTypeNode("f32x4", f32Type, 4, mask4, u32x4Type);
+    f32x8Type = newVecTypeNode("f32x8", f32Type, 8, mask8, u32x8Type);
+    f64x2Type = newVecTypeNode("f64x2", f64Type, 2, mask2, u32x2Type);
+    f64x4Type = newVecTypeNode("f64x4", f64Type, 4, mask4, u32x4Type);
 }
\ No newline at end of file
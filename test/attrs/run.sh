@@ -0,0 +1,37 @@
+#!/bin/sh
+# Attribute test: compile test/run/attrs.cone with --llvmir, and check that each
+# attributed function's LLVM attribute group, and the branch hints, were emitted.
+# Usage: run.sh path/to/conec
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$conec" --llvmir -o "$work" "$dir/../run/attrs.cone" >/dev/null || exit 1
+ir="$work/attrs.preir"
+
+# Check that function $1's attribute group is exactly $2
+expect() {
+    group=$(sed -n "s/^define .* @\"*$1[(:].* \(#[0-9]*\) .*/\1/p" "$ir")
+    if ! grep -q "^attributes $group = { $2 }" "$ir"; then
+        echo "Expected $1 to have attributes { $2 }"
+        cat "$ir"
+        exit 1
+    fi
+}
+
+expect twice "alwaysinline"
+expect thrice "noinline"
+expect sq "nounwind readnone"
+expect first "nounwind readonly"
+expect clamp "hot"
+expect fail "cold minsize noinline optsize"
+expect Acc_add "alwaysinline"
+for weights in "i32 1, i32 2000" "i32 2000, i32 1"; do
+    if ! grep -q "!\"branch_weights\", $weights}" "$ir"; then
+        echo "Expected branch_weights $weights"
+        exit 1
+    fi
+done
+echo "Function attributes passed"
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Debug info test: compile test/run/include.cone (whose functions are spread over
+# included files) with -d, then with --debug-lines, then with --debug-main. Check each
+# object's debug info with llvm-dwarfdump, and the emission kind in its LLVM IR.
+# Usage: run.sh path/to/conec
+# Exits 77 (skipped) when llvm-dwarfdump cannot be found.
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+dwarfdump=$(command -v llvm-dwarfdump || command -v llvm-dwarfdump-14) || exit 77
+
+# Compile with options $1, and check for emission kind $2, the functions described
+# by debug info ($3), and the source files in the line table ($4)
+expect() {
+    "$conec" -d $1 --llvmir -o "$work" "$dir/../run/include.cone" >/dev/null || exit 1
+    kind=$(sed -n "s/.*emissionKind: \([A-Za-z]*\).*/\1/p" "$work/include.preir")
+    fns=$("$dwarfdump" --debug-info "$work/include.o" \
+        | awk '/DW_TAG/ { insub = /DW_TAG_subprogram/ } insub && /DW_AT_name/ { print $2 }' \
+        | tr -d '("")' | sort | tr '\n' ' ')
+    files=$("$dwarfdump" --debug-line "$work/include.o" | sed -n "s/.*name: \"\(.*\)\"/\1/p" \
+        | sort -u | tr '\n' ' ')
+    if [ "$kind" != "$2" ] || [ "$fns" != "$3" ] || [ "$files" != "$4" ]; then
+        echo "With -d $1, expected $2 with functions '$3' and files '$4'"
+        echo "but got $kind with functions '$fns' and files '$files'"
+        exit 1
+    fi
+}
+
+expect "" FullDebug "a b main two two " "common.cone ha.cone hb.cone include.cone "
+expect --debug-lines LineTablesOnly "" "common.cone ha.cone hb.cone include.cone "
+expect --debug-main FullDebug "main " "include.cone "
+echo "Debug info passed"
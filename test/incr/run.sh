@@ -0,0 +1,40 @@
+#!/bin/sh
+# Incremental re-analysis test: run conec --watch --run on a copy of step1.cone,
+# then overwrite it with each later step in turn. Every step's main() returns
+# its step number, and step4 does not compile.
+# Usage: run.sh path/to/conec
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'kill $pid 2>/dev/null; rm -rf "$work"' EXIT
+
+# Wait (up to 10 seconds) for the watch log to report a line
+expect() {
+    tries=0
+    until grep -q "$1" "$work/log"; do
+        tries=$((tries + 1))
+        if [ $tries -gt 100 ]; then
+            echo "Expected: $1"
+            cat "$work/log"
+            exit 1
+        fi
+        sleep 0.1
+    done
+}
+
+cp "$dir/step1.cone" "$work/main.cone"
+"$conec" --watch --run "$work/main.cone" >/dev/null 2>"$work/log" &
+pid=$!
+expect "main() returned 1$"
+for step in 2 3 4 5 6; do
+    # Source files are polled by modification time (and size), so step past the last second
+    sleep 1
+    cp "$dir/step$step.cone" "$work/main.cone"
+    if [ $step = 4 ]; then
+        expect "unsuccessful compile"
+    else
+        expect "main() returned $step$"
+    fi
+done
+echo "Incremental re-analysis passed"
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Link-time optimization test: compile util.cone to bitcode, then app.cone with --lto and
+# util.bc into an executable. Check that util's functions were folded into main(),
+# and that the executable returns what they compute.
+# Usage: run.sh path/to/conec
+# Exits 77 (skipped) when there is no C compiler (cc) to link with.
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+command -v cc >/dev/null || exit 77
+
+"$conec" --emit-bitcode -o "$work" "$dir/util.cone" >/dev/null || exit 1
+"$conec" --lto --link --llvmir -o "$work" "$dir/app.cone" "$work/util.bc" >/dev/null || exit 1
+
+if ! grep -q "^  ret i32 18$" "$work/app.lto.ir"; then
+    echo "Expected main() to return a constant 18"
+    cat "$work/app.lto.ir"
+    exit 1
+fi
+"$work/app"
+status=$?
+if [ $status -ne 18 ]; then
+    echo "Expected the program to exit with 18, not $status"
+    exit 1
+fi
+echo "Link-time optimization passed"
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Multiversioning test: compile test/run/multiversion.cone to an object file, and check with
+# llvm-nm that sumsq became an ifunc, with its resolver and a version per feature level.
+# Then link and run it (when cc is installed), so the resolver picks a version at load time.
+# Usage: run.sh path/to/conec
+# Exits 77 (skipped) on hosts other than x86-64, or when llvm-nm cannot be found.
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+case $(uname -m) in
+    x86_64|amd64) ;;
+    *) exit 77 ;;
+esac
+nm=$(command -v llvm-nm || command -v llvm-nm-14) || exit 77
+
+"$conec" -o "$work" "$dir/../run/multiversion.cone" >/dev/null || exit 1
+"$nm" "$work/multiversion.o" >"$work/syms.txt" || exit 1
+
+for sym in "i sumsq" "t sumsq.resolver" "t sumsq.default" "t sumsq.sse4.2" "t sumsq.avx2" "t sumsq.avx512"; do
+    if ! grep -q " $sym$" "$work/syms.txt"; then
+        echo "Expected symbol $sym"
+        cat "$work/syms.txt"
+        exit 1
+    fi
+done
+
+if command -v cc >/dev/null; then
+    "$conec" --link -o "$work" "$dir/../run/multiversion.cone" >/dev/null || exit 1
+    if ! "$work/multiversion"; then
+        echo "Expected the linked program to exit with 0"
+        exit 1
+    fi
+fi
+echo "Multiversioning passed"
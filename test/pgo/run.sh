@@ -0,0 +1,47 @@
+#!/bin/sh
+# Profile-guided optimization test: compile test/run/pgo.cone with --pgo-gen, write a profile
+# for it (with the function hashes the instrumentation recorded), merge that with llvm-profdata,
+# and check that --pgo-use turned the profile's counts into branch weights.
+# (No profile is collected by running it, as --pgo-gen links with clang.)
+# Usage: run.sh path/to/conec
+# Exits 77 (skipped) when llvm-profdata cannot be found.
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+profdata=$(command -v llvm-profdata || command -v llvm-profdata-14) || exit 77
+
+"$conec" --pgo-gen --llvmir -o "$work" "$dir/../run/pgo.cone" >/dev/null || exit 1
+
+# The function hash is the second field of each function's __profd_ record
+hash() {
+    sed -n "s/^@__profd_$1 = .*} { i64 [-0-9]*, i64 \([-0-9]*\),.*/\1/p" "$work/pgo.ir"
+}
+cat >"$work/pgo.proftext" <<END
+:ir
+classify
+$(hash classify)
+2
+9
+91
+
+main
+$(hash main)
+3
+1
+100
+1
+END
+"$profdata" merge -o "$work/pgo.profdata" "$work/pgo.proftext" || exit 1
+
+"$conec" --pgo-use="$work/pgo.profdata" --llvmir -o "$work" "$dir/../run/pgo.cone" >/dev/null || exit 1
+for prof in "!\"branch_weights\", i32 9, i32 91}" "!\"function_entry_count\", i64"; do
+    if ! grep -qF "$prof" "$work/pgo.ir"; then
+        echo "Expected $prof"
+        cat "$work/pgo.ir"
+        exit 1
+    fi
+done
+echo "Profile-guided optimization passed"
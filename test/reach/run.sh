@@ -0,0 +1,32 @@
+#!/bin/sh
+# Reachability test: compile test/run/reach.cone with --stats and --llvmir, and check
+# that its unused functions, global and trait impl were counted and left ungenerated.
+# Usage: run.sh path/to/conec
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$conec" --stats --llvmir -o "$work" "$dir/../run/reach.cone" >"$work/stats.txt" || exit 1
+ir="$work/reach.preir"
+
+for count in "Functions reached: *3 of 5" "Globals reached: *1 of 2"; do
+    if ! grep -q "$count" "$work/stats.txt"; then
+        echo "Expected $count"
+        cat "$work/stats.txt"
+        exit 1
+    fi
+done
+for dead in "^@unused = " "@unusedfn(" "@\"Rect_area" "^@\"Rect->Shape"; do
+    if grep -q "$dead" "$ir"; then
+        echo "Expected no $dead"
+        cat "$ir"
+        exit 1
+    fi
+done
+if ! grep -q "^@\"Square->Shape:Vtable\" = " "$ir"; then
+    echo "Expected Square's Shape vtable"
+    exit 1
+fi
+echo "Reachability passed"
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Field reordering test: compile test/run/reorder.cone with --llvmir, and check that
+# Mixed's fields were laid out by decreasing alignment (its compile-time global too),
+# while the extern struct CRec kept its declared (C) order.
+# Usage: run.sh path/to/conec
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$conec" --llvmir -o "$work" "$dir/../run/reorder.cone" >/dev/null || exit 1
+ir="$work/reorder.preir"
+
+for line in "%Mixed = type { i64, i32, i16, i8, i8 }" \
+        "%CRec = type { i8, i64, i8 }" \
+        "@Glob = constant %Mixed { i64 40, i32 14, i16 3, i8 1, i8 2 }"; do
+    if ! grep -qF "$line" "$ir"; then
+        echo "Expected $line"
+        cat "$ir"
+        exit 1
+    fi
+done
+echo "Field reordering passed"
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Statistics test: compile test/run/reorder.cone with --stats and --stats-json. Check that
+# the JSON report is valid, and that both reports list the reordered struct with its sizes.
+# Usage: run.sh path/to/conec
+# Exits 77 (skipped) when python3 (to read the JSON) cannot be found.
+
+conec=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+command -v python3 >/dev/null || exit 77
+
+"$conec" --stats --stats-json -o "$work" "$dir/../run/reorder.cone" >"$work/stats.txt" || exit 1
+json="$work/reorder.stats.json"
+
+if ! grep -q "^    Mixed *32 -> 16 bytes$" "$work/stats.txt"; then
+    echo "Expected Mixed to be reported as reordered from 32 to 16 bytes"
+    cat "$work/stats.txt"
+    exit 1
+fi
+if ! python3 -m json.tool "$json" >/dev/null; then
+    echo "Expected valid JSON"
+    cat "$json"
+    exit 1
+fi
+python3 - "$json" <<'END' || exit 1
+import json, sys
+stats = json.load(open(sys.argv[1]))
+expect = {
+    "program": "reorder",
+    "functions": {"declared": 2, "reached": 1},
+    "reordered": {"structs": 1, "bytes_saved": 16,
+        "by_struct": [{"name": "Mixed", "size": 32, "reordered_size": 16}]},
+}
+for key, value in expect.items():
+    if stats.get(key) != value:
+        sys.exit("Expected %s to be %s, not %s" % (key, value, stats.get(key)))
+END
+echo "Statistics passed"